@@ -3,7 +3,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdio.h>
-#include <cstdarg>
+#include <string.h>
 
 /**
  * @file
@@ -40,7 +40,143 @@
  *   // send out[0..len-1] over UART, MQTT, etc.
  * }
  * @endcode
+ *
+ * ### Header-only configuration
+ * By default the writer is compiled once in `json_buffer_writer.cpp`, so every call
+ * from user code is an opaque function call unless the toolchain performs LTO.
+ * Defining `JSON_BUF_WRITER_HEADER_ONLY` for the whole build pulls the implementation
+ * into this header with every member `inline`, letting the compiler inline hot paths
+ * such as `value(bool)` or integer emission at the call site. This usually trades
+ * flash size for speed; compare both with the `bench` and `bench_header_only`
+ * PlatformIO environments.
+ */
+
+#if defined(JSON_BUF_WRITER_HEADER_ONLY)
+#define JSONBUF_INLINE inline
+#else
+#define JSONBUF_INLINE
+#endif
+
+#if defined(__GNUC__) && defined(JSON_BUF_WRITER_HEADER_ONLY)
+// GCC warns about noinline on inline definitions; cold alone keeps the slow paths out of line
+#define JSONBUF_COLD __attribute__((cold))
+#define JSONBUF_LIKELY(x) __builtin_expect(!!(x), 1)
+#define JSONBUF_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#elif defined(__GNUC__)
+#define JSONBUF_COLD __attribute__((cold, noinline))
+#define JSONBUF_LIKELY(x) __builtin_expect(!!(x), 1)
+#define JSONBUF_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define JSONBUF_COLD
+#define JSONBUF_LIKELY(x) (x)
+#define JSONBUF_UNLIKELY(x) (x)
+#endif
+
+/**
+ * @class JsonToken
+ * @brief A string encoded once into its final JSON form for repeated emission.
+ *
+ * A token stores the escaped, quoted bytes of a string, plus the trailing colon when
+ * it is a key. `JsonBufWriter::key(const JsonToken&)` and
+ * `JsonBufWriter::value(const JsonToken&)` emit it with a single copy, skipping the
+ * escape scan. Use tokens for keys and enum strings that are only known at runtime
+ * (e.g. from configuration) but written in every message.
+ *
+ * @code{.cpp}
+ * static JsonToken stateKey("state", JsonToken::Kind::Key);
+ * static JsonToken running("running");
+ * jw.key(stateKey); jw.value(running);
+ * @endcode
+ *
+ * @note Strings are encoded with the writer defaults (UTF-8 passed through).
+ */
+class JsonToken
+{
+public:
+    /** @brief Maximum encoded size in bytes, including quotes and colon. */
+    static constexpr size_t CAPACITY = 64;
+
+    /** @brief Whether the token is written as an object key or as a string value. */
+    enum class Kind : uint8_t
+    {
+        Value, ///< `"text"`
+        Key    ///< `"text":`
+    };
+
+    /** @brief Construct an empty token; #ok() is false until assign() succeeds. */
+    JsonToken();
+
+    /**
+     * @brief Construct a token from a null-terminated string.
+     * @param str UTF-8 text to encode.
+     * @param kind Key or value encoding.
+     * @post #ok() is false if the encoded form exceeds #CAPACITY.
+     */
+    explicit JsonToken(const char *str, Kind kind = Kind::Value);
+
+    /**
+     * @brief Re-encode the token from a string with explicit length.
+     * @param str Pointer to string bytes (need not be null-terminated).
+     * @param length Number of bytes from @p str.
+     * @param kind Key or value encoding.
+     * @retval true Success.
+     * @retval false The encoded form exceeds #CAPACITY; the token becomes empty.
+     */
+    bool assign(const char *str, size_t length, Kind kind = Kind::Value);
+
+    /** @brief Whether the token holds an encoded string. */
+    bool ok() const;
+
+    /** @brief Whether the token was encoded as a key. */
+    bool isKey() const;
+
+    /** @brief Encoded bytes (not null-terminated). */
+    const char *data() const;
+
+    /** @brief Number of encoded bytes. */
+    size_t size() const;
+
+private:
+    char encoded_[CAPACITY]; ///< Escaped, quoted bytes (and colon for keys).
+    uint8_t length_;         ///< Encoded length; 0 when empty.
+    Kind kind_;              ///< Key or value encoding.
+};
+
+class JsonChecksum;
+class JsonFragmentCache;
+
+/**
+ * @brief Handle to a fixed-width slot that is written now and filled in later.
+ *
+ * Returned by JsonBufWriter::reserveNumber() and JsonBufWriter::reserveLengthPrefix() and
+ * passed to JsonBufWriter::fill(). A slot can be filled as long as its bytes are still in
+ * the writer's buffer (i.e. not yet flushed or left behind by continueIn()).
+ */
+struct JsonPlaceholder
+{
+    uint32_t offset; ///< Document offset of the first byte of the slot.
+    uint8_t width;   ///< Slot size in bytes.
+    uint8_t kind;    ///< Decimal number or binary prefix (internal; 0 = unset).
+};
+
+/**
+ * @brief Compact snapshot of a writer's position inside a document.
+ *
+ * Produced by JsonBufWriter::saveState() and consumed by JsonBufWriter::restoreState().
+ * Plain data: it may be copied, stored in RTC/retained memory or sent to another task.
+ * Bit @c i of each mask describes the container at nesting level @c i.
  */
+struct JsonWriterState
+{
+    uint32_t offset;        ///< Document bytes produced before the snapshot.
+    uint32_t start;         ///< Offset where the JSON value begins (after any length prefix).
+    uint16_t flags;         ///< Root, encoding and mode flags (internal layout).
+    uint8_t depth;          ///< Number of open containers.
+    uint8_t objectMask;     ///< Container is an object (else an array).
+    uint8_t firstMask;      ///< Container has no element yet.
+    uint8_t expectMask;     ///< Object container has a key waiting for its value.
+    uint8_t floatPrecision; ///< Decimal places for floating point values.
+};
 
 /**
  * @class JsonBufWriter
@@ -51,19 +187,53 @@
  * state transition, etc.), the writer enters a permanent error state until reset.
  *
  * @warning `raw()` inserts text without validation—caller must ensure the fragment
- *          is valid JSON and fits in the remaining capacity.
+ *          is valid JSON and fits in the remaining capacity. Use `rawValidated()` for
+ *          fragments from untrusted sources.
  * @note Methods return `false` on failure and set an internal error flag; check
  *       #ok() or the return value of each call.
  */
 class JsonBufWriter
 {
 public:
-    /** @brief Maximum supported container nesting depth. */
+    /** @brief Maximum supported container nesting depth (bounded by the #JsonWriterState masks). */
     static constexpr size_t MAX_DEPTH = 8;
+    static_assert(MAX_DEPTH <= 8, "JsonWriterState stores one bit per nesting level in a uint8_t");
+
+    /** @brief Widest number slot accepted by reserveNumber() (digits of UINT64_MAX). */
+    static constexpr uint8_t MAX_NUMBER_WIDTH = 20;
 
     /** @brief Default number of decimal places for floating point values. */
     static constexpr uint8_t DEFAULT_FLOAT_PRECISION = 3;
 
+    /** @brief Bytes written between two checksum updates (see setChecksum()). */
+    static constexpr size_t CHECKSUM_CHUNK = 512;
+
+    /**
+     * @brief Receives buffered output when the writer runs out of space.
+     * @param context User pointer passed to setFlushHandler().
+     * @param data Bytes written since the previous flush.
+     * @param length Number of bytes in @p data (> 0).
+     * @return `true` if the bytes were consumed; `false` puts the writer into the error state.
+     * @details After a successful call the writer continues at the start of its current
+     *          buffer. A handler may call continueIn() to switch to a different buffer.
+     */
+    typedef bool (*FlushHandler)(void *context, const uint8_t *data, size_t length);
+
+    /** @brief Handling of bytes >= 0x80 in keys and string values. */
+    enum class Utf8Mode : uint8_t
+    {
+        Passthrough, ///< Copy non-ASCII bytes verbatim without validation (default).
+        Replace,     ///< Validate UTF-8 and replace each ill-formed sequence with U+FFFD.
+        Reject       ///< Validate UTF-8 and fail (setting the error flag) on ill-formed input.
+    };
+
+    /** @brief Encoding of float and double values. */
+    enum class FloatFormat : uint8_t
+    {
+        Decimal,      ///< Fixed-point decimal with the float precision, e.g. `3.142` (default).
+        ScaledInteger ///< Rounded integer of value * floatScale(), e.g. `3142` for precision 3.
+    };
+
     /**
      * @brief Construct a JSON writer bound to a buffer.
      * @param buf Pointer to the output buffer (must remain valid for the writer’s lifetime or until reset()).
@@ -80,7 +250,8 @@ public:
      * @brief Reset the writer to start writing into a (possibly new) buffer.
      * @param buf Pointer to the buffer to use from now on.
      * @param capacity Capacity in bytes of @p buf.
-     * @post Clears error state, depth, and counters; float precision set to #DEFAULT_FLOAT_PRECISION.
+     * @post Clears error state, depth, and counters; float precision set to
+     *       #DEFAULT_FLOAT_PRECISION and float format to FloatFormat::Decimal.
      */
     void reset(uint8_t *buf, size_t capacity);
 
@@ -90,6 +261,206 @@ public:
      */
     void setFloatPrecision(uint8_t digits);
 
+    /**
+     * @brief Select how float and double values are written.
+     * @param format See #FloatFormat. Applies to value(float), value(double) and float
+     *               elements of the range writers.
+     */
+    void setFloatFormat(FloatFormat format);
+
+    /**
+     * @brief Factor FloatFormat::ScaledInteger values are multiplied by: 10^precision.
+     * @details Write it once next to the scaled values so the reader can divide them back,
+     *          e.g. `jw.key("scale"); jw.value(jw.floatScale());`. 0 if the precision is
+     *          above 18 (not representable).
+     */
+    uint64_t floatScale() const;
+
+    /**
+     * @brief Select how non-ASCII bytes in strings are validated.
+     * @param mode See #Utf8Mode. Persists across reset().
+     * @details Keys cached by JsonRecordSerializer are encoded once, with the options given
+     *          to JsonRecordSerializer::compile(), not with this writer's.
+     * @note Validation scans ASCII runs with SIMD on hosts (SSE2/NEON) and SWAR on MCUs;
+     *       multi-byte sequences are checked with a lead-byte table.
+     */
+    void setUtf8Mode(Utf8Mode mode);
+
+    /**
+     * @brief Emit only 7-bit ASCII by escaping non-ASCII code points as `\uXXXX`.
+     * @param enabled `true` to escape code points above U+007F (as surrogate pairs above U+FFFF).
+     * @details Input is decoded as UTF-8; ill-formed sequences are replaced with `\ufffd` unless
+     *          the mode is Utf8Mode::Reject. Applies to strings and keys in rawValidated()
+     *          fragments too; raw(), rawKey(), tokens and JsonRecordSerializer keys (encoded by
+     *          JsonRecordSerializer::compile()) are copied as given. Persists across reset().
+     */
+    void setAsciiOnly(bool enabled);
+
+    /**
+     * @brief Stream output through a handler instead of failing when the buffer is full.
+     * @param handler Callback receiving full buffers, or `nullptr` to disable streaming.
+     * @param context Opaque pointer forwarded to @p handler.
+     * @details With a handler installed the buffer acts as a staging area: whenever the next
+     *          write does not fit, the pending bytes are passed to @p handler and writing resumes
+     *          at the start of the buffer with the container state preserved. Single tokens other
+     *          than strings and raw fragments must still fit in an empty buffer.
+     *          Persists across reset().
+     */
+    void setFlushHandler(FlushHandler handler, void *context);
+
+    /**
+     * @brief Compute a checksum of the document while writing it.
+     * @param checksum Checksum to feed (reset here and by reset()), or `nullptr` to detach.
+     * @details Every #CHECKSUM_CHUNK bytes the finished part of the buffer is hashed while it
+     *          is still in cache; the rest is hashed when it leaves the writer through flush(),
+     *          continueIn() or finalize(). The checksum covers the bytes in output order,
+     *          including a length prefix, and is complete when finalize() returns.
+     *
+     *          Bytes after a placeholder are hashed only at the end, so fill() slots before
+     *          finalize(). Before saveState(), call flush() so the buffered bytes are counted.
+     *          With pagination the checksum covers the pages as delivered. Attach before
+     *          writing the document. Persists across reset().
+     */
+    void setChecksum(JsonChecksum *checksum);
+
+    /**
+     * @brief Write newline-delimited JSON (JSON Lines / NDJSON).
+     * @param enabled `true` to terminate every root value with `\n` and accept another root value.
+     * @param rollback `true` to drop an unfinished record when an error occurs: the buffer is cut
+     *        back to the end of the last complete record and rolledBack() becomes true. The
+     *        writer stays in the error state until reset(), so the rest of the failed record
+     *        cannot leak into the output.
+     * @details Persists across reset(). See recordCount() and completeSize().
+     */
+    void setJsonLines(bool enabled, bool rollback = false);
+
+    /**
+     * @brief Split an array that outgrows the buffer into several complete documents.
+     * @param enabled `true` to paginate through the flush handler (see setFlushHandler()).
+     * @details The writer keeps one byte per open container in reserve. When a write inside
+     *          an array does not fit, the page is cut after the last complete element of the
+     *          outermost array that has one, all open containers are closed and the valid
+     *          document is passed to the flush handler. Everything written before that array's
+     *          `[` (the envelope, e.g. header keys) is kept in the buffer, and writing continues
+     *          the array after it, starting with the unfinished element.
+     *
+     *          Each element must fit in a page together with the envelope. Pagination needs the
+     *          page to start at the beginning of the buffer: do not combine it with flush(),
+     *          continueIn(), restoreState() or JSON Lines mode. Placeholders are refused while
+     *          pagination is on, and a document holding one is not paginated (the overflow is
+     *          an error). A fragment whose recording spans a page cut is not cached.
+     *          Persists across reset().
+     */
+    void setPagination(bool enabled);
+
+    /**
+     * @brief Keep the document closable when the buffer runs out.
+     * @param enabled `true` to drop values that do not fit instead of failing.
+     * @details The writer keeps one byte per open container in reserve, so the pending `}`/`]`
+     *          can always be written. A key, value or container that does not fit is removed
+     *          again and its call returns `false` while ok() stays `true`: a key is dropped
+     *          together with its value, and the calls that fill and close a dropped container
+     *          are refused as well. finalize() then yields a valid document without the dropped
+     *          values; droppedCount() tells whether anything was lost.
+     *
+     *          Enable before writing the document. Persists across reset().
+     */
+    void setBestEffort(bool enabled);
+
+    // ----------------------------
+    // Placeholders
+    // ----------------------------
+
+    /**
+     * @brief Write a fixed-width number slot as the next value, to be filled in later.
+     * @param[out] slot Handle for fill().
+     * @param width Slot width in characters (1..#MAX_NUMBER_WIDTH).
+     * @retval true Slot reserved; it reads `0` padded with spaces until filled.
+     * @retval false Error (invalid width, state or capacity, or pagination is on).
+     * @details The number is written left-aligned and padded with trailing spaces, which
+     *          JSON treats as insignificant whitespace, so no bytes ever move.
+     */
+    bool reserveNumber(JsonPlaceholder &slot, uint8_t width = 10);
+
+    /**
+     * @brief Reserve a binary length prefix ahead of the document.
+     * @param[out] slot Handle for fill().
+     * @param bytes Prefix width (1..8).
+     * @param bigEndian Byte order used when the prefix is filled.
+     * @retval true Prefix reserved (zero bytes until filled).
+     * @retval false Error: the document has already started, pagination is on, or invalid
+     *         width/capacity.
+     * @note The prefix is not counted by documentLength(); fill it with that value once the
+     *       document is complete.
+     */
+    bool reserveLengthPrefix(JsonPlaceholder &slot, uint8_t bytes = 4, bool bigEndian = true);
+
+    /**
+     * @brief Fill a reserved slot.
+     * @param slot Handle from reserveNumber() or reserveLengthPrefix().
+     * @param value Value to store (decimal text or binary integer depending on the slot).
+     * @retval true Success.
+     * @retval false The value does not fit, or the slot is no longer in the buffer.
+     */
+    bool fill(const JsonPlaceholder &slot, uint64_t value);
+
+    /**
+     * @brief Bytes of the JSON document written so far, excluding any length prefix.
+     * @return Length including bytes already flushed.
+     */
+    size_t documentLength() const;
+
+    /** @brief Root values completed since construction/reset (JSON Lines mode). */
+    size_t recordCount() const;
+
+    /**
+     * @brief Bytes at the start of the buffer that hold complete records.
+     * @return Offset just past the newline of the last complete record still in the buffer
+     *         (JSON Lines mode; 0 if none).
+     */
+    size_t completeSize() const;
+
+    /** @brief Whether an unfinished record was dropped since reset(); see setJsonLines(). */
+    bool rolledBack() const;
+
+    /** @brief Documents passed to the flush handler in pagination mode since reset(). */
+    size_t pageCount() const;
+
+    /** @brief Values refused for lack of space in best-effort mode since reset(). */
+    size_t droppedCount() const;
+
+    // ----------------------------
+    // Resuming documents
+    // ----------------------------
+
+    /**
+     * @brief Continue the current document in another buffer.
+     * @param buf Buffer receiving the following bytes.
+     * @param capacity Capacity in bytes of @p buf.
+     * @details The bytes written so far are considered consumed (they count towards
+     *          flushedSize()); nesting and comma state are kept, so the next token continues
+     *          the same document. Any error state is kept as well. May be called from a flush
+     *          handler to switch buffers.
+     */
+    void continueIn(uint8_t *buf, size_t capacity);
+
+    /**
+     * @brief Snapshot the document state, treating the buffered bytes as consumed.
+     * @return State from which restoreState() continues right after the last byte written.
+     */
+    JsonWriterState saveState() const;
+
+    /**
+     * @brief Resume a document from a snapshot, writing into a (possibly new) buffer.
+     * @param state Value previously returned by saveState().
+     * @param buf Buffer receiving the following bytes.
+     * @param capacity Capacity in bytes of @p buf.
+     * @retval true The writer continues the saved document.
+     * @retval false @p state is malformed or was saved in the error state; the writer is in error.
+     * @note The flush handler is left unchanged.
+     */
+    bool restoreState(const JsonWriterState &state, uint8_t *buf, size_t capacity);
+
     // ----------------------------
     // Container operations
     // ----------------------------
@@ -138,6 +509,33 @@ public:
      */
     bool key(const char *key);
 
+    /**
+     * @brief Write an object key that is already escaped, quoted and followed by a colon.
+     * @param encodedKey Pre-encoded key fragment, e.g. `"name":`.
+     * @param length Number of bytes in @p encodedKey.
+     * @retval true Success.
+     * @retval false Error (e.g., not inside an object, capacity exceeded).
+     * @pre Same as key().
+     * @warning The fragment is copied verbatim; use this for keys encoded once and reused many times.
+     */
+    bool rawKey(const char *encodedKey, size_t length);
+
+    /**
+     * @overload
+     * @brief Write a pre-encoded key token with a single copy.
+     * @param token Token created with JsonToken::Kind::Key.
+     * @retval false Error (token empty or not a key, invalid state, or capacity).
+     */
+    bool key(const JsonToken &token);
+
+    /**
+     * @overload
+     * @brief Write an integer id as an object key, e.g. `"42":`.
+     * @param id Key value, formatted in decimal.
+     * @retval false Error (invalid state or capacity).
+     */
+    bool key(uint32_t id);
+
     /**
      * @name Value writers
      * @brief Emit a JSON value at the current position.
@@ -180,6 +578,13 @@ public:
 
     /** @overload @brief Write a double-precision floating-point number. */
     bool value(double number);
+
+    /**
+     * @overload
+     * @brief Write a pre-encoded string token with a single copy.
+     * @param token Token created with JsonToken::Kind::Value.
+     */
+    bool value(const JsonToken &token);
     /** @} */
 
     /**
@@ -189,6 +594,65 @@ public:
      */
     bool null();
 
+    /**
+     * @brief Write a UTC timestamp as an RFC 3339 string, e.g. `"2024-05-01T12:34:56.250Z"`.
+     * @param epochSeconds Seconds since 1970-01-01T00:00:00Z (years 0000 to 9999).
+     * @param fractionalMicros Microseconds into the second, 0 to 999999.
+     * @param precision Fraction digits to write, 0 to 6 (truncated, not rounded).
+     * @retval true Success.
+     * @retval false Error (invalid state, argument out of range, or capacity).
+     * @details Formatted in place with a single capacity check and no libc calls. The
+     *          date part of the last timestamp is cached, so consecutive timestamps on the
+     *          same day only format the time of day.
+     */
+    bool valueTimestamp(int64_t epochSeconds, uint32_t fractionalMicros = 0, uint8_t precision = 0);
+
+    /**
+     * @name Identifier values
+     * @brief Write common device identifiers as JSON strings.
+     * @details Each is formatted straight into the buffer after a single capacity check.
+     *          Hex digits are lower case. The alphabets never need escaping, so the escape
+     *          scan of value(const char *) is skipped.
+     * @retval true Success.
+     * @retval false Error (invalid state or capacity).
+     * @{
+     */
+
+    /**
+     * @brief MAC address, e.g. `"24:0a:c4:12:ab:ef"`.
+     * @param mac 6 bytes, most significant first.
+     * @param separator Character between the bytes (`':'` or `'-'`).
+     */
+    bool valueMac(const uint8_t *mac, char separator = ':');
+
+    /**
+     * @brief IPv4 address in dotted-quad form, e.g. `"192.168.4.1"`.
+     * @param address 4 bytes in network order.
+     */
+    bool valueIPv4(const uint8_t *address);
+
+    /**
+     * @brief IPv6 address in RFC 5952 canonical form, e.g. `"2001:db8::1"`.
+     * @param address 16 bytes in network order.
+     * @details Leading zeros are dropped in each group and the longest run of zero groups
+     *          is shortened to `::`. IPv4-mapped addresses end in a dotted quad
+     *          (`"::ffff:192.0.2.1"`).
+     */
+    bool valueIPv6(const uint8_t *address);
+
+    /**
+     * @brief UUID in 8-4-4-4-12 form, e.g. `"123e4567-e89b-12d3-a456-426614174000"`.
+     * @param uuid 16 bytes in RFC 4122 (big-endian) order.
+     */
+    bool valueUuid(const uint8_t *uuid);
+
+    /**
+     * @brief 64-bit value as 16 zero-padded hex digits, e.g. `"00001234abcdef01"`.
+     * @param value Identifier (e.g. a chip id).
+     */
+    bool valueHex64(uint64_t value);
+    /** @} */
+
     /**
      * @brief Insert a raw JSON fragment verbatim (no validation or escaping).
      * @param json Pointer to a fragment (UTF-8).
@@ -199,6 +663,121 @@ public:
      */
     bool raw(const char *json, size_t length);
 
+    /**
+     * @brief Insert a JSON fragment after checking it, with insignificant whitespace removed.
+     * @param json Pointer to a fragment holding exactly one JSON value.
+     * @param length Number of bytes in @p json.
+     * @retval true Success.
+     * @retval false The fragment is not well-formed JSON (the writer enters the error
+     *         state), or error (invalid state or capacity).
+     * @details A single pass with JsonReader validates the fragment and copies its tokens
+     *          without the whitespace between them. When the fragment fits, it is written
+     *          straight into the buffer; otherwise it goes out token by token, so it may be
+     *          streamed through the flush handler. Strings and keys are copied with their
+     *          escapes as written and must be well-formed UTF-8 in Utf8Mode::Reject. With
+     *          setAsciiOnly() or Utf8Mode::Replace, their non-ASCII bytes are encoded like
+     *          value(const char *) does (`\uXXXX` escapes, U+FFFD for ill-formed input), so the
+     *          output may be longer than @p length and is written token by token.
+     */
+    bool rawValidated(const char *json, size_t length);
+
+    /**
+     * @brief Reserve space for a value formatted by the caller directly into the buffer.
+     * @param maxLength Largest number of bytes the value may take.
+     * @return Where to write the value (@p maxLength bytes are available), or `nullptr` on
+     *         error (invalid state or capacity; in best-effort mode the value is dropped).
+     * @details Handles the separator and checks capacity once, so a custom formatter (e.g.
+     *          a timestamp) writes its output in place instead of through a temporary
+     *          buffer and raw(). Must be followed by commitValue() before any other call.
+     * @warning Like raw(), the bytes are neither validated nor escaped.
+     */
+    char *reserveValue(size_t maxLength);
+
+    /**
+     * @brief Complete a value started with reserveValue().
+     * @param length Bytes actually written (1..maxLength).
+     * @retval true Success.
+     * @retval false No value was reserved, or @p length is 0 or exceeds the reservation.
+     */
+    bool commitValue(size_t length);
+
+    /**
+     * @name Range writers
+     * @brief Write a whole container from a range, with one container-level state transition.
+     * @details @p range is anything a range-based `for` accepts: a C array, `std::vector`,
+     *          `std::array`, ... Elements of type `bool`, any integer type, `float` and
+     *          `double` are formatted straight into the buffer, chosen at compile time by
+     *          overload; only the separator is decided per element. Other element types go
+     *          through value() (e.g. `const char *`, JsonToken) or the @p serialize callback.
+     *
+     *          In pagination and best-effort modes every element takes the regular path, so
+     *          pages are still cut and values dropped per element.
+     * @retval true Success.
+     * @retval false Error (invalid state or capacity), or an element was dropped in
+     *         best-effort mode (see ok()).
+     * @{
+     */
+    /** @brief Write @p range as an array of scalars, strings or tokens. */
+    template <typename Range>
+    bool array(const Range &range);
+
+    /**
+     * @brief Write @p range as an array, each element written by @p serialize.
+     * @param serialize Callable as `bool(JsonBufWriter &, const Element &)` writing one value.
+     */
+    template <typename Range, typename Serializer>
+    bool array(const Range &range, Serializer serialize);
+
+    /**
+     * @brief Write a map-like range of key/value pairs (`first`, `second`) as an object.
+     * @details Keys are `const char *` or have `c_str()` (`std::string`, Arduino `String`).
+     */
+    template <typename MapRange>
+    bool object(const MapRange &map);
+
+    /**
+     * @brief Write a map-like range as an object, each value written by @p serialize.
+     * @param serialize Callable as `bool(JsonBufWriter &, const Value &)` writing one value.
+     */
+    template <typename MapRange, typename Serializer>
+    bool object(const MapRange &map, Serializer serialize);
+    /** @} */
+
+    /**
+     * @brief Insert the complete document of another writer as the next value.
+     * @param child Writer holding one finished root value (e.g. a cached sub-object).
+     * @retval true Success.
+     * @retval false @p child is in error, has open containers, is empty, has flushed part of
+     *         its output, or is this writer; or invalid state/capacity here.
+     * @details The child's bytes are already escaped, so they are copied with a single
+     *          capacity check. A length prefix reserved in @p child is not copied. The
+     *          child's encoding options (e.g. setAsciiOnly()) apply to the embedded bytes.
+     */
+    bool embed(const JsonBufWriter &child);
+
+    /**
+     * @brief Replay a cached value, or start recording it.
+     * @param cache Fragment cache to consult.
+     * @param id Fragment id.
+     * @param version Version of the data the fragment is produced from.
+     * @retval true The cached bytes were written as the next value; skip writing it.
+     * @retval false Not cached at @p version: write the value now, then call endCached().
+     *         Also returned on error (another recording in progress, or invalid state/capacity);
+     *         the writer is then in the error state, see #ok().
+     * @details A fragment is one value or, inside an object with no key pending, one or more
+     *          complete members (`"key":value` pairs).
+     */
+    bool beginCached(JsonFragmentCache &cache, uint32_t id, uint32_t version);
+
+    /**
+     * @brief Finish a value started after beginCached() returned false and store its bytes.
+     * @param cache The cache passed to beginCached().
+     * @retval true The value is complete (it is cached unless it exceeds the slot size or
+     *         was already flushed out of the buffer).
+     * @retval false No recording in progress, containers left open, or no value written.
+     */
+    bool endCached(JsonFragmentCache &cache);
+
     // ----------------------------
     // Finalization
     // ----------------------------
@@ -214,6 +793,15 @@ public:
      */
     bool finalize(const uint8_t *&output, size_t &length);
 
+    /**
+     * @brief Hand the pending bytes to the flush handler and restart at the beginning of the buffer.
+     * @retval true Success (also when nothing was pending).
+     * @retval false Prior error, or the handler rejected the bytes.
+     * @details The container state is preserved, so writing continues the same document.
+     *          Without a handler the caller is assumed to have consumed data()/size() already.
+     */
+    bool flush();
+
     // ----------------------------
     // Query
     // ----------------------------
@@ -226,31 +814,121 @@ public:
 
     /**
      * @brief Bytes written so far.
-     * @return Current size in bytes (0 if nothing written).
+     * @return Current size in bytes (0 if nothing written). With a flush handler this counts
+     *         only the bytes still in the buffer; see flushedSize().
      */
     size_t size() const;
 
+    /**
+     * @brief Bytes of the current document already passed on by flush().
+     * @return Total flushed byte count since construction/reset.
+     */
+    size_t flushedSize() const;
+
+    /**
+     * @brief Free space left in the buffer.
+     * @return Bytes that can still be written before the buffer is full (or a flush is needed).
+     */
+    size_t available() const;
+
+    /**
+     * @brief Pointer to the start of the buffer (valid for #size() bytes).
+     * @note Unlike finalize(), this does not require the document to be complete.
+     */
+    const uint8_t *data() const;
+
 private:
     /** @brief Container frame state for nesting. */
     struct Frame
     {
-        bool isObject;    ///< True if this frame is an object.
-        bool isFirst;     ///< True if writing the first element in the container.
-        bool expectValue; ///< True if a value is expected (after a key in an object).
+        bool isObject;         ///< True if this frame is an object.
+        bool isFirst;          ///< True if writing the first element in the container.
+        bool expectValue;      ///< True if a value is expected (after a key in an object).
+        uint32_t contentStart; ///< Buffer offset just after the opening bracket.
+        uint32_t elementStart; ///< Buffer offset where the current array element begins.
     };
 
     // Buffer pointers and counters
-    uint8_t *buffer_; ///< Output buffer.
-    size_t capacity_; ///< Total capacity of the buffer.
-    size_t length_;   ///< Current write position.
-    bool hasError_;   ///< Error flag.
+    uint8_t *buffer_;      ///< Output buffer.
+    size_t capacity_;      ///< Total capacity of the buffer.
+    size_t limit_;         ///< Soft capacity checked by ensureCapacity() (see #checksum_).
+    size_t length_;        ///< Current write position.
+    bool hasError_;        ///< Error flag.
+    size_t flushed_;       ///< Bytes handed to the flush handler so far.
+    size_t documentStart_; ///< Offset of the JSON value (after any length prefix).
+    size_t recordStart_;   ///< Offset where the current record begins (JSON Lines mode).
+    size_t recordCount_;   ///< Records completed since construction/reset.
+
+    /** @brief Bit layout of JsonWriterState::flags. */
+    enum : uint16_t
+    {
+        STATE_ERROR = 0x01,
+        STATE_ROOT_EXPECT_VALUE = 0x02,
+        STATE_ASCII_ONLY = 0x04,
+        STATE_UTF8_SHIFT = 3, ///< Utf8Mode in bits 3-4.
+        STATE_UTF8_MASK = 0x18,
+        STATE_JSON_LINES = 0x20,
+        STATE_ROLLBACK = 0x40,
+        STATE_PAGINATE = 0x80,
+        STATE_BEST_EFFORT = 0x100,
+        STATE_SCALED_FLOATS = 0x200
+    };
+
+    /** @brief Values of JsonPlaceholder::kind. */
+    enum : uint8_t
+    {
+        PLACEHOLDER_NUMBER = 1,
+        PLACEHOLDER_PREFIX_BIG_ENDIAN = 2,
+        PLACEHOLDER_PREFIX_LITTLE_ENDIAN = 3
+    };
+
+    // Streaming output
+    FlushHandler flushHandler_; ///< Called when the buffer is full (optional).
+    void *flushContext_;        ///< Opaque pointer for #flushHandler_.
+
+    // Checksum
+    JsonChecksum *checksum_; ///< Fed with the document (optional).
+    size_t hashed_;          ///< Buffer bytes already fed to #checksum_.
+    size_t hashHold_;        ///< Document offset of the first placeholder; hashing stops there.
 
     // State tracking
     uint8_t depth_;          ///< Current nesting depth.
     uint8_t floatPrecision_; ///< Decimal digits for float/double serialization.
+    FloatFormat floatFormat_; ///< Decimal or scaled-integer floats.
     bool expectValue_;       ///< Root-level value expectation flag.
     Frame stack_[MAX_DEPTH]; ///< Stack of active container frames.
 
+    // String encoding options
+    Utf8Mode utf8Mode_; ///< Validation of non-ASCII bytes.
+    bool asciiOnly_;    ///< Escape all non-ASCII code points.
+
+    // Multi-document output
+    bool jsonLines_;       ///< Terminate each root value with '\n' and allow another.
+    bool rollbackRecords_; ///< Drop the unfinished record when an error occurs.
+    bool rolledBack_;      ///< An unfinished record was dropped since reset().
+
+    // Pagination
+    bool paginate_;        ///< Split overflowing arrays into complete documents.
+    bool reserveClosers_;  ///< Keep one byte per open container free.
+    uint8_t reserved_;     ///< Bytes held back for closing brackets.
+    size_t pageCount_;     ///< Pages passed to the flush handler.
+
+    // Best-effort mode
+    bool bestEffort_;      ///< Drop values that do not fit instead of failing.
+    bool overflow_;        ///< The pending error is a capacity failure.
+    bool valueFirst_;      ///< Frame's isFirst before the current value.
+    bool skipValue_;       ///< Refuse the value of a dropped key.
+    uint8_t skipDepth_;    ///< Open containers that were dropped.
+    size_t valueStart_;    ///< Document offset where the current value (or key) began.
+    size_t droppedCount_;  ///< Values dropped since reset().
+
+    // Caller-formatted values
+    size_t spanLength_; ///< Bytes granted by reserveValue(); 0 when none is pending.
+
+    // Timestamps
+    int32_t dateDays_;  ///< Day (since 1970-01-01) held in dateText_.
+    char dateText_[10]; ///< `YYYY-MM-DD` of the last timestamp written.
+
     // The following helpers are internal implementation details.
     /// @cond INTERNAL
     // State queries
@@ -259,6 +937,7 @@ private:
     Frame &currentFrame();
 
     // Internal container operations
+    bool beginKey();
     bool openContainer(char openChar, bool isObject);
     bool closeContainer(char closeChar, bool isObject);
 
@@ -266,23 +945,438 @@ private:
     bool addCommaIfNeeded();
     bool writeString(const char *str);
     bool writeStringWithLength(const char *str, size_t length);
-    bool writeNumber(const char *format, ...);
+    bool writeInteger(uint64_t magnitude, bool negative);
     bool writeFloat(double value);
     bool writeRawData(const char *data, size_t length);
+    char *beginFormatted(size_t maxLength);
+    bool endFormatted(char *end);
     bool appendChar(char character);
     bool appendString(const char *str, size_t length);
     bool escapeCharacter(unsigned char character);
+    bool writeNonAscii(const uint8_t *data, size_t length, size_t &consumed);
+    bool appendReencoded(const char *body, size_t length);
+    bool writeUnicodeEscape(uint32_t codePoint);
 
     // Buffer checks
-    bool ensureCapacity(size_t additionalBytes) const;
-    bool setError();
+    bool ensureCapacity(size_t additionalBytes);
+    JSONBUF_COLD bool makeRoom(size_t additionalBytes);
+    bool nextPage();
+    bool dropValue();
+    bool refuseContainer();
+    void hashFinished();
+    void hashBuffered();
+    void updateLimit();
+    bool rootStarted() const;
+    // Error path kept out of line so callers' fast paths stay small
+    JSONBUF_COLD bool setError()
+    {
+        // In best-effort mode a value that does not fit is removed instead
+        const bool overflow = overflow_;
+        overflow_ = false;
+        if (!hasError_ && overflow && dropValue())
+        {
+            return false;
+        }
+        if (!hasError_ && rollbackRecords_)
+        {
+            rollbackRecord();
+        }
+        hasError_ = true;
+        return false;
+    }
 
     // Format helpers
-    int formatFloat(const char *format, double value);
-    bool formatWithVArgs(const char *format, va_list args);
+    static char *formatUnsigned(uint64_t value, char *end);
+    int formatFloat(double value);
+    bool scaleFloat(double value, uint64_t &magnitude, bool &negative) const;
+
+    // Range writer elements: scalars are formatted in place, anything else goes through value()
+    bool element(bool boolean);
+    bool element(signed char integer);
+    bool element(unsigned char integer);
+    bool element(short integer);
+    bool element(unsigned short integer);
+    bool element(int integer);
+    bool element(unsigned int integer);
+    bool element(long integer);
+    bool element(unsigned long integer);
+    bool element(long long integer);
+    bool element(unsigned long long integer);
+    bool element(float number);
+    bool element(double number);
+    template <typename T>
+    bool element(const T &other);
+    bool integerElement(uint64_t magnitude, bool negative);
+    bool appendElement(char *text, size_t length);
+    bool openRange(bool isObject);
+    static const char *keyText(const char *key);
+    template <typename Key>
+    static const char *keyText(const Key &key);
 
     // State updates after writing values
-    void updateStateAfterValue();
+    bool updateStateAfterValue();
     void updateStateAfterValueIfArrayOrRoot();
+    bool endRecord();
+    JSONBUF_COLD void rollbackRecord();
     /// @endcond
 };
+
+// ----------------------------
+// Hot-path helpers
+// ----------------------------
+// Defined here so they are inlined into every caller, including the header-only build.
+
+/// @cond INTERNAL
+inline bool JsonBufWriter::inAnyContainer() const
+{
+    return depth_ > 0;
+}
+
+inline bool JsonBufWriter::inObject() const
+{
+    return inAnyContainer() && stack_[depth_ - 1].isObject;
+}
+
+inline JsonBufWriter::Frame &JsonBufWriter::currentFrame()
+{
+    return stack_[depth_ - 1];
+}
+
+inline bool JsonBufWriter::ensureCapacity(size_t additionalBytes)
+{
+    return JSONBUF_LIKELY(length_ + additionalBytes + reserved_ <= limit_) || makeRoom(additionalBytes);
+}
+
+inline bool JsonBufWriter::rootStarted() const
+{
+    return flushed_ + length_ > documentStart_;
+}
+
+inline bool JsonBufWriter::appendChar(char character)
+{
+    if (JSONBUF_UNLIKELY(hasError_ || !ensureCapacity(1)))
+    {
+        return setError();
+    }
+
+    buffer_[length_++] = static_cast<uint8_t>(character);
+    return true;
+}
+
+inline bool JsonBufWriter::addCommaIfNeeded()
+{
+    if (JSONBUF_UNLIKELY(hasError_ || skipDepth_ != 0 || skipValue_))
+    {
+        // Error, or part of a value dropped in best-effort mode
+        skipValue_ = false;
+        return false;
+    }
+
+    if (inAnyContainer())
+    {
+        Frame &frame = currentFrame();
+
+        // In object: only add comma if we're not expecting a value (i.e., we just finished a key-value pair).
+        // In array: always add comma before elements (except the first).
+        if (!frame.isObject || !frame.expectValue)
+        {
+            valueStart_ = flushed_ + length_;
+            valueFirst_ = frame.isFirst;
+            if (!frame.isObject)
+            {
+                frame.elementStart = static_cast<uint32_t>(length_);
+            }
+            if (!frame.isFirst)
+            {
+                if (JSONBUF_UNLIKELY(!ensureCapacity(1)))
+                {
+                    return setError();
+                }
+                // Pagination may have just started a page on which this element comes first
+                if (!frame.isFirst)
+                {
+                    buffer_[length_++] = ',';
+                }
+            }
+            frame.isFirst = false;
+        }
+    }
+    else if (rootStarted())
+    {
+        // Root: allow only a single value
+        return setError();
+    }
+    else
+    {
+        valueStart_ = flushed_ + length_;
+    }
+
+    return true;
+}
+
+inline bool JsonBufWriter::updateStateAfterValue()
+{
+    if (inAnyContainer())
+    {
+        // After a value in object, we're done with this key-value pair.
+        // For arrays expectValue is never set, so clearing it is harmless.
+        currentFrame().expectValue = false;
+        return true;
+    }
+
+    expectValue_ = false;
+    return !jsonLines_ || endRecord();
+}
+
+// ----------------------------
+// Range writers
+// ----------------------------
+// Templates and their per-element helpers, inlined into each loop.
+
+inline bool JsonBufWriter::appendElement(char *text, size_t length)
+{
+    // Only called inside the container opened by array()/object(): no key or root checks,
+    // and text[-1] is free for the separator
+    Frame &frame = currentFrame();
+    if (!frame.isObject && !frame.isFirst)
+    {
+        *--text = ',';
+        ++length;
+    }
+    frame.isFirst = false;
+    frame.expectValue = false;
+    return appendString(text, length);
+}
+
+inline bool JsonBufWriter::integerElement(uint64_t magnitude, bool negative)
+{
+    if (JSONBUF_UNLIKELY(paginate_ || bestEffort_))
+    {
+        return writeInteger(magnitude, negative); // Needs the per-value bookkeeping
+    }
+
+    char digits[22];
+    char *end = digits + sizeof(digits);
+    char *begin = formatUnsigned(magnitude, end);
+    if (negative)
+    {
+        *--begin = '-';
+    }
+    return appendElement(begin, static_cast<size_t>(end - begin));
+}
+
+inline bool JsonBufWriter::element(bool boolean)
+{
+    if (JSONBUF_UNLIKELY(paginate_ || bestEffort_))
+    {
+        return value(boolean);
+    }
+
+    char text[6];
+    memcpy(text + 1, boolean ? "true" : "false", 5);
+    return appendElement(text + 1, boolean ? 4u : 5u);
+}
+
+inline bool JsonBufWriter::element(signed char integer)
+{
+    return element(static_cast<long long>(integer));
+}
+
+inline bool JsonBufWriter::element(unsigned char integer)
+{
+    return integerElement(integer, false);
+}
+
+inline bool JsonBufWriter::element(short integer)
+{
+    return element(static_cast<long long>(integer));
+}
+
+inline bool JsonBufWriter::element(unsigned short integer)
+{
+    return integerElement(integer, false);
+}
+
+inline bool JsonBufWriter::element(int integer)
+{
+    return element(static_cast<long long>(integer));
+}
+
+inline bool JsonBufWriter::element(unsigned int integer)
+{
+    return integerElement(integer, false);
+}
+
+inline bool JsonBufWriter::element(long integer)
+{
+    return element(static_cast<long long>(integer));
+}
+
+inline bool JsonBufWriter::element(unsigned long integer)
+{
+    return integerElement(integer, false);
+}
+
+inline bool JsonBufWriter::element(long long integer)
+{
+    // Negate in unsigned arithmetic so the minimum value is well-defined
+    const uint64_t magnitude = integer < 0 ? 0u - static_cast<uint64_t>(integer) : static_cast<uint64_t>(integer);
+    return integerElement(magnitude, integer < 0);
+}
+
+inline bool JsonBufWriter::element(unsigned long long integer)
+{
+    return integerElement(integer, false);
+}
+
+inline bool JsonBufWriter::element(float number)
+{
+    return element(static_cast<double>(number));
+}
+
+inline bool JsonBufWriter::element(double number)
+{
+    if (floatFormat_ == FloatFormat::ScaledInteger)
+    {
+        uint64_t magnitude;
+        bool negative;
+        return scaleFloat(number, magnitude, negative) ? integerElement(magnitude, negative) : setError();
+    }
+    if (JSONBUF_UNLIKELY(paginate_ || bestEffort_))
+    {
+        return writeFloat(number);
+    }
+
+    Frame &frame = currentFrame();
+    if (!frame.isObject && !frame.isFirst && !appendChar(','))
+    {
+        return false;
+    }
+    frame.isFirst = false;
+    frame.expectValue = false;
+    return formatFloat(number) >= 0;
+}
+
+template <typename T>
+inline bool JsonBufWriter::element(const T &other)
+{
+    return value(other);
+}
+
+inline bool JsonBufWriter::openRange(bool isObject)
+{
+    if (isObject ? beginObject() : beginArray())
+    {
+        return true;
+    }
+    // A container refused in best-effort mode still needs its closing call
+    if (!hasError_)
+    {
+        isObject ? endObject() : endArray();
+    }
+    return false;
+}
+
+inline const char *JsonBufWriter::keyText(const char *key)
+{
+    return key;
+}
+
+template <typename Key>
+inline const char *JsonBufWriter::keyText(const Key &key)
+{
+    return key.c_str();
+}
+
+template <typename Range>
+bool JsonBufWriter::array(const Range &range)
+{
+    if (!openRange(false))
+    {
+        return false;
+    }
+    bool complete = true;
+    for (const auto &item : range)
+    {
+        if (!element(item))
+        {
+            if (hasError_)
+            {
+                return false;
+            }
+            complete = false; // Dropped in best-effort mode
+        }
+    }
+    return endArray() && complete;
+}
+
+template <typename Range, typename Serializer>
+bool JsonBufWriter::array(const Range &range, Serializer serialize)
+{
+    if (!openRange(false))
+    {
+        return false;
+    }
+    bool complete = true;
+    for (const auto &item : range)
+    {
+        if (!serialize(*this, item))
+        {
+            if (hasError_)
+            {
+                return false;
+            }
+            complete = false; // Dropped in best-effort mode
+        }
+    }
+    return endArray() && complete;
+}
+
+template <typename MapRange>
+bool JsonBufWriter::object(const MapRange &map)
+{
+    if (!openRange(true))
+    {
+        return false;
+    }
+    bool complete = true;
+    for (const auto &entry : map)
+    {
+        if (!key(keyText(entry.first)) || !element(entry.second))
+        {
+            if (hasError_)
+            {
+                return false;
+            }
+            complete = false; // Dropped in best-effort mode
+        }
+    }
+    return endObject() && complete;
+}
+
+template <typename MapRange, typename Serializer>
+bool JsonBufWriter::object(const MapRange &map, Serializer serialize)
+{
+    if (!openRange(true))
+    {
+        return false;
+    }
+    bool complete = true;
+    for (const auto &entry : map)
+    {
+        if (!key(keyText(entry.first)) || !serialize(*this, entry.second))
+        {
+            if (hasError_)
+            {
+                return false;
+            }
+            complete = false; // Dropped in best-effort mode
+        }
+    }
+    return endObject() && complete;
+}
+/// @endcond
+
+#if defined(JSON_BUF_WRITER_HEADER_ONLY)
+#include "json_buffer_writer_impl.hpp"
+#endif
@@ -0,0 +1,1712 @@
+#pragma once
+
+/**
+ * @file
+ * @brief Out-of-line member definitions of `JsonBufWriter`.
+ *
+ * @details
+ * Compiled once through `json_buffer_writer.cpp`, or included by
+ * `json_buffer_writer.hpp` when `JSON_BUF_WRITER_HEADER_ONLY` is defined, in which
+ * case every definition below becomes `inline` via #JSONBUF_INLINE.
+ */
+
+#include "json_buffer_writer.hpp"
+#include "json_checksum.hpp"
+#include "json_reader.hpp"
+#include "json_scan.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+// Implementation
+
+/// @cond INTERNAL
+namespace json_detail
+{
+    /** @brief "00" to "99": two decimal digits per lookup. */
+    static const char digitPairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+    /** @brief Write @p value (0-99) as two digits at @p out; returns the end. */
+    inline char *formatTwoDigits(uint32_t value, char *out)
+    {
+        memcpy(out, digitPairs + value * 2, 2);
+        return out + 2;
+    }
+
+    /** @brief Lower-case hex digits. */
+    static const char hexDigits[] = "0123456789abcdef";
+
+    /** @brief Write @p value as two hex digits at @p out; returns the end. */
+    inline char *formatHexByte(uint8_t value, char *out)
+    {
+        out[0] = hexDigits[value >> 4];
+        out[1] = hexDigits[value & 0xF];
+        return out + 2;
+    }
+
+    /** @brief Write @p value as 1 to 4 hex digits without leading zeros; returns the end. */
+    inline char *formatHexGroup(uint16_t value, char *out)
+    {
+        int shift = 12;
+        while (shift > 0 && (value >> shift) == 0)
+        {
+            shift -= 4;
+        }
+        for (; shift >= 0; shift -= 4)
+        {
+            *out++ = hexDigits[(value >> shift) & 0xF];
+        }
+        return out;
+    }
+
+    /** @brief Write four bytes as a dotted quad (`a.b.c.d`); returns the end. */
+    inline char *formatIPv4(const uint8_t *address, char *out)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            if (i != 0)
+            {
+                *out++ = '.';
+            }
+            uint32_t octet = address[i];
+            if (octet >= 100)
+            {
+                *out++ = static_cast<char>('0' + octet / 100);
+                out = formatTwoDigits(octet % 100, out);
+            }
+            else if (octet >= 10)
+            {
+                out = formatTwoDigits(octet, out);
+            }
+            else
+            {
+                *out++ = static_cast<char>('0' + octet);
+            }
+        }
+        return out;
+    }
+
+    /**
+     * @brief Write the proleptic Gregorian date @p days after 1970-01-01 as `YYYY-MM-DD`.
+     * @details civil_from_days (H. Hinnant): shift to eras of 400 years starting on
+     *          March 1st, so leap days fall at the end of a year and month lengths follow a
+     *          linear pattern. 32-bit arithmetic suffices for years 0000-9999.
+     */
+    inline void formatDate(int32_t days, char *out)
+    {
+        const int32_t z = days + 719468; // Days since 0000-03-01
+        const int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+        const uint32_t dayOfEra = static_cast<uint32_t>(z - era * 146097);
+        const uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const uint32_t shiftedMonth = (5 * dayOfYear + 2) / 153; // 0 = March
+        const uint32_t day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+        const uint32_t month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+        const uint32_t year = static_cast<uint32_t>(static_cast<int32_t>(yearOfEra) + era * 400) + (month <= 2 ? 1 : 0);
+
+        out = formatTwoDigits(year / 100, out);
+        out = formatTwoDigits(year % 100, out);
+        *out++ = '-';
+        out = formatTwoDigits(month, out);
+        *out++ = '-';
+        formatTwoDigits(day, out);
+    }
+}
+/// @endcond
+
+JSONBUF_INLINE JsonToken::JsonToken()
+    : length_(0), kind_(Kind::Value)
+{
+}
+
+JSONBUF_INLINE JsonToken::JsonToken(const char *str, Kind kind)
+    : length_(0), kind_(kind)
+{
+    assign(str, strlen(str), kind);
+}
+
+JSONBUF_INLINE bool JsonToken::assign(const char *str, size_t length, Kind kind)
+{
+    length_ = 0;
+    kind_ = kind;
+
+    // Reuse the writer's escaping: a root string value is exactly the quoted text
+    uint8_t *out = reinterpret_cast<uint8_t *>(encoded_);
+    JsonBufWriter encoder(out, CAPACITY);
+    if (!encoder.value(str, length))
+    {
+        return false;
+    }
+
+    size_t encodedLength = encoder.size();
+    if (kind == Kind::Key)
+    {
+        if (encodedLength >= CAPACITY)
+        {
+            return false;
+        }
+        encoded_[encodedLength++] = ':';
+    }
+
+    length_ = static_cast<uint8_t>(encodedLength);
+    return true;
+}
+
+JSONBUF_INLINE bool JsonToken::ok() const
+{
+    return length_ != 0;
+}
+
+JSONBUF_INLINE bool JsonToken::isKey() const
+{
+    return kind_ == Kind::Key;
+}
+
+JSONBUF_INLINE const char *JsonToken::data() const
+{
+    return encoded_;
+}
+
+JSONBUF_INLINE size_t JsonToken::size() const
+{
+    return length_;
+}
+
+JSONBUF_INLINE JsonBufWriter::JsonBufWriter(uint8_t *buf, size_t capacity)
+    : buffer_(buf), capacity_(capacity), limit_(capacity), length_(0), hasError_(false), flushed_(0), documentStart_(0),
+      recordStart_(0), recordCount_(0),
+      flushHandler_(nullptr), flushContext_(nullptr), checksum_(nullptr), hashed_(0), hashHold_(SIZE_MAX), depth_(0), floatPrecision_(DEFAULT_FLOAT_PRECISION), floatFormat_(FloatFormat::Decimal), expectValue_(false),
+      utf8Mode_(Utf8Mode::Passthrough), asciiOnly_(false),
+      jsonLines_(false), rollbackRecords_(false), rolledBack_(false),
+      paginate_(false), reserveClosers_(false), reserved_(0), pageCount_(0),
+      bestEffort_(false), overflow_(false), valueFirst_(false), skipValue_(false), skipDepth_(0),
+      valueStart_(0), droppedCount_(0), spanLength_(0), dateDays_(INT32_MIN)
+{
+}
+
+JSONBUF_INLINE void JsonBufWriter::reset(uint8_t *buf, size_t capacity)
+{
+    buffer_ = buf;
+    capacity_ = capacity;
+    length_ = 0;
+    hasError_ = false;
+    hashed_ = 0;
+    hashHold_ = SIZE_MAX;
+    if (checksum_)
+    {
+        checksum_->reset();
+    }
+    updateLimit();
+    flushed_ = 0;
+    documentStart_ = 0;
+    recordStart_ = 0;
+    recordCount_ = 0;
+    rolledBack_ = false;
+    reserved_ = 0;
+    pageCount_ = 0;
+    overflow_ = false;
+    skipValue_ = false;
+    skipDepth_ = 0;
+    valueStart_ = 0;
+    droppedCount_ = 0;
+    spanLength_ = 0;
+    depth_ = 0;
+    expectValue_ = false;
+    floatPrecision_ = DEFAULT_FLOAT_PRECISION;
+    floatFormat_ = FloatFormat::Decimal;
+}
+
+JSONBUF_INLINE void JsonBufWriter::setFloatPrecision(uint8_t digits)
+{
+    floatPrecision_ = digits;
+}
+
+JSONBUF_INLINE void JsonBufWriter::setFloatFormat(FloatFormat format)
+{
+    floatFormat_ = format;
+}
+
+JSONBUF_INLINE uint64_t JsonBufWriter::floatScale() const
+{
+    if (floatPrecision_ > 18)
+    {
+        return 0;
+    }
+    uint64_t scale = 1;
+    for (uint8_t i = 0; i < floatPrecision_; ++i)
+    {
+        scale *= 10;
+    }
+    return scale;
+}
+
+JSONBUF_INLINE void JsonBufWriter::setUtf8Mode(Utf8Mode mode)
+{
+    utf8Mode_ = mode;
+}
+
+JSONBUF_INLINE void JsonBufWriter::setAsciiOnly(bool enabled)
+{
+    asciiOnly_ = enabled;
+}
+
+JSONBUF_INLINE void JsonBufWriter::setFlushHandler(FlushHandler handler, void *context)
+{
+    flushHandler_ = handler;
+    flushContext_ = context;
+}
+
+JSONBUF_INLINE void JsonBufWriter::setChecksum(JsonChecksum *checksum)
+{
+    checksum_ = checksum;
+    hashed_ = 0;
+    if (checksum_)
+    {
+        checksum_->reset();
+    }
+    updateLimit();
+}
+
+JSONBUF_INLINE bool JsonBufWriter::reserveNumber(JsonPlaceholder &slot, uint8_t width)
+{
+    // A page cut would move or deliver the slot behind fill()'s back
+    if (width == 0 || width > MAX_NUMBER_WIDTH || paginate_)
+    {
+        return setError();
+    }
+    if (!addCommaIfNeeded())
+    {
+        return false;
+    }
+    // The slot must be contiguous so fill() can patch it in place
+    if (!ensureCapacity(width))
+    {
+        return setError();
+    }
+
+    slot = JsonPlaceholder{static_cast<uint32_t>(flushed_ + length_), width, PLACEHOLDER_NUMBER};
+    hashHold_ = hashHold_ < slot.offset ? hashHold_ : slot.offset;
+    buffer_[length_] = '0';
+    memset(buffer_ + length_ + 1, ' ', width - 1);
+    length_ += width;
+
+    return updateStateAfterValue();
+}
+
+JSONBUF_INLINE bool JsonBufWriter::reserveLengthPrefix(JsonPlaceholder &slot, uint8_t bytes, bool bigEndian)
+{
+    if (hasError_ || bytes == 0 || bytes > 8 || paginate_ || depth_ != 0 || rootStarted() || !ensureCapacity(bytes))
+    {
+        return setError();
+    }
+
+    slot = JsonPlaceholder{static_cast<uint32_t>(flushed_ + length_), bytes,
+                           bigEndian ? PLACEHOLDER_PREFIX_BIG_ENDIAN : PLACEHOLDER_PREFIX_LITTLE_ENDIAN};
+    hashHold_ = hashHold_ < slot.offset ? hashHold_ : slot.offset;
+    memset(buffer_ + length_, 0, bytes);
+    length_ += bytes;
+    documentStart_ = flushed_ + length_;
+    return true;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::fill(const JsonPlaceholder &slot, uint64_t value)
+{
+    if (hasError_)
+    {
+        return false;
+    }
+    if (slot.kind == 0 || slot.offset < flushed_ + (checksum_ ? hashed_ : 0) ||
+        slot.offset + slot.width > flushed_ + length_)
+    {
+        return setError(); // Unset handle, or the slot has already left the buffer (or been hashed)
+    }
+
+    uint8_t *out = buffer_ + (slot.offset - flushed_);
+    if (slot.kind == PLACEHOLDER_NUMBER)
+    {
+        char digits[MAX_NUMBER_WIDTH];
+        char *end = digits + sizeof(digits);
+        char *begin = formatUnsigned(value, end);
+        size_t count = static_cast<size_t>(end - begin);
+        if (count > slot.width)
+        {
+            return setError();
+        }
+        memcpy(out, begin, count);
+        memset(out + count, ' ', slot.width - count);
+        return true;
+    }
+
+    if (slot.width < 8 && (value >> (8 * slot.width)) != 0)
+    {
+        return setError();
+    }
+    for (uint8_t i = 0; i < slot.width; ++i)
+    {
+        uint8_t byte = static_cast<uint8_t>(value >> (8 * i));
+        out[slot.kind == PLACEHOLDER_PREFIX_BIG_ENDIAN ? slot.width - 1 - i : i] = byte;
+    }
+    return true;
+}
+
+JSONBUF_INLINE size_t JsonBufWriter::documentLength() const
+{
+    return flushed_ + length_ - documentStart_;
+}
+
+JSONBUF_INLINE size_t JsonBufWriter::recordCount() const
+{
+    return recordCount_;
+}
+
+JSONBUF_INLINE size_t JsonBufWriter::completeSize() const
+{
+    return recordStart_ > flushed_ ? recordStart_ - flushed_ : 0;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::rolledBack() const
+{
+    return rolledBack_;
+}
+
+JSONBUF_INLINE size_t JsonBufWriter::pageCount() const
+{
+    return pageCount_;
+}
+
+JSONBUF_INLINE size_t JsonBufWriter::droppedCount() const
+{
+    return droppedCount_;
+}
+
+JSONBUF_INLINE void JsonBufWriter::continueIn(uint8_t *buf, size_t capacity)
+{
+    hashBuffered();
+    flushed_ += length_;
+    length_ = 0;
+    hashed_ = 0;
+    buffer_ = buf;
+    capacity_ = capacity;
+    updateLimit();
+}
+
+JSONBUF_INLINE JsonWriterState JsonBufWriter::saveState() const
+{
+    JsonWriterState state = {};
+    state.offset = static_cast<uint32_t>(flushed_ + length_);
+    state.start = static_cast<uint32_t>(documentStart_);
+    state.depth = depth_;
+    for (uint8_t i = 0; i < depth_; ++i)
+    {
+        const uint8_t bit = static_cast<uint8_t>(1u << i);
+        state.objectMask |= stack_[i].isObject ? bit : 0;
+        state.firstMask |= stack_[i].isFirst ? bit : 0;
+        state.expectMask |= stack_[i].expectValue ? bit : 0;
+    }
+    state.flags = static_cast<uint16_t>((hasError_ ? STATE_ERROR : 0) |
+                                        (expectValue_ ? STATE_ROOT_EXPECT_VALUE : 0) |
+                                        (asciiOnly_ ? STATE_ASCII_ONLY : 0) |
+                                        (jsonLines_ ? STATE_JSON_LINES : 0) |
+                                        (rollbackRecords_ ? STATE_ROLLBACK : 0) |
+                                        (paginate_ ? STATE_PAGINATE : 0) |
+                                        (bestEffort_ ? STATE_BEST_EFFORT : 0) |
+                                        (floatFormat_ == FloatFormat::ScaledInteger ? STATE_SCALED_FLOATS : 0) |
+                                        (static_cast<uint8_t>(utf8Mode_) << STATE_UTF8_SHIFT));
+    state.floatPrecision = floatPrecision_;
+    return state;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::restoreState(const JsonWriterState &state, uint8_t *buf, size_t capacity)
+{
+    // The document continues, and so does its checksum
+    JsonChecksum *checksum = checksum_;
+    checksum_ = nullptr;
+    reset(buf, capacity);
+    checksum_ = checksum;
+    updateLimit();
+
+    const uint8_t utf8Mode = (state.flags & STATE_UTF8_MASK) >> STATE_UTF8_SHIFT;
+    if ((state.flags & STATE_ERROR) || state.depth > MAX_DEPTH || state.start > state.offset ||
+        utf8Mode > static_cast<uint8_t>(Utf8Mode::Reject))
+    {
+        return setError();
+    }
+
+    flushed_ = state.offset;
+    documentStart_ = state.start;
+    recordStart_ = state.start;
+    depth_ = state.depth;
+    for (uint8_t i = 0; i < depth_; ++i)
+    {
+        const uint8_t bit = static_cast<uint8_t>(1u << i);
+        stack_[i] = Frame{(state.objectMask & bit) != 0, (state.firstMask & bit) != 0,
+                          (state.expectMask & bit) != 0, 0, 0};
+    }
+    expectValue_ = (state.flags & STATE_ROOT_EXPECT_VALUE) != 0;
+    asciiOnly_ = (state.flags & STATE_ASCII_ONLY) != 0;
+    setJsonLines((state.flags & STATE_JSON_LINES) != 0, (state.flags & STATE_ROLLBACK) != 0);
+    setPagination((state.flags & STATE_PAGINATE) != 0);
+    setBestEffort((state.flags & STATE_BEST_EFFORT) != 0);
+    utf8Mode_ = static_cast<Utf8Mode>(utf8Mode);
+    floatPrecision_ = state.floatPrecision;
+    floatFormat_ = (state.flags & STATE_SCALED_FLOATS) ? FloatFormat::ScaledInteger : FloatFormat::Decimal;
+    return true;
+}
+
+JSONBUF_INLINE void JsonBufWriter::setJsonLines(bool enabled, bool rollback)
+{
+    jsonLines_ = enabled;
+    rollbackRecords_ = enabled && rollback;
+}
+
+JSONBUF_INLINE void JsonBufWriter::setPagination(bool enabled)
+{
+    paginate_ = enabled;
+    reserveClosers_ = paginate_ || bestEffort_;
+    reserved_ = reserveClosers_ ? depth_ : 0;
+}
+
+JSONBUF_INLINE void JsonBufWriter::setBestEffort(bool enabled)
+{
+    bestEffort_ = enabled;
+    reserveClosers_ = paginate_ || bestEffort_;
+    reserved_ = reserveClosers_ ? depth_ : 0;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::beginObject()
+{
+    return openContainer('{', true);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::beginArray()
+{
+    return openContainer('[', false);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::endObject()
+{
+    return closeContainer('}', true);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::endArray()
+{
+    return closeContainer(']', false);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::key(const char *key)
+{
+    if (!beginKey())
+    {
+        return false;
+    }
+
+    if (!writeString(key))
+    {
+        return false;
+    }
+
+    if (!appendChar(':'))
+    {
+        return false;
+    }
+
+    currentFrame().expectValue = true;
+    return true;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::rawKey(const char *encodedKey, size_t length)
+{
+    if (!beginKey())
+    {
+        return false;
+    }
+
+    if (!writeRawData(encodedKey, length))
+    {
+        return false;
+    }
+
+    currentFrame().expectValue = true;
+    return true;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::key(const JsonToken &token)
+{
+    if (!token.ok() || !token.isKey())
+    {
+        return setError();
+    }
+    return rawKey(token.data(), token.size());
+}
+
+JSONBUF_INLINE bool JsonBufWriter::key(uint32_t id)
+{
+    // Digits are safe in a key, so the quoted key is built on the stack and copied once
+    char encoded[14];
+    char *end = encoded + sizeof(encoded);
+    *--end = ':';
+    *--end = '"';
+    char *begin = formatUnsigned(id, end);
+    *--begin = '"';
+    return rawKey(begin, static_cast<size_t>(encoded + sizeof(encoded) - begin));
+}
+
+JSONBUF_INLINE bool JsonBufWriter::value(const char *str)
+{
+    if (!addCommaIfNeeded())
+    {
+        return false;
+    }
+    return writeString(str);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::value(const char *str, size_t length)
+{
+    if (!addCommaIfNeeded())
+    {
+        return false;
+    }
+    return writeStringWithLength(str, length);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::value(bool boolean)
+{
+    if (!addCommaIfNeeded())
+    {
+        return false;
+    }
+    if (!writeRawData(boolean ? "true" : "false", boolean ? 4u : 5u))
+    {
+        return false;
+    }
+    return updateStateAfterValue();
+}
+
+JSONBUF_INLINE bool JsonBufWriter::value(int32_t integer)
+{
+    // Negate in unsigned arithmetic so INT32_MIN is well-defined
+    uint32_t magnitude = integer < 0 ? 0u - static_cast<uint32_t>(integer) : static_cast<uint32_t>(integer);
+    return writeInteger(magnitude, integer < 0);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::value(uint32_t integer)
+{
+    return writeInteger(integer, false);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::value(int64_t integer)
+{
+    uint64_t magnitude = integer < 0 ? 0u - static_cast<uint64_t>(integer) : static_cast<uint64_t>(integer);
+    return writeInteger(magnitude, integer < 0);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::value(uint64_t integer)
+{
+    return writeInteger(integer, false);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::value(float number)
+{
+    return writeFloat(static_cast<double>(number));
+}
+
+JSONBUF_INLINE bool JsonBufWriter::value(double number)
+{
+    return writeFloat(number);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::value(const JsonToken &token)
+{
+    if (!token.ok() || token.isKey())
+    {
+        return setError();
+    }
+    if (!addCommaIfNeeded())
+    {
+        return false;
+    }
+    if (!writeRawData(token.data(), token.size()))
+    {
+        return false;
+    }
+    return updateStateAfterValue();
+}
+
+JSONBUF_INLINE bool JsonBufWriter::null()
+{
+    if (!addCommaIfNeeded())
+    {
+        return false;
+    }
+    if (!writeRawData("null", 4))
+    {
+        return false;
+    }
+    return updateStateAfterValue();
+}
+
+JSONBUF_INLINE bool JsonBufWriter::valueTimestamp(int64_t epochSeconds, uint32_t fractionalMicros, uint8_t precision)
+{
+    // Four-digit years only: 0000-01-01T00:00:00Z to 9999-12-31T23:59:59Z
+    if (precision > 6 || fractionalMicros > 999999u || epochSeconds < -62167219200LL || epochSeconds > 253402300799LL)
+    {
+        return setError();
+    }
+
+    // "YYYY-MM-DDTHH:MM:SS[.f]Z" plus quotes
+    char *out = beginFormatted(22 + (precision != 0 ? precision + 1u : 0u));
+    if (!out)
+    {
+        return false;
+    }
+
+    int32_t days = static_cast<int32_t>(epochSeconds / 86400);
+    int32_t seconds = static_cast<int32_t>(epochSeconds % 86400);
+    if (seconds < 0)
+    {
+        seconds += 86400;
+        --days;
+    }
+    if (days != dateDays_)
+    {
+        json_detail::formatDate(days, dateText_);
+        dateDays_ = days;
+    }
+
+    *out++ = '"';
+    memcpy(out, dateText_, sizeof(dateText_));
+    out += sizeof(dateText_);
+    *out++ = 'T';
+    out = json_detail::formatTwoDigits(static_cast<uint32_t>(seconds) / 3600, out);
+    *out++ = ':';
+    out = json_detail::formatTwoDigits(static_cast<uint32_t>(seconds) / 60 % 60, out);
+    *out++ = ':';
+    out = json_detail::formatTwoDigits(static_cast<uint32_t>(seconds) % 60, out);
+    if (precision != 0)
+    {
+        static const uint32_t divisors[] = {1000000, 100000, 10000, 1000, 100, 10, 1};
+        uint32_t fraction = fractionalMicros / divisors[precision];
+        *out = '.';
+        for (uint8_t i = precision; i > 0; --i)
+        {
+            out[i] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        out += precision + 1;
+    }
+    *out++ = 'Z';
+    *out++ = '"';
+    return endFormatted(out);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::valueMac(const uint8_t *mac, char separator)
+{
+    char *out = beginFormatted(19);
+    if (!out)
+    {
+        return false;
+    }
+
+    *out++ = '"';
+    for (int i = 0; i < 6; ++i)
+    {
+        if (i != 0)
+        {
+            *out++ = separator;
+        }
+        out = json_detail::formatHexByte(mac[i], out);
+    }
+    *out++ = '"';
+    return endFormatted(out);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::valueIPv4(const uint8_t *address)
+{
+    char *out = beginFormatted(17);
+    if (!out)
+    {
+        return false;
+    }
+
+    *out++ = '"';
+    out = json_detail::formatIPv4(address, out);
+    *out++ = '"';
+    return endFormatted(out);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::valueIPv6(const uint8_t *address)
+{
+    // Longest "1:2:3:4:5:6:7:8" form is 39 characters; "::ffff:255.255.255.255" is shorter
+    char *out = beginFormatted(41);
+    if (!out)
+    {
+        return false;
+    }
+
+    uint16_t groups[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        groups[i] = static_cast<uint16_t>((address[2 * i] << 8) | address[2 * i + 1]);
+    }
+
+    // RFC 5952: the longest run of two or more zero groups (the first on a tie) becomes "::"
+    int runStart = -1;
+    int runLength = 1;
+    for (int i = 0; i < 8;)
+    {
+        int j = i;
+        while (j < 8 && groups[j] == 0)
+        {
+            ++j;
+        }
+        if (j - i > runLength)
+        {
+            runStart = i;
+            runLength = j - i;
+        }
+        i = j == i ? i + 1 : j;
+    }
+
+    *out++ = '"';
+    // IPv4-mapped addresses keep the dotted quad (RFC 5952 section 5)
+    const bool mapped = runStart == 0 && runLength == 5 && groups[5] == 0xFFFF;
+    const int hexGroups = mapped ? 6 : 8;
+    for (int i = 0; i < hexGroups; ++i)
+    {
+        if (i == runStart)
+        {
+            *out++ = ':';
+            *out++ = ':';
+            i += runLength - 1;
+            continue;
+        }
+        if (i != 0 && i != runStart + runLength)
+        {
+            *out++ = ':';
+        }
+        out = json_detail::formatHexGroup(groups[i], out);
+    }
+    if (mapped)
+    {
+        *out++ = ':';
+        out = json_detail::formatIPv4(address + 12, out);
+    }
+    *out++ = '"';
+    return endFormatted(out);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::valueUuid(const uint8_t *uuid)
+{
+    char *out = beginFormatted(38);
+    if (!out)
+    {
+        return false;
+    }
+
+    *out++ = '"';
+    for (int i = 0; i < 16; ++i)
+    {
+        if (i == 4 || i == 6 || i == 8 || i == 10)
+        {
+            *out++ = '-';
+        }
+        out = json_detail::formatHexByte(uuid[i], out);
+    }
+    *out++ = '"';
+    return endFormatted(out);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::valueHex64(uint64_t value)
+{
+    char *out = beginFormatted(18);
+    if (!out)
+    {
+        return false;
+    }
+
+    out[0] = '"';
+    for (int i = 16; i > 0; --i)
+    {
+        out[i] = json_detail::hexDigits[value & 0xF];
+        value >>= 4;
+    }
+    out[17] = '"';
+    return endFormatted(out + 18);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::raw(const char *json, size_t length)
+{
+    if (!addCommaIfNeeded())
+    {
+        return false;
+    }
+    if (!writeRawData(json, length))
+    {
+        return false;
+    }
+    return updateStateAfterValue();
+}
+
+/// @cond INTERNAL
+namespace json_detail
+{
+    /** @brief Whether a comma separates @p token from the @p previous token of a value. */
+    inline bool needsComma(JsonReader::Token previous, JsonReader::Token token)
+    {
+        switch (previous)
+        {
+        case JsonReader::Token::None:
+        case JsonReader::Token::BeginObject:
+        case JsonReader::Token::BeginArray:
+        case JsonReader::Token::Key:
+            return false;
+        default:
+            return token != JsonReader::Token::EndObject && token != JsonReader::Token::EndArray;
+        }
+    }
+}
+/// @endcond
+
+JSONBUF_INLINE bool JsonBufWriter::rawValidated(const char *json, size_t length)
+{
+    if (!addCommaIfNeeded())
+    {
+        return false;
+    }
+
+    // ASCII-only output and replacement can grow strings: those go out token by token
+    const bool reencode = asciiOnly_ || utf8Mode_ == Utf8Mode::Replace;
+    JsonReader reader(json, length);
+    reader.setValidateUtf8(utf8Mode_ == Utf8Mode::Reject);
+    JsonReader::Token previous = JsonReader::Token::None;
+    JsonReader::Token token;
+
+    if (JSONBUF_LIKELY(!reencode && ensureCapacity(length)))
+    {
+        // Every byte written is taken from the input, so the minified value fits in length bytes
+        uint8_t *out = buffer_ + length_;
+        while ((token = reader.next()) != JsonReader::Token::End)
+        {
+            if (token == JsonReader::Token::Error)
+            {
+                return setError();
+            }
+            if (json_detail::needsComma(previous, token))
+            {
+                *out++ = ',';
+            }
+            const bool quoted = token == JsonReader::Token::String || token == JsonReader::Token::Key;
+            if (quoted)
+            {
+                *out++ = '"';
+            }
+            memcpy(out, reader.data(), reader.size());
+            out += reader.size();
+            if (quoted)
+            {
+                *out++ = '"';
+            }
+            if (token == JsonReader::Token::Key)
+            {
+                *out++ = ':';
+            }
+            previous = token;
+        }
+        length_ = static_cast<size_t>(out - buffer_);
+        return updateStateAfterValue();
+    }
+
+    // Does not fit as written: the minified value may still fit, or be streamed
+    overflow_ = false;
+    while ((token = reader.next()) != JsonReader::Token::End)
+    {
+        if (token == JsonReader::Token::Error)
+        {
+            return setError();
+        }
+        if (json_detail::needsComma(previous, token) && !appendChar(','))
+        {
+            return false;
+        }
+        const bool quoted = token == JsonReader::Token::String || token == JsonReader::Token::Key;
+        if ((quoted && !appendChar('"')) ||
+            !(quoted && reencode ? appendReencoded(reader.data(), reader.size())
+                                 : appendString(reader.data(), reader.size())) ||
+            (quoted && !appendChar('"')) || (token == JsonReader::Token::Key && !appendChar(':')))
+        {
+            return false;
+        }
+        previous = token;
+    }
+    return updateStateAfterValue();
+}
+
+JSONBUF_INLINE char *JsonBufWriter::reserveValue(size_t maxLength)
+{
+    if (maxLength == 0 || spanLength_ != 0)
+    {
+        setError();
+        return nullptr;
+    }
+    if (!addCommaIfNeeded())
+    {
+        return nullptr;
+    }
+    if (!ensureCapacity(maxLength))
+    {
+        setError();
+        return nullptr;
+    }
+
+    spanLength_ = maxLength;
+    return reinterpret_cast<char *>(buffer_ + length_);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::commitValue(size_t length)
+{
+    const size_t granted = spanLength_;
+    spanLength_ = 0;
+    if (hasError_ || length == 0 || length > granted)
+    {
+        return setError();
+    }
+
+    length_ += length;
+    return updateStateAfterValue();
+}
+
+JSONBUF_INLINE bool JsonBufWriter::embed(const JsonBufWriter &child)
+{
+    // The child must hold exactly one complete value, entirely in its buffer
+    if (&child == this || child.hasError_ || child.depth_ != 0 || child.flushed_ != 0 || !child.rootStarted())
+    {
+        return setError();
+    }
+    if (!addCommaIfNeeded())
+    {
+        return false;
+    }
+    if (!writeRawData(reinterpret_cast<const char *>(child.buffer_ + child.documentStart_),
+                      child.length_ - child.documentStart_))
+    {
+        return false;
+    }
+    return updateStateAfterValue();
+}
+
+JSONBUF_INLINE bool JsonBufWriter::finalize(const uint8_t *&output, size_t &length)
+{
+    if (hasError_ || depth_ != 0)
+    {
+        return false;
+    }
+
+    hashBuffered();
+
+    // When streaming, the handler receives the tail so it has seen the whole document
+    if (flushHandler_)
+    {
+        if (paginate_ && length_ != 0)
+        {
+            pageCount_++;
+        }
+        if (!flush())
+        {
+            return false;
+        }
+    }
+
+    output = buffer_;
+    length = length_;
+    return true;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::flush()
+{
+    if (hasError_)
+    {
+        return false;
+    }
+
+    hashBuffered();
+    if (length_ != 0 && flushHandler_ && !flushHandler_(flushContext_, buffer_, length_))
+    {
+        return setError();
+    }
+
+    flushed_ += length_;
+    length_ = 0;
+    hashed_ = 0;
+    updateLimit();
+    return true;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::ok() const
+{
+    return !hasError_;
+}
+
+JSONBUF_INLINE size_t JsonBufWriter::size() const
+{
+    return length_;
+}
+
+JSONBUF_INLINE size_t JsonBufWriter::flushedSize() const
+{
+    return flushed_;
+}
+
+JSONBUF_INLINE size_t JsonBufWriter::available() const
+{
+    return length_ + reserved_ < capacity_ ? capacity_ - length_ - reserved_ : 0;
+}
+
+JSONBUF_INLINE const uint8_t *JsonBufWriter::data() const
+{
+    return buffer_;
+}
+
+JSONBUF_INLINE char *JsonBufWriter::beginFormatted(size_t maxLength)
+{
+    if (!addCommaIfNeeded())
+    {
+        return nullptr;
+    }
+    if (!ensureCapacity(maxLength))
+    {
+        setError();
+        return nullptr;
+    }
+    return reinterpret_cast<char *>(buffer_ + length_);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::endFormatted(char *end)
+{
+    length_ = static_cast<size_t>(reinterpret_cast<uint8_t *>(end) - buffer_);
+    return updateStateAfterValue();
+}
+
+JSONBUF_INLINE bool JsonBufWriter::beginKey()
+{
+    if (skipDepth_ != 0)
+    {
+        return false; // Inside a container dropped in best-effort mode
+    }
+    if (hasError_ || !inObject())
+    {
+        return setError();
+    }
+
+    Frame &frame = currentFrame();
+    skipValue_ = false;
+    valueStart_ = flushed_ + length_;
+    valueFirst_ = frame.isFirst;
+
+    // Add comma before key if this isn't the first key-value pair
+    if (!frame.isFirst && !appendChar(','))
+    {
+        return false;
+    }
+    frame.isFirst = false;
+    return true;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::openContainer(char openChar, bool isObject)
+{
+    if (hasError_ || (depth_ == 0 && rootStarted()))
+    {
+        return setError(); // Only allow single root
+    }
+
+    if (!addCommaIfNeeded())
+    {
+        return refuseContainer();
+    }
+
+    // With closers reserved, the new container's closing byte is claimed up front
+    if (reserveClosers_ && !ensureCapacity(2))
+    {
+        setError();
+        return refuseContainer();
+    }
+
+    if (!appendChar(openChar))
+    {
+        return refuseContainer();
+    }
+
+    if (depth_ >= MAX_DEPTH)
+    {
+        return setError();
+    }
+
+    const uint32_t contentStart = static_cast<uint32_t>(length_);
+    stack_[depth_++] = Frame{isObject, true, false, contentStart, contentStart};
+    reserved_ += reserveClosers_ ? 1 : 0;
+    expectValue_ = false; // Root flag only
+    return true;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::closeContainer(char closeChar, bool isObject)
+{
+    if (skipDepth_ != 0)
+    {
+        skipDepth_--; // Closes a container dropped in best-effort mode
+        return false;
+    }
+    skipValue_ = false;
+
+    if (hasError_ || !inAnyContainer() || currentFrame().isObject != isObject)
+    {
+        return setError();
+    }
+
+    // The closing byte was held in reserve
+    reserved_ -= reserved_ != 0 ? 1 : 0;
+    if (!appendChar(closeChar))
+    {
+        return false;
+    }
+
+    depth_--;
+
+    // After closing, the parent no longer expects a value
+    return updateStateAfterValue();
+}
+
+JSONBUF_INLINE bool JsonBufWriter::writeString(const char *str)
+{
+    return writeStringWithLength(str, strlen(str));
+}
+
+JSONBUF_INLINE bool JsonBufWriter::writeStringWithLength(const char *str, size_t length)
+{
+    if (!appendChar('"'))
+    {
+        return false;
+    }
+
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(str);
+    const uint8_t *end = p + length;
+    const bool checkNonAscii = asciiOnly_ || utf8Mode_ != Utf8Mode::Passthrough;
+
+    while (p < end)
+    {
+        // Copy the longest run that needs no escaping in one go
+        size_t run = json_detail::scanPlain(p, static_cast<size_t>(end - p), checkNonAscii);
+        if (run != 0)
+        {
+            if (!appendString(reinterpret_cast<const char *>(p), run))
+            {
+                return false;
+            }
+            p += run;
+            continue;
+        }
+
+        size_t consumed = 1;
+        if (*p < 0x80 ? !escapeCharacter(*p) : !writeNonAscii(p, static_cast<size_t>(end - p), consumed))
+        {
+            return false;
+        }
+        p += consumed;
+    }
+
+    if (!appendChar('"'))
+    {
+        return false;
+    }
+
+    return updateStateAfterValue();
+}
+
+JSONBUF_INLINE bool JsonBufWriter::writeNonAscii(const uint8_t *data, size_t length, size_t &consumed)
+{
+    uint32_t codePoint;
+    if (json_detail::decodeUtf8(data, length, codePoint, consumed))
+    {
+        return asciiOnly_ ? writeUnicodeEscape(codePoint)
+                          : appendString(reinterpret_cast<const char *>(data), consumed);
+    }
+
+    if (utf8Mode_ == Utf8Mode::Reject)
+    {
+        return setError();
+    }
+
+    // Replace the ill-formed subpart with U+FFFD (also used for Passthrough in ASCII-only mode)
+    return asciiOnly_ ? appendString("\\ufffd", 6) : appendString("\xEF\xBF\xBD", 3);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::appendReencoded(const char *body, size_t length)
+{
+    // body is a validated string token: escapes are kept, non-ASCII bytes are re-encoded
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(body);
+    const uint8_t *end = p + length;
+    while (p < end)
+    {
+        size_t run = json_detail::scanPlain(p, static_cast<size_t>(end - p), true);
+        if (run == 0)
+        {
+            run = *p == '\\' ? (p[1] == 'u' ? 6 : 2) : 0;
+        }
+        if (run != 0)
+        {
+            if (!appendString(reinterpret_cast<const char *>(p), run))
+            {
+                return false;
+            }
+            p += run;
+            continue;
+        }
+
+        size_t consumed = 1;
+        if (!writeNonAscii(p, static_cast<size_t>(end - p), consumed))
+        {
+            return false;
+        }
+        p += consumed;
+    }
+    return true;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::writeUnicodeEscape(uint32_t codePoint)
+{
+    char escaped[12];
+    char *out = escaped;
+
+    // Code points above the BMP are written as a UTF-16 surrogate pair
+    uint32_t units[2];
+    size_t count = 0;
+    if (codePoint >= 0x10000)
+    {
+        codePoint -= 0x10000;
+        units[count++] = 0xD800 + (codePoint >> 10);
+        units[count++] = 0xDC00 + (codePoint & 0x3FF);
+    }
+    else
+    {
+        units[count++] = codePoint;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        *out++ = '\\';
+        *out++ = 'u';
+        out = json_detail::formatHexByte(static_cast<uint8_t>(units[i] >> 8), out);
+        out = json_detail::formatHexByte(static_cast<uint8_t>(units[i]), out);
+    }
+
+    return appendString(escaped, static_cast<size_t>(out - escaped));
+}
+
+JSONBUF_INLINE bool JsonBufWriter::writeInteger(uint64_t magnitude, bool negative)
+{
+    if (!addCommaIfNeeded())
+    {
+        return false;
+    }
+
+    // Format right-to-left into a scratch buffer, then copy with a single capacity check
+    char digits[21];
+    char *end = digits + sizeof(digits);
+    char *begin = formatUnsigned(magnitude, end);
+    if (negative)
+    {
+        *--begin = '-';
+    }
+
+    if (!writeRawData(begin, static_cast<size_t>(end - begin)))
+    {
+        return false;
+    }
+
+    return updateStateAfterValue();
+}
+
+JSONBUF_INLINE bool JsonBufWriter::writeFloat(double value)
+{
+    if (floatFormat_ == FloatFormat::ScaledInteger)
+    {
+        uint64_t magnitude;
+        bool negative;
+        return scaleFloat(value, magnitude, negative) ? writeInteger(magnitude, negative) : setError();
+    }
+    if (!addCommaIfNeeded())
+    {
+        return false;
+    }
+
+    if (formatFloat(value) < 0)
+    {
+        return false;
+    }
+
+    return updateStateAfterValue();
+}
+
+JSONBUF_INLINE bool JsonBufWriter::writeRawData(const char *data, size_t length)
+{
+    return appendString(data, length);
+}
+
+JSONBUF_INLINE bool JsonBufWriter::escapeCharacter(unsigned char c)
+{
+    switch (c)
+    {
+    case '"':
+        return appendString("\\\"", 2);
+    case '\\':
+        return appendString("\\\\", 2);
+    case '\b':
+        return appendString("\\b", 2);
+    case '\f':
+        return appendString("\\f", 2);
+    case '\n':
+        return appendString("\\n", 2);
+    case '\r':
+        return appendString("\\r", 2);
+    case '\t':
+        return appendString("\\t", 2);
+    default:
+        if (c < 0x20)
+        {
+            // Control character -> \u00XX
+            char unicode[6] = {'\\', 'u', '0', '0', 0, 0};
+            json_detail::formatHexByte(c, unicode + 4);
+            return appendString(unicode, 6);
+        }
+        return appendChar(static_cast<char>(c));
+    }
+}
+
+JSONBUF_INLINE bool JsonBufWriter::appendString(const char *str, size_t length)
+{
+    if (hasError_)
+    {
+        return setError();
+    }
+
+    while (!ensureCapacity(length))
+    {
+        // Larger than the whole buffer: stream it through in buffer-sized pieces
+        // A page must hold whole values, so pagination cannot split the string
+        if (hasError_ || !flushHandler_ || paginate_ || length_ + reserved_ >= capacity_)
+        {
+            return setError();
+        }
+        overflow_ = false; // Streamed, not dropped
+        size_t room = capacity_ - length_ - reserved_;
+        memcpy(buffer_ + length_, str, room);
+        length_ += room;
+        str += room;
+        length -= room;
+    }
+
+    memcpy(buffer_ + length_, str, length);
+    length_ += length;
+    return true;
+}
+
+JSONBUF_INLINE char *JsonBufWriter::formatUnsigned(uint64_t value, char *end)
+{
+    using json_detail::digitPairs;
+
+    // Peel off 8-digit blocks with 64-bit division so the inner loop runs on 32-bit words (cheap on MCUs)
+    while (value > 0xFFFFFFFFu)
+    {
+        uint32_t block = static_cast<uint32_t>(value % 100000000u);
+        value /= 100000000u;
+        for (int i = 0; i < 4; ++i)
+        {
+            const char *pair = digitPairs + (block % 100u) * 2;
+            block /= 100u;
+            *--end = pair[1];
+            *--end = pair[0];
+        }
+    }
+
+    uint32_t rest = static_cast<uint32_t>(value);
+    while (rest >= 100u)
+    {
+        const char *pair = digitPairs + (rest % 100u) * 2;
+        rest /= 100u;
+        *--end = pair[1];
+        *--end = pair[0];
+    }
+
+    if (rest >= 10u)
+    {
+        const char *pair = digitPairs + rest * 2;
+        *--end = pair[1];
+        *--end = pair[0];
+    }
+    else
+    {
+        *--end = static_cast<char>('0' + rest);
+    }
+
+    return end;
+}
+
+JSONBUF_INLINE int JsonBufWriter::formatFloat(double value)
+{
+    if (!buffer_)
+    {
+        setError();
+        return -1;
+    }
+
+    // "%.*f" takes the precision as an argument; avoids building a format string per value.
+    // Format into scratch first so a flush can happen before the bytes land in the buffer.
+    char scratch[40];
+    int result = snprintf(scratch, sizeof(scratch), "%.*f", static_cast<int>(floatPrecision_), value);
+    if (result <= 0)
+    {
+        setError();
+        return -1;
+    }
+
+    if (static_cast<size_t>(result) < sizeof(scratch))
+    {
+        return appendString(scratch, static_cast<size_t>(result)) ? result : -1;
+    }
+
+    // Very large magnitudes: format directly into the buffer (snprintf also needs room for '\0')
+    if (!ensureCapacity(static_cast<size_t>(result) + 1))
+    {
+        setError();
+        return -1;
+    }
+
+    snprintf(reinterpret_cast<char *>(buffer_ + length_), capacity_ - length_, "%.*f",
+             static_cast<int>(floatPrecision_), value);
+    length_ += static_cast<size_t>(result);
+    return result;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::scaleFloat(double value, uint64_t &magnitude, bool &negative) const
+{
+    const uint64_t scale = floatScale();
+    const double scaled = value * static_cast<double>(scale);
+    // Also rejects NaN; 2^63 keeps the result within int64 for readers
+    if (scale == 0 || !(scaled > -9223372036854775808.0 && scaled < 9223372036854775808.0))
+    {
+        return false;
+    }
+
+    // Round half away from zero
+    negative = scaled < 0;
+    magnitude = static_cast<uint64_t>((negative ? -scaled : scaled) + 0.5);
+    negative = negative && magnitude != 0;
+    return true;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::endRecord()
+{
+    if (!appendChar('\n'))
+    {
+        return false;
+    }
+    recordCount_++;
+    recordStart_ = documentStart_ = flushed_ + length_;
+    return true;
+}
+
+JSONBUF_INLINE void JsonBufWriter::rollbackRecord()
+{
+    // Only possible while the record's first byte is still in the buffer
+    if (recordStart_ < flushed_ || (depth_ == 0 && flushed_ + length_ == recordStart_))
+    {
+        return;
+    }
+    length_ = recordStart_ - flushed_;
+    documentStart_ = recordStart_;
+    depth_ = 0;
+    expectValue_ = false;
+    rolledBack_ = true;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::makeRoom(size_t additionalBytes)
+{
+    // Slow path of ensureCapacity(): the soft limit for checksum updates, or a full buffer
+    if (checksum_)
+    {
+        hashFinished();
+        if (length_ + additionalBytes + reserved_ <= capacity_)
+        {
+            return true;
+        }
+    }
+
+    // Only a flush handler can make space
+    if (flushHandler_ && !hasError_ && length_ != 0 && (paginate_ ? nextPage() : flush()) &&
+        length_ + additionalBytes + reserved_ <= capacity_)
+    {
+        return true;
+    }
+    overflow_ = bestEffort_; // Lets setError() drop the value instead
+    return false;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::nextPage()
+{
+    // Placeholders reserved before pagination was enabled hold fixed offsets
+    if (jsonLines_ || flushed_ != 0 || hashHold_ != SIZE_MAX)
+    {
+        return false;
+    }
+
+    // Cut the outermost array that holds a complete element, so nested arrays stay whole
+    // unless a single element of the outer array fills the page
+    int index = 0;
+    while (index < depth_ && (stack_[index].isObject || stack_[index].elementStart <= stack_[index].contentStart))
+    {
+        ++index;
+    }
+    if (index == depth_)
+    {
+        return false; // No complete element to cut after: the element is larger than a page
+    }
+    Frame &array = stack_[index];
+    const size_t boundary = array.elementStart;
+
+    // Park the unfinished element (without its separator) at the end of the buffer
+    const bool separator = length_ > boundary && buffer_[boundary] == ',';
+    const size_t carryStart = boundary + (separator ? 1 : 0);
+    const size_t carry = length_ - carryStart;
+    uint8_t *parked = buffer_ + capacity_ - carry;
+    memmove(parked, buffer_ + carryStart, carry);
+
+    // The reserve guarantees room for the closers between the page and the parked bytes
+    size_t pageLength = boundary;
+    for (int i = index; i >= 0; --i)
+    {
+        buffer_[pageLength++] = stack_[i].isObject ? '}' : ']';
+    }
+    if (checksum_)
+    {
+        checksum_->update(buffer_, pageLength);
+    }
+    if (!flushHandler_(flushContext_, buffer_, pageLength))
+    {
+        return setError();
+    }
+    pageCount_++;
+
+    // Continue after the envelope, which is still in place at the start of the buffer
+    memmove(buffer_ + array.contentStart, parked, carry);
+    for (uint8_t i = static_cast<uint8_t>(index + 1); i < depth_; ++i)
+    {
+        // Containers opened inside the unfinished element moved with it
+        stack_[i].contentStart = static_cast<uint32_t>(stack_[i].contentStart - carryStart + array.contentStart);
+        stack_[i].elementStart = static_cast<uint32_t>(stack_[i].elementStart - carryStart + array.contentStart);
+    }
+    if (valueStart_ >= boundary)
+    {
+        // The value being written is now part of the new page
+        valueFirst_ = valueFirst_ || valueStart_ <= carryStart;
+        valueStart_ = valueStart_ > carryStart ? valueStart_ - carryStart + array.contentStart : array.contentStart;
+    }
+    length_ = array.contentStart + carry;
+    array.elementStart = array.contentStart;
+    if (!separator && carry == 0)
+    {
+        array.isFirst = true; // Called while the separator was about to be written
+    }
+    return true;
+}
+
+JSONBUF_INLINE void JsonBufWriter::hashFinished()
+{
+    // Bytes before the current value are final, unless a placeholder or a record rollback
+    // may still rewrite them; pages are hashed as they are delivered
+    size_t end = paginate_ ? 0 : valueStart_;
+    end = end < hashHold_ ? end : hashHold_;
+    if (rollbackRecords_ && recordStart_ < end)
+    {
+        end = recordStart_;
+    }
+    end = end > flushed_ ? end - flushed_ : 0;
+    if (end > length_)
+    {
+        end = length_;
+    }
+
+    if (end > hashed_)
+    {
+        checksum_->update(buffer_ + hashed_, end - hashed_);
+        hashed_ = end;
+    }
+    updateLimit();
+}
+
+JSONBUF_INLINE void JsonBufWriter::hashBuffered()
+{
+    if (checksum_ && length_ > hashed_)
+    {
+        checksum_->update(buffer_ + hashed_, length_ - hashed_);
+        hashed_ = length_;
+    }
+}
+
+JSONBUF_INLINE void JsonBufWriter::updateLimit()
+{
+    limit_ = checksum_ && capacity_ - length_ > CHECKSUM_CHUNK ? length_ + CHECKSUM_CHUNK : capacity_;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::dropValue()
+{
+    if (valueStart_ < flushed_ || valueStart_ > flushed_ + length_)
+    {
+        return false; // Part of the value has already been flushed
+    }
+
+    length_ = valueStart_ - flushed_;
+    droppedCount_++;
+    if (inAnyContainer())
+    {
+        // A key cannot stay without its value: drop the pair and refuse a value still to come
+        Frame &frame = currentFrame();
+        frame.isFirst = valueFirst_;
+        skipValue_ = frame.isObject && !frame.expectValue;
+        frame.expectValue = false;
+    }
+    return true;
+}
+
+JSONBUF_INLINE bool JsonBufWriter::refuseContainer()
+{
+    // The contents and closing call of a dropped container are refused as well
+    if (!hasError_)
+    {
+        skipValue_ = false;
+        skipDepth_++;
+    }
+    return false;
+}
+
+JSONBUF_INLINE void JsonBufWriter::updateStateAfterValueIfArrayOrRoot()
+{
+    if (inAnyContainer())
+    {
+        if (!currentFrame().isObject)
+        {
+            currentFrame().expectValue = false; // Array element done
+        }
+    }
+    else
+    {
+        expectValue_ = false;
+    }
+}
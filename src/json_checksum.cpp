@@ -0,0 +1,231 @@
+#include "json_checksum.hpp"
+
+#include <string.h>
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace
+{
+    const uint32_t CRC32_POLYNOMIAL = 0xEDB88320u; // Reflected IEEE 802.3
+
+    const uint32_t PRIME32_1 = 0x9E3779B1u;
+    const uint32_t PRIME32_2 = 0x85EBCA77u;
+    const uint32_t PRIME32_3 = 0xC2B2AE3Du;
+    const uint32_t PRIME32_4 = 0x27D4EB2Fu;
+    const uint32_t PRIME32_5 = 0x165667B1u;
+
+    inline uint32_t rotateLeft(uint32_t value, unsigned bits)
+    {
+        return (value << bits) | (value >> (32 - bits));
+    }
+
+    inline uint32_t loadLittleEndian(const uint8_t *data)
+    {
+        return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+               (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+    }
+
+    inline uint32_t xxRound(uint32_t lane, uint32_t input)
+    {
+        lane += input * PRIME32_2;
+        return rotateLeft(lane, 13) * PRIME32_1;
+    }
+
+#if !defined(__ARM_FEATURE_CRC32) && JSON_BUF_WRITER_CRC32_SLICING == 8
+    /** @brief Slicing-by-8 tables: table[k][b] is the CRC of byte b followed by k zero bytes. */
+    struct Crc32Tables
+    {
+        uint32_t table[8][256];
+
+        Crc32Tables()
+        {
+            for (uint32_t b = 0; b < 256; ++b)
+            {
+                uint32_t crc = b;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc >> 1) ^ (CRC32_POLYNOMIAL & (0u - (crc & 1u)));
+                }
+                table[0][b] = crc;
+            }
+            for (uint32_t b = 0; b < 256; ++b)
+            {
+                for (int k = 1; k < 8; ++k)
+                {
+                    table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+                }
+            }
+        }
+    };
+
+    const Crc32Tables &crc32Tables()
+    {
+        static const Crc32Tables tables;
+        return tables;
+    }
+#elif !defined(__ARM_FEATURE_CRC32)
+    // CRC of each nibble value: 64 bytes of flash instead of 8 KB of tables
+    const uint32_t CRC32_NIBBLES[16] = {
+        0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu, 0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+        0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu, 0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu};
+#endif
+}
+
+JsonChecksum::JsonChecksum(uint8_t algorithms, uint32_t seed)
+    : algorithms_(algorithms), seed_(seed)
+{
+    reset();
+}
+
+void JsonChecksum::reset()
+{
+    crc_ = 0xFFFFFFFFu;
+    lanes_[0] = seed_ + PRIME32_1 + PRIME32_2;
+    lanes_[1] = seed_ + PRIME32_2;
+    lanes_[2] = seed_;
+    lanes_[3] = seed_ - PRIME32_1;
+    pendingLength_ = 0;
+    length_ = 0;
+}
+
+void JsonChecksum::update(const uint8_t *data, size_t length)
+{
+    if (algorithms_ & CRC32)
+    {
+        crc_ = updateCrc(crc_, data, length);
+    }
+    if (algorithms_ & XXHASH32)
+    {
+        updateXxHash(data, length);
+    }
+    length_ += length;
+}
+
+uint32_t JsonChecksum::crc32() const
+{
+    return ~crc_;
+}
+
+uint32_t JsonChecksum::xxhash32() const
+{
+    uint32_t hash;
+    if (length_ >= sizeof(pending_))
+    {
+        hash = rotateLeft(lanes_[0], 1) + rotateLeft(lanes_[1], 7) + rotateLeft(lanes_[2], 12) +
+               rotateLeft(lanes_[3], 18);
+    }
+    else
+    {
+        hash = seed_ + PRIME32_5;
+    }
+    hash += static_cast<uint32_t>(length_);
+
+    // Tail: the bytes that did not complete a 16-byte stripe
+    const uint8_t *p = pending_;
+    const uint8_t *end = pending_ + pendingLength_;
+    for (; p + 4 <= end; p += 4)
+    {
+        hash += loadLittleEndian(p) * PRIME32_3;
+        hash = rotateLeft(hash, 17) * PRIME32_4;
+    }
+    for (; p < end; ++p)
+    {
+        hash += *p * PRIME32_5;
+        hash = rotateLeft(hash, 11) * PRIME32_1;
+    }
+
+    hash ^= hash >> 15;
+    hash *= PRIME32_2;
+    hash ^= hash >> 13;
+    hash *= PRIME32_3;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+size_t JsonChecksum::length() const
+{
+    return length_;
+}
+
+uint32_t JsonChecksum::updateCrc(uint32_t crc, const uint8_t *data, size_t length)
+{
+#if defined(__ARM_FEATURE_CRC32)
+    for (; length >= 8; data += 8, length -= 8)
+    {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc = __crc32d(crc, word);
+    }
+    for (; length != 0; ++data, --length)
+    {
+        crc = __crc32b(crc, *data);
+    }
+#elif JSON_BUF_WRITER_CRC32_SLICING == 8
+    const Crc32Tables &t = crc32Tables();
+    for (; length >= 8; data += 8, length -= 8)
+    {
+        // Eight table lookups per 8 bytes, independent of each other
+        const uint32_t low = loadLittleEndian(data) ^ crc;
+        const uint32_t high = loadLittleEndian(data + 4);
+        crc = t.table[7][low & 0xFF] ^ t.table[6][(low >> 8) & 0xFF] ^ t.table[5][(low >> 16) & 0xFF] ^
+              t.table[4][low >> 24] ^ t.table[3][high & 0xFF] ^ t.table[2][(high >> 8) & 0xFF] ^
+              t.table[1][(high >> 16) & 0xFF] ^ t.table[0][high >> 24];
+    }
+    for (; length != 0; ++data, --length)
+    {
+        crc = (crc >> 8) ^ t.table[0][(crc ^ *data) & 0xFF];
+    }
+#else
+    for (; length != 0; ++data, --length)
+    {
+        crc ^= *data;
+        crc = (crc >> 4) ^ CRC32_NIBBLES[crc & 0x0F];
+        crc = (crc >> 4) ^ CRC32_NIBBLES[crc & 0x0F];
+    }
+#endif
+    return crc;
+}
+
+void JsonChecksum::updateXxHash(const uint8_t *data, size_t length)
+{
+    // Complete a stripe started by an earlier update
+    if (pendingLength_ != 0)
+    {
+        size_t take = sizeof(pending_) - pendingLength_;
+        if (take > length)
+        {
+            take = length;
+        }
+        memcpy(pending_ + pendingLength_, data, take);
+        pendingLength_ = static_cast<uint8_t>(pendingLength_ + take);
+        data += take;
+        length -= take;
+        if (pendingLength_ < sizeof(pending_))
+        {
+            return;
+        }
+        for (int i = 0; i < 4; ++i)
+        {
+            lanes_[i] = xxRound(lanes_[i], loadLittleEndian(pending_ + 4 * i));
+        }
+        pendingLength_ = 0;
+    }
+
+    uint32_t v0 = lanes_[0], v1 = lanes_[1], v2 = lanes_[2], v3 = lanes_[3];
+    for (; length >= 16; data += 16, length -= 16)
+    {
+        v0 = xxRound(v0, loadLittleEndian(data));
+        v1 = xxRound(v1, loadLittleEndian(data + 4));
+        v2 = xxRound(v2, loadLittleEndian(data + 8));
+        v3 = xxRound(v3, loadLittleEndian(data + 12));
+    }
+    lanes_[0] = v0;
+    lanes_[1] = v1;
+    lanes_[2] = v2;
+    lanes_[3] = v3;
+
+    memcpy(pending_, data, length);
+    pendingLength_ = static_cast<uint8_t>(length);
+}
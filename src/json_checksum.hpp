@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file
+ * @brief Streaming CRC-32 and xxHash32 over the bytes a writer produces.
+ *
+ * @details
+ * Attach a `JsonChecksum` with JsonBufWriter::setChecksum() and the writer feeds it the
+ * document while writing: finished parts of the buffer are hashed every
+ * JsonBufWriter::CHECKSUM_CHUNK bytes, while they are still in cache, and the rest when
+ * the bytes leave the writer (flush() or finalize()). The checksum is complete as soon as
+ * finalize() returns, without a second pass over the buffer.
+ *
+ * CRC-32 is the IEEE 802.3 / zlib polynomial. It uses the ARMv8 CRC32 instructions when
+ * the target has them (`__ARM_FEATURE_CRC32`), slicing-by-8 tables elsewhere, and a
+ * 16-entry table on Arduino targets, where 8 KB of tables would not be worth the RAM.
+ * Override the table choice with `JSON_BUF_WRITER_CRC32_SLICING` (1 or 8).
+ * xxHash32 is the 32-bit variant of xxHash, cheap on MCUs and suited to deduplication.
+ *
+ * The class can also be used on its own for any byte stream.
+ *
+ * ### Example
+ * @code{.cpp}
+ * JsonChecksum checksum(JsonChecksum::CRC32);
+ * jw.setChecksum(&checksum);
+ * // ... write the document ...
+ * jw.finalize(out, len);
+ * uint32_t crc = checksum.crc32(); // same as crc32(out, len)
+ * @endcode
+ */
+
+#if !defined(JSON_BUF_WRITER_CRC32_SLICING)
+#if defined(ARDUINO)
+#define JSON_BUF_WRITER_CRC32_SLICING 1
+#else
+#define JSON_BUF_WRITER_CRC32_SLICING 8
+#endif
+#endif
+
+/**
+ * @class JsonChecksum
+ * @brief Incremental CRC-32 and/or xxHash32.
+ */
+class JsonChecksum
+{
+public:
+    /** @brief Algorithms to compute; combine with `|`. */
+    enum Algorithm : uint8_t
+    {
+        CRC32 = 0x01,    ///< CRC-32 (IEEE, as zlib's crc32()).
+        XXHASH32 = 0x02  ///< xxHash32 with the configured seed.
+    };
+
+    /**
+     * @brief Create an empty checksum.
+     * @param algorithms Bitwise OR of #Algorithm values.
+     * @param seed xxHash32 seed.
+     */
+    explicit JsonChecksum(uint8_t algorithms = CRC32, uint32_t seed = 0);
+
+    /** @brief Start over with no bytes hashed (keeps algorithms and seed). */
+    void reset();
+
+    /** @brief Hash the next @p length bytes of the stream. */
+    void update(const uint8_t *data, size_t length);
+
+    /** @brief CRC-32 of the bytes hashed so far. */
+    uint32_t crc32() const;
+
+    /** @brief xxHash32 of the bytes hashed so far. */
+    uint32_t xxhash32() const;
+
+    /** @brief Number of bytes hashed since reset(). */
+    size_t length() const;
+
+private:
+    uint8_t algorithms_;    ///< Enabled #Algorithm bits.
+    uint32_t seed_;         ///< xxHash32 seed.
+    uint32_t crc_;          ///< Running CRC register (pre-inverted).
+    uint32_t lanes_[4];     ///< xxHash32 accumulators.
+    uint8_t pending_[16];   ///< xxHash32 bytes waiting for a full stripe.
+    uint8_t pendingLength_; ///< Valid bytes in pending_.
+    size_t length_;         ///< Bytes hashed since reset().
+
+    static uint32_t updateCrc(uint32_t crc, const uint8_t *data, size_t length);
+    void updateXxHash(const uint8_t *data, size_t length);
+};
@@ -0,0 +1,73 @@
+#include "json_compressor.hpp"
+
+JsonCompressedOutput::JsonCompressedOutput(uint8_t *buf, size_t capacity)
+    : buffer_(buf), capacity_(capacity), length_(0), flushed_(0), hasError_(false),
+      flushHandler_(nullptr), flushContext_(nullptr)
+{
+}
+
+void JsonCompressedOutput::reset(uint8_t *buf, size_t capacity)
+{
+    buffer_ = buf;
+    capacity_ = capacity;
+    length_ = 0;
+    flushed_ = 0;
+    hasError_ = false;
+}
+
+void JsonCompressedOutput::setFlushHandler(JsonBufWriter::FlushHandler handler, void *context)
+{
+    flushHandler_ = handler;
+    flushContext_ = context;
+}
+
+bool JsonCompressedOutput::flush()
+{
+    if (hasError_)
+    {
+        return false;
+    }
+
+    if (length_ != 0 && flushHandler_)
+    {
+        if (!flushHandler_(flushContext_, buffer_, length_))
+        {
+            hasError_ = true;
+            return false;
+        }
+        flushed_ += length_;
+        length_ = 0;
+    }
+    return true;
+}
+
+bool JsonCompressedOutput::makeRoom()
+{
+    // The buffer is full: only a handler can empty it
+    if (!flushHandler_ || capacity_ == 0 || !flush())
+    {
+        hasError_ = true;
+        return false;
+    }
+    return true;
+}
+
+bool JsonCompressedOutput::ok() const
+{
+    return !hasError_;
+}
+
+const uint8_t *JsonCompressedOutput::data() const
+{
+    return buffer_;
+}
+
+size_t JsonCompressedOutput::size() const
+{
+    return length_;
+}
+
+size_t JsonCompressedOutput::totalSize() const
+{
+    return flushed_ + length_;
+}
@@ -0,0 +1,626 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "json_buffer_writer.hpp"
+
+/**
+ * @file
+ * @brief Streaming compression stage between `JsonBufWriter` and its destination.
+ *
+ * @details
+ * A `JsonCompressionSink` installs itself as the writer's flush handler. The writer's
+ * buffer becomes a small staging area: each time it fills up, its bytes are fed to an
+ * encoder that appends compressed output to a destination buffer. The uncompressed
+ * document never has to exist in full.
+ *
+ * Two encoders are provided:
+ * - `JsonHeatshrinkEncoder`: LZSS in the heatshrink bit layout (flag bit, 8-bit
+ *   literal or W-bit offset + L-bit count). A few hundred bytes of state, suitable for MCUs.
+ * - `JsonDeflateEncoder`: raw DEFLATE (RFC 1951) with fixed Huffman codes and
+ *   hash-chain LZ77 matching. Decodable by any inflate implementation
+ *   (e.g. zlib with `windowBits = -15`). Intended for hosts.
+ *
+ * ### Example
+ * @code{.cpp}
+ * static uint8_t staging[128];
+ * static uint8_t packet[1024];
+ * static JsonCompressionSink<JsonHeatshrinkEncoder<8, 4>> sink(packet, sizeof(packet));
+ *
+ * JsonBufWriter jw(staging, sizeof(staging));
+ * sink.attach(jw);
+ * // ... write the document ...
+ * if (sink.finish(jw)) {
+ *   // send sink.output().data()[0..sink.output().size()-1]
+ * }
+ * @endcode
+ */
+
+/**
+ * @class JsonCompressedOutput
+ * @brief Byte sink for encoders: a caller-provided buffer with optional overflow handler.
+ */
+class JsonCompressedOutput
+{
+public:
+    /**
+     * @brief Bind the output to a destination buffer.
+     * @param buf Destination for compressed bytes.
+     * @param capacity Size of @p buf in bytes.
+     */
+    JsonCompressedOutput(uint8_t *buf, size_t capacity);
+
+    /** @brief Start over in a (possibly new) destination buffer; clears the error flag. */
+    void reset(uint8_t *buf, size_t capacity);
+
+    /**
+     * @brief Pass full destination buffers to @p handler instead of failing.
+     * @param handler Receives compressed bytes; `nullptr` disables streaming.
+     * @param context Opaque pointer forwarded to @p handler.
+     */
+    void setFlushHandler(JsonBufWriter::FlushHandler handler, void *context);
+
+    /** @brief Append one byte. @retval false Destination full (and no handler) or handler failed. */
+    bool put(uint8_t byte)
+    {
+        if (length_ == capacity_ && !makeRoom())
+        {
+            return false;
+        }
+        buffer_[length_++] = byte;
+        return true;
+    }
+
+    /**
+     * @brief Hand the pending bytes to the handler.
+     * @retval true Success, or no handler is set (the bytes stay in the buffer).
+     * @retval false The handler failed, or an earlier byte could not be stored.
+     */
+    bool flush();
+
+    /** @brief Whether every byte so far was stored. */
+    bool ok() const;
+
+    /** @brief Start of the destination buffer. */
+    const uint8_t *data() const;
+
+    /** @brief Bytes currently in the destination buffer. */
+    size_t size() const;
+
+    /** @brief Total compressed bytes produced (flushed plus buffered). */
+    size_t totalSize() const;
+
+private:
+    uint8_t *buffer_;                         ///< Destination buffer.
+    size_t capacity_;                         ///< Size of the destination buffer.
+    size_t length_;                           ///< Bytes currently buffered.
+    size_t flushed_;                          ///< Bytes already passed to the handler.
+    bool hasError_;                           ///< Set when a byte could not be stored.
+    JsonBufWriter::FlushHandler flushHandler_; ///< Optional overflow handler.
+    void *flushContext_;                      ///< Opaque pointer for #flushHandler_.
+
+    bool makeRoom();
+};
+
+/**
+ * @class JsonHeatshrinkEncoder
+ * @brief Streaming LZSS encoder using the heatshrink bit layout.
+ * @tparam WindowBits log2 of the history window (4..15).
+ * @tparam LookaheadBits log2 of the longest match (3..WindowBits-1).
+ *
+ * Each token is a flag bit followed by either an 8-bit literal (flag 1) or a back
+ * reference (flag 0) of `WindowBits` bits holding offset-1 and `LookaheadBits` bits
+ * holding length-1. Bits are packed MSB first; the last byte is zero-padded.
+ * Matching is a brute-force window scan, so state is only `2 << WindowBits` bytes.
+ */
+template <uint8_t WindowBits = 8, uint8_t LookaheadBits = 4>
+class JsonHeatshrinkEncoder
+{
+    static_assert(WindowBits >= 4 && WindowBits <= 15, "WindowBits out of range");
+    static_assert(LookaheadBits >= 3 && LookaheadBits < WindowBits, "LookaheadBits out of range");
+
+public:
+    JsonHeatshrinkEncoder() { reset(); }
+
+    /** @brief Discard all state and start a new stream. */
+    void reset()
+    {
+        position_ = 0;
+        fill_ = 0;
+        bitBuffer_ = 0;
+        bitCount_ = 0;
+    }
+
+    /**
+     * @brief Compress more input.
+     * @retval false @p out rejected a byte.
+     */
+    bool write(const uint8_t *data, size_t length, JsonCompressedOutput &out)
+    {
+        while (length != 0)
+        {
+            if (fill_ == BUFFER_SIZE)
+            {
+                slide();
+            }
+            size_t chunk = BUFFER_SIZE - fill_;
+            chunk = chunk < length ? chunk : length;
+            memcpy(buffer_ + fill_, data, chunk);
+            fill_ += chunk;
+            data += chunk;
+            length -= chunk;
+
+            if (!encode(false, out))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Compress the remaining input and pad the final byte.
+     * @retval false @p out rejected a byte.
+     */
+    bool finish(JsonCompressedOutput &out)
+    {
+        if (!encode(true, out))
+        {
+            return false;
+        }
+        if (bitCount_ != 0 && !out.put(static_cast<uint8_t>(bitBuffer_ << (8 - bitCount_))))
+        {
+            return false;
+        }
+        bitBuffer_ = 0;
+        bitCount_ = 0;
+        return true;
+    }
+
+private:
+    static constexpr size_t WINDOW = size_t(1) << WindowBits;
+    static constexpr size_t MAX_MATCH = size_t(1) << LookaheadBits;
+    static constexpr size_t BUFFER_SIZE = 2 * WINDOW;
+    // Back references no longer than this cost at least as many bits as literals
+    static constexpr size_t BREAK_EVEN = (1 + WindowBits + LookaheadBits) / 8;
+
+    uint8_t buffer_[BUFFER_SIZE]; ///< History [0, position_) followed by pending input.
+    size_t position_;             ///< Next byte to encode.
+    size_t fill_;                 ///< End of buffered input.
+    uint32_t bitBuffer_;          ///< Pending output bits (right-aligned).
+    uint8_t bitCount_;            ///< Number of pending output bits.
+
+    void slide()
+    {
+        // Keep one window of history; pending input is always shorter than a window
+        size_t shift = position_ > WINDOW ? position_ - WINDOW : 0;
+        memmove(buffer_, buffer_ + shift, fill_ - shift);
+        position_ -= shift;
+        fill_ -= shift;
+    }
+
+    bool putBits(uint32_t value, uint8_t count, JsonCompressedOutput &out)
+    {
+        bitBuffer_ = (bitBuffer_ << count) | value;
+        bitCount_ += count;
+        while (bitCount_ >= 8)
+        {
+            bitCount_ -= 8;
+            if (!out.put(static_cast<uint8_t>(bitBuffer_ >> bitCount_)))
+            {
+                return false;
+            }
+        }
+        bitBuffer_ &= (1u << bitCount_) - 1u;
+        return true;
+    }
+
+    bool encode(bool final, JsonCompressedOutput &out)
+    {
+        // Without more input a longer match might still appear, so keep MAX_MATCH bytes back
+        while (fill_ - position_ >= (final ? 1 : MAX_MATCH))
+        {
+            size_t available = fill_ - position_;
+            size_t limit = available < MAX_MATCH ? available : MAX_MATCH;
+            size_t start = position_ > WINDOW ? position_ - WINDOW : 0;
+            const uint8_t *current = buffer_ + position_;
+
+            size_t bestLength = 0;
+            size_t bestOffset = 0;
+            for (size_t candidate = position_; candidate-- > start;)
+            {
+                const uint8_t *history = buffer_ + candidate;
+                if (history[0] != current[0] || history[bestLength] != current[bestLength])
+                {
+                    continue;
+                }
+                size_t length = 1;
+                while (length < limit && history[length] == current[length])
+                {
+                    ++length;
+                }
+                if (length > bestLength)
+                {
+                    bestLength = length;
+                    bestOffset = position_ - candidate;
+                    if (length == limit)
+                    {
+                        break;
+                    }
+                }
+            }
+
+            bool ok;
+            if (bestLength > BREAK_EVEN)
+            {
+                ok = putBits(0, 1, out) &&
+                     putBits(static_cast<uint32_t>(bestOffset - 1), WindowBits, out) &&
+                     putBits(static_cast<uint32_t>(bestLength - 1), LookaheadBits, out);
+                position_ += bestLength;
+            }
+            else
+            {
+                ok = putBits(0x100u | current[0], 9, out);
+                position_ += 1;
+            }
+            if (!ok)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @class JsonDeflateEncoder
+ * @brief Streaming raw DEFLATE encoder (fixed Huffman codes, hash-chain LZ77).
+ * @tparam WindowBits log2 of the history window (9..15); 15 matches zlib's default window.
+ *
+ * The stream is a single fixed-Huffman block followed by an empty final block, so it can be
+ * produced incrementally without buffering symbols. State is `2 << WindowBits` bytes of
+ * history plus two 16-bit tables (about 6x the window size in total).
+ */
+template <uint8_t WindowBits = 12>
+class JsonDeflateEncoder
+{
+    static_assert(WindowBits >= 9 && WindowBits <= 15, "WindowBits out of range");
+
+public:
+    JsonDeflateEncoder() { reset(); }
+
+    /** @brief Discard all state and start a new stream. */
+    void reset()
+    {
+        position_ = 0;
+        fill_ = 0;
+        bitBuffer_ = 0;
+        bitCount_ = 0;
+        started_ = false;
+        for (size_t i = 0; i < HASH_SIZE; ++i)
+        {
+            head_[i] = NONE;
+        }
+        for (size_t i = 0; i < WINDOW; ++i)
+        {
+            prev_[i] = NONE;
+        }
+    }
+
+    /**
+     * @brief Compress more input.
+     * @retval false @p out rejected a byte.
+     */
+    bool write(const uint8_t *data, size_t length, JsonCompressedOutput &out)
+    {
+        if (!start(out))
+        {
+            return false;
+        }
+        while (length != 0)
+        {
+            if (fill_ == BUFFER_SIZE)
+            {
+                slide();
+            }
+            size_t chunk = BUFFER_SIZE - fill_;
+            chunk = chunk < length ? chunk : length;
+            memcpy(buffer_ + fill_, data, chunk);
+            fill_ += chunk;
+            data += chunk;
+            length -= chunk;
+
+            if (!encode(false, out))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Compress the remaining input and terminate the stream.
+     * @retval false @p out rejected a byte.
+     */
+    bool finish(JsonCompressedOutput &out)
+    {
+        // End the open block, then an empty final block (BFINAL=1, fixed codes)
+        if (!start(out) || !encode(true, out) || !putSymbol(256, out) ||
+            !putBits(1, 1, out) || !putBits(1, 2, out) || !putSymbol(256, out))
+        {
+            return false;
+        }
+        if (bitCount_ != 0 && !out.put(static_cast<uint8_t>(bitBuffer_)))
+        {
+            return false;
+        }
+        bitBuffer_ = 0;
+        bitCount_ = 0;
+        return true;
+    }
+
+private:
+    static constexpr size_t WINDOW = size_t(1) << WindowBits;
+    static constexpr size_t BUFFER_SIZE = 2 * WINDOW;
+    static constexpr size_t MIN_MATCH = 3;
+    static constexpr size_t MAX_MATCH = 258;
+    static constexpr size_t HASH_BITS = WindowBits < 12 ? WindowBits : 12;
+    static constexpr size_t HASH_SIZE = size_t(1) << HASH_BITS;
+    static constexpr uint16_t NONE = 0xFFFF;
+    static constexpr int MAX_CHAIN = 32;
+
+    uint8_t buffer_[BUFFER_SIZE]; ///< History [0, position_) followed by pending input.
+    uint16_t head_[HASH_SIZE];    ///< Most recent position per 3-byte hash.
+    uint16_t prev_[WINDOW];       ///< Previous position with the same hash, by position % WINDOW.
+    size_t position_;             ///< Next byte to encode.
+    size_t fill_;                 ///< End of buffered input.
+    uint32_t bitBuffer_;          ///< Pending output bits (LSB first).
+    uint8_t bitCount_;            ///< Number of pending output bits.
+    bool started_;                ///< Block header written.
+
+    static size_t hash(const uint8_t *p)
+    {
+        uint32_t h = (uint32_t(p[0]) << 16) | (uint32_t(p[1]) << 8) | p[2];
+        return (h * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    bool start(JsonCompressedOutput &out)
+    {
+        if (started_)
+        {
+            return true;
+        }
+        started_ = true;
+        return putBits(0, 1, out) && putBits(1, 2, out); // BFINAL=0, BTYPE=01 (fixed)
+    }
+
+    void slide()
+    {
+        // Drop exactly one window so prev_ indexing (position % WINDOW) stays valid;
+        // positions are rebased and entries that fall out of the buffer are cleared
+        if (position_ < WINDOW)
+        {
+            return;
+        }
+        const size_t shift = WINDOW;
+        memmove(buffer_, buffer_ + shift, fill_ - shift);
+        position_ -= shift;
+        fill_ -= shift;
+        for (size_t i = 0; i < HASH_SIZE; ++i)
+        {
+            head_[i] = head_[i] != NONE && head_[i] >= shift ? static_cast<uint16_t>(head_[i] - shift) : NONE;
+        }
+        for (size_t i = 0; i < WINDOW; ++i)
+        {
+            prev_[i] = prev_[i] != NONE && prev_[i] >= shift ? static_cast<uint16_t>(prev_[i] - shift) : NONE;
+        }
+    }
+
+    void insert(size_t pos)
+    {
+        size_t h = hash(buffer_ + pos);
+        prev_[pos & (WINDOW - 1)] = head_[h];
+        head_[h] = static_cast<uint16_t>(pos);
+    }
+
+    bool putBits(uint32_t value, uint8_t count, JsonCompressedOutput &out)
+    {
+        bitBuffer_ |= value << bitCount_;
+        bitCount_ += count;
+        while (bitCount_ >= 8)
+        {
+            if (!out.put(static_cast<uint8_t>(bitBuffer_)))
+            {
+                return false;
+            }
+            bitBuffer_ >>= 8;
+            bitCount_ -= 8;
+        }
+        return true;
+    }
+
+    // Huffman codes are sent most significant bit first, i.e. reversed in the LSB-first stream
+    bool putCode(uint32_t code, uint8_t length, JsonCompressedOutput &out)
+    {
+        uint32_t reversed = 0;
+        for (uint8_t i = 0; i < length; ++i)
+        {
+            reversed = (reversed << 1) | ((code >> i) & 1u);
+        }
+        return putBits(reversed, length, out);
+    }
+
+    bool putSymbol(uint32_t symbol, JsonCompressedOutput &out)
+    {
+        if (symbol < 144)
+        {
+            return putCode(0x30 + symbol, 8, out);
+        }
+        if (symbol < 256)
+        {
+            return putCode(0x190 + (symbol - 144), 9, out);
+        }
+        if (symbol < 280)
+        {
+            return putCode(symbol - 256, 7, out);
+        }
+        return putCode(0xC0 + (symbol - 280), 8, out);
+    }
+
+    bool putMatch(size_t length, size_t distance, JsonCompressedOutput &out)
+    {
+        static const uint16_t lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+                                                31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const uint8_t lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                                2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const uint16_t distanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                                  193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                                                  6145, 8193, 12289, 16385, 24577};
+        static const uint8_t distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                                  6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+        size_t l = 28;
+        while (lengthBase[l] > length)
+        {
+            --l;
+        }
+        size_t d = 29;
+        while (distanceBase[d] > distance)
+        {
+            --d;
+        }
+
+        return putSymbol(static_cast<uint32_t>(257 + l), out) &&
+               putBits(static_cast<uint32_t>(length - lengthBase[l]), lengthExtra[l], out) &&
+               putCode(static_cast<uint32_t>(d), 5, out) &&
+               putBits(static_cast<uint32_t>(distance - distanceBase[d]), distanceExtra[d], out);
+    }
+
+    bool encode(bool final, JsonCompressedOutput &out)
+    {
+        // Keep MAX_MATCH bytes of lookahead until the input is complete
+        while (fill_ - position_ >= (final ? 1 : MAX_MATCH))
+        {
+            size_t available = fill_ - position_;
+            size_t limit = available < MAX_MATCH ? available : MAX_MATCH;
+            size_t bestLength = 0;
+            size_t bestDistance = 0;
+
+            if (available >= MIN_MATCH)
+            {
+                const uint8_t *current = buffer_ + position_;
+                uint16_t candidate = head_[hash(current)];
+                for (int chain = 0; chain < MAX_CHAIN && candidate != NONE; ++chain)
+                {
+                    size_t distance = position_ - candidate;
+                    if (candidate >= position_ || distance > WINDOW - 1)
+                    {
+                        break;
+                    }
+                    const uint8_t *history = buffer_ + candidate;
+                    if (history[bestLength] == current[bestLength] && history[0] == current[0])
+                    {
+                        size_t length = 0;
+                        while (length < limit && history[length] == current[length])
+                        {
+                            ++length;
+                        }
+                        if (length > bestLength)
+                        {
+                            bestLength = length;
+                            bestDistance = distance;
+                            if (length == limit)
+                            {
+                                break;
+                            }
+                        }
+                    }
+                    candidate = prev_[candidate & (WINDOW - 1)];
+                }
+            }
+
+            if (bestLength >= MIN_MATCH)
+            {
+                if (!putMatch(bestLength, bestDistance, out))
+                {
+                    return false;
+                }
+                for (size_t i = 0; i < bestLength; ++i, ++position_)
+                {
+                    if (fill_ - position_ >= MIN_MATCH)
+                    {
+                        insert(position_);
+                    }
+                }
+            }
+            else
+            {
+                if (!putSymbol(buffer_[position_], out))
+                {
+                    return false;
+                }
+                if (available >= MIN_MATCH)
+                {
+                    insert(position_);
+                }
+                ++position_;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @class JsonCompressionSink
+ * @brief Flush handler that compresses writer output into a destination buffer.
+ * @tparam Encoder `JsonHeatshrinkEncoder` or `JsonDeflateEncoder` (or any type with
+ *         `reset()`, `write(data, length, out)` and `finish(out)`).
+ */
+template <typename Encoder>
+class JsonCompressionSink
+{
+public:
+    /**
+     * @brief Create a sink writing compressed bytes to @p dest.
+     * @param dest Destination buffer for compressed output.
+     * @param capacity Size of @p dest in bytes.
+     */
+    JsonCompressionSink(uint8_t *dest, size_t capacity) : output_(dest, capacity) {}
+
+    /** @brief Start a new compressed stream in @p writer (installs the flush handler). */
+    void attach(JsonBufWriter &writer)
+    {
+        encoder_.reset();
+        writer.setFlushHandler(&JsonCompressionSink::onFlush, this);
+    }
+
+    /**
+     * @brief Finalize the document and terminate the compressed stream.
+     * @retval true The writer finalized and all compressed bytes were produced.
+     */
+    bool finish(JsonBufWriter &writer)
+    {
+        const uint8_t *ignored;
+        size_t length;
+        return writer.finalize(ignored, length) && encoder_.finish(output_) && output_.ok();
+    }
+
+    /** @brief Compressed output (and its optional downstream handler). */
+    JsonCompressedOutput &output() { return output_; }
+
+    /** @brief The encoder state. */
+    Encoder &encoder() { return encoder_; }
+
+    /** @brief `JsonBufWriter::FlushHandler` entry point; @p context is the sink. */
+    static bool onFlush(void *context, const uint8_t *data, size_t length)
+    {
+        JsonCompressionSink *sink = static_cast<JsonCompressionSink *>(context);
+        return sink->encoder_.write(data, length, sink->output_);
+    }
+
+private:
+    Encoder encoder_;              ///< Compression state.
+    JsonCompressedOutput output_; ///< Destination for compressed bytes.
+};
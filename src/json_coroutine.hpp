@@ -0,0 +1,235 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "json_buffer_writer.hpp"
+
+/**
+ * @file
+ * @brief C++20 coroutine front-end that produces a document as a sequence of chunks.
+ *
+ * @details
+ * Serialization code is written as a coroutine returning `JsonChunkGenerator` whose first
+ * parameter is the `JsonBufWriter` to fill. At convenient points (typically after each
+ * element of a large array) the body executes `co_yield JsonRoom{n}`: when fewer than
+ * `n` bytes are free, the coroutine suspends and the buffered bytes become the current
+ * chunk. Once the consumer calls next() again, the body resumes into the same buffer
+ * from its beginning. The bytes left when the body returns form the last chunk.
+ *
+ * This lets one thread interleave many large responses fairly with one fixed buffer per
+ * response. `n` must cover the largest output written between two checkpoints;
+ * otherwise the writer reports a capacity error and the generator stops.
+ *
+ * Only available when the compiler supports coroutines (`__cpp_impl_coroutine`). The
+ * coroutine frame is allocated by the compiler with `operator new`, so this API is
+ * intended for hosts rather than heap-less MCU builds. Do not install a flush handler
+ * on the writer; the generator consumes the buffer itself.
+ *
+ * ### Example
+ * @code{.cpp}
+ * JsonChunkGenerator writeRows(JsonBufWriter &jw, const Row *rows, size_t count) {
+ *   jw.beginArray();
+ *   for (size_t i = 0; i < count; ++i) {
+ *     writeRow(jw, rows[i]);
+ *     co_yield JsonRoom{128};
+ *   }
+ *   jw.endArray();
+ * }
+ *
+ * JsonChunkGenerator gen = writeRows(jw, rows, count);
+ * while (gen.next()) {
+ *   socket.send(gen.data(), gen.size()); // may interleave with other generators
+ * }
+ * bool complete = gen.ok();
+ * @endcode
+ */
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define JSON_BUF_WRITER_HAS_COROUTINES 1
+#endif
+#endif
+
+#if defined(JSON_BUF_WRITER_HAS_COROUTINES)
+
+/** @brief Yield operand: hand the buffered bytes to the consumer if fewer than #bytes are free. */
+struct JsonRoom
+{
+    size_t bytes; ///< Free space needed before the next checkpoint.
+};
+
+/**
+ * @class JsonChunkGenerator
+ * @brief Coroutine handle yielding chunks of a document written through a `JsonBufWriter`.
+ *
+ * Move-only. Destroying the generator destroys a suspended coroutine.
+ */
+class JsonChunkGenerator
+{
+public:
+    /// @cond INTERNAL
+    struct promise_type
+    {
+        JsonBufWriter *writer = nullptr;
+        const uint8_t *chunk = nullptr;
+        size_t chunkLength = 0;
+        bool failed = false;
+        bool complete = false;
+
+        /** @brief Binds the writer passed as the coroutine's first argument. */
+        template <typename... Rest>
+        promise_type(JsonBufWriter &jw, Rest &...) : writer(&jw)
+        {
+        }
+
+        /** @brief Fallback for signatures without a leading writer; the generator fails. */
+        promise_type() : failed(true)
+        {
+        }
+
+        struct RoomAwaiter
+        {
+            promise_type *promise;
+            bool suspend;
+
+            bool await_ready() const noexcept { return !suspend; }
+            void await_suspend(std::coroutine_handle<>) const noexcept {}
+            void await_resume() const noexcept
+            {
+                // The consumer has taken the chunk; continue at the start of the buffer
+                if (suspend && !promise->failed)
+                {
+                    promise->writer->flush();
+                }
+            }
+        };
+
+        JsonChunkGenerator get_return_object()
+        {
+            return JsonChunkGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        std::suspend_always final_suspend() const noexcept { return {}; }
+
+        RoomAwaiter yield_value(JsonRoom room) noexcept
+        {
+            if (failed || !writer->ok())
+            {
+                // Park the coroutine for good; next() reports the end
+                failed = true;
+                return {this, true};
+            }
+            if (writer->size() == 0 || writer->available() >= room.bytes)
+            {
+                return {this, false};
+            }
+            chunk = writer->data();
+            chunkLength = writer->size();
+            return {this, true};
+        }
+
+        void return_void() noexcept
+        {
+            if (!failed && writer->finalize(chunk, chunkLength))
+            {
+                complete = true;
+            }
+            else
+            {
+                failed = true;
+                chunkLength = 0;
+            }
+        }
+
+        void unhandled_exception() noexcept
+        {
+            failed = true;
+            chunkLength = 0;
+        }
+    };
+    /// @endcond
+
+    JsonChunkGenerator(JsonChunkGenerator &&other) noexcept : handle_(other.handle_)
+    {
+        other.handle_ = nullptr;
+    }
+
+    JsonChunkGenerator &operator=(JsonChunkGenerator &&other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy();
+            handle_ = other.handle_;
+            other.handle_ = nullptr;
+        }
+        return *this;
+    }
+
+    JsonChunkGenerator(const JsonChunkGenerator &) = delete;
+    JsonChunkGenerator &operator=(const JsonChunkGenerator &) = delete;
+
+    ~JsonChunkGenerator()
+    {
+        destroy();
+    }
+
+    /**
+     * @brief Run the serialization code until the next chunk is ready.
+     * @retval true A chunk is available through data()/size(); it stays valid until the next call.
+     * @retval false The document is finished or failed; check ok().
+     */
+    bool next()
+    {
+        if (!handle_ || handle_.done() || handle_.promise().failed)
+        {
+            return false;
+        }
+        promise_type &promise = handle_.promise();
+        promise.chunkLength = 0;
+        handle_.resume();
+        return promise.chunkLength != 0;
+    }
+
+    /** @brief Start of the current chunk. */
+    const uint8_t *data() const
+    {
+        return handle_ ? handle_.promise().chunk : nullptr;
+    }
+
+    /** @brief Length of the current chunk in bytes. */
+    size_t size() const
+    {
+        return handle_ ? handle_.promise().chunkLength : 0;
+    }
+
+    /** @brief Whether the coroutine has returned (successfully or not). */
+    bool done() const
+    {
+        return !handle_ || handle_.done() || handle_.promise().failed;
+    }
+
+    /** @brief True once the body has returned and the document was complete and error-free. */
+    bool ok() const
+    {
+        return handle_ && handle_.promise().complete;
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_; ///< Owned coroutine frame.
+
+    explicit JsonChunkGenerator(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    void destroy()
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+};
+
+#endif // JSON_BUF_WRITER_HAS_COROUTINES
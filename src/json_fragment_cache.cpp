@@ -0,0 +1,158 @@
+#include "json_fragment_cache.hpp"
+
+#include <string.h>
+
+JsonFragmentCache::JsonFragmentCache(JsonFragmentCacheEntry *entries, size_t count, uint8_t *storage, size_t capacity)
+    : entries_(entries), count_(count), storage_(storage), slotSize_(count ? capacity / count : 0), nextVictim_(0),
+      recording_(false), recordId_(0), recordVersion_(0), recordStart_(0), recordDepth_(0),
+      recordPage_(0), recordDropped_(0)
+{
+    clear();
+}
+
+void JsonFragmentCache::clear()
+{
+    for (size_t i = 0; i < count_; ++i)
+    {
+        entries_[i].length = 0;
+    }
+    nextVictim_ = 0;
+    recording_ = false;
+}
+
+void JsonFragmentCache::invalidate(uint32_t id)
+{
+    for (size_t i = 0; i < count_; ++i)
+    {
+        if (entries_[i].length != 0 && entries_[i].id == id)
+        {
+            entries_[i].length = 0;
+        }
+    }
+}
+
+size_t JsonFragmentCache::slotSize() const
+{
+    return slotSize_;
+}
+
+const uint8_t *JsonFragmentCache::lookup(uint32_t id, uint32_t version, size_t &length) const
+{
+    for (size_t i = 0; i < count_; ++i)
+    {
+        const JsonFragmentCacheEntry &entry = entries_[i];
+        if (entry.length != 0 && entry.id == id && entry.version == version)
+        {
+            length = entry.length;
+            return storage_ + i * slotSize_;
+        }
+    }
+    return nullptr;
+}
+
+bool JsonFragmentCache::store(uint32_t id, uint32_t version, const uint8_t *data, size_t length)
+{
+    if (length == 0 || length > slotSize_)
+    {
+        invalidate(id); // Never replay an outdated version
+        return false;
+    }
+
+    // Prefer the slot already holding this id, then a free one, then round-robin
+    size_t slot = count_;
+    for (size_t i = 0; i < count_ && slot == count_; ++i)
+    {
+        if (entries_[i].length != 0 && entries_[i].id == id)
+        {
+            slot = i;
+        }
+    }
+    for (size_t i = 0; i < count_ && slot == count_; ++i)
+    {
+        if (entries_[i].length == 0)
+        {
+            slot = i;
+        }
+    }
+    if (slot == count_)
+    {
+        slot = nextVictim_;
+        nextVictim_ = (nextVictim_ + 1) % count_;
+    }
+
+    memcpy(storage_ + slot * slotSize_, data, length);
+    entries_[slot].id = id;
+    entries_[slot].version = version;
+    entries_[slot].length = length;
+    return true;
+}
+
+// JsonBufWriter entry points live here so the writer does not depend on the cache
+
+bool JsonBufWriter::beginCached(JsonFragmentCache &cache, uint32_t id, uint32_t version)
+{
+    if (hasError_ || cache.recording_)
+    {
+        return setError();
+    }
+
+    size_t length;
+    const uint8_t *cached = cache.lookup(id, version, length);
+    if (cached)
+    {
+        if (!addCommaIfNeeded() || !writeRawData(reinterpret_cast<const char *>(cached), length))
+        {
+            return false;
+        }
+        return updateStateAfterValue();
+    }
+
+    cache.recording_ = true;
+    cache.recordId_ = id;
+    cache.recordVersion_ = version;
+    cache.recordStart_ = flushed_ + length_;
+    cache.recordDepth_ = depth_;
+    cache.recordPage_ = pageCount_;
+    cache.recordDropped_ = droppedCount_;
+    return false;
+}
+
+bool JsonBufWriter::endCached(JsonFragmentCache &cache)
+{
+    if (!cache.recording_)
+    {
+        return setError();
+    }
+    cache.recording_ = false;
+
+    const size_t end = flushed_ + length_;
+    const bool dropped = droppedCount_ != cache.recordDropped_;
+    if (hasError_ || depth_ != cache.recordDepth_ || (end == cache.recordStart_ && !dropped))
+    {
+        return setError();
+    }
+
+    if (cache.recordStart_ < flushed_ || cache.recordPage_ != pageCount_ || dropped || end <= cache.recordStart_)
+    {
+        // Part of the value was already flushed, moved by a page cut or dropped in best-effort
+        // mode (possibly with its key): keep the document, skip caching
+        cache.invalidate(cache.recordId_);
+        return true;
+    }
+
+    // The separator belongs to the surrounding container, not to the value
+    const uint8_t *start = buffer_ + (cache.recordStart_ - flushed_);
+    size_t length = end - cache.recordStart_;
+    if (*start == ',')
+    {
+        ++start;
+        --length;
+    }
+    // So is a JSON Lines record terminator: replaying the value ends the record again
+    if (jsonLines_ && cache.recordDepth_ == 0 && length != 0 && start[length - 1] == '\n')
+    {
+        --length;
+    }
+    cache.store(cache.recordId_, cache.recordVersion_, start, length);
+    return true;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "json_buffer_writer.hpp"
+
+/**
+ * @file
+ * @brief Fixed-capacity cache of serialized sub-documents.
+ *
+ * @details
+ * Parts of a document that rarely change (device info, static configuration) can be
+ * serialized once and replayed with a single copy afterwards. Each fragment is identified
+ * by a caller-chosen id and versioned by a caller-supplied number (counter, hash, ...).
+ * JsonBufWriter::beginCached() replays the stored bytes when the version matches;
+ * otherwise the caller writes the value normally and JsonBufWriter::endCached() records
+ * the bytes it produced.
+ *
+ * The cache does not allocate: the caller provides the entry table and the byte storage,
+ * which is split into equal slots, one per entry. Fragments larger than a slot are
+ * written normally but not cached. When all entries are taken, entries are recycled
+ * round-robin.
+ *
+ * ### Example
+ * @code{.cpp}
+ * static JsonFragmentCacheEntry entries[4];
+ * static uint8_t storage[4 * 128];
+ * static JsonFragmentCache cache(entries, 4, storage, sizeof(storage));
+ *
+ * jw.key("device");
+ * if (!jw.beginCached(cache, DEVICE_INFO, deviceInfoVersion)) {
+ *   writeDeviceInfo(jw);
+ *   jw.endCached(cache);
+ * }
+ * @endcode
+ */
+
+/** @brief Bookkeeping for one cached fragment (zero-initialize; managed by the cache). */
+struct JsonFragmentCacheEntry
+{
+    uint32_t id;      ///< Caller-chosen fragment id.
+    uint32_t version; ///< Version the stored bytes were produced from.
+    size_t length;    ///< Stored bytes; 0 = entry unused.
+};
+
+/**
+ * @class JsonFragmentCache
+ * @brief Memoizes serialized values by id and version.
+ *
+ * The entry table and storage are caller-owned and must stay valid while the cache is used.
+ * Only one fragment can be recorded at a time.
+ */
+class JsonFragmentCache
+{
+public:
+    /**
+     * @brief Bind the cache to caller-provided memory.
+     * @param entries Entry table.
+     * @param count Number of entries in @p entries.
+     * @param storage Byte storage, split evenly between the entries.
+     * @param capacity Size of @p storage in bytes.
+     */
+    JsonFragmentCache(JsonFragmentCacheEntry *entries, size_t count, uint8_t *storage, size_t capacity);
+
+    /** @brief Drop all cached fragments and abandon an unfinished recording. */
+    void clear();
+
+    /** @brief Drop the fragment with @p id, if cached. */
+    void invalidate(uint32_t id);
+
+    /** @brief Largest fragment that can be cached, in bytes. */
+    size_t slotSize() const;
+
+    /**
+     * @brief Find a fragment.
+     * @param id Fragment id.
+     * @param version Required version.
+     * @param[out] length Length of the stored bytes on success.
+     * @return Stored bytes, or `nullptr` if @p id is not cached at @p version.
+     */
+    const uint8_t *lookup(uint32_t id, uint32_t version, size_t &length) const;
+
+    /**
+     * @brief Store a fragment, replacing an older version of the same id.
+     * @retval true Stored.
+     * @retval false @p length is 0 or exceeds slotSize().
+     */
+    bool store(uint32_t id, uint32_t version, const uint8_t *data, size_t length);
+
+private:
+    friend class JsonBufWriter;
+
+    JsonFragmentCacheEntry *entries_; ///< Caller-owned entry table.
+    size_t count_;                    ///< Number of entries.
+    uint8_t *storage_;                ///< Caller-owned slot storage.
+    size_t slotSize_;                 ///< Bytes per entry.
+    size_t nextVictim_;               ///< Round-robin replacement cursor.
+
+    // Fragment being recorded between beginCached() and endCached()
+    bool recording_;         ///< A recording is in progress.
+    uint32_t recordId_;      ///< Id of the recorded fragment.
+    uint32_t recordVersion_; ///< Version of the recorded fragment.
+    size_t recordStart_;     ///< Document offset where recording started.
+    uint8_t recordDepth_;    ///< Writer depth at beginCached().
+    size_t recordPage_;      ///< Writer page count at beginCached().
+    size_t recordDropped_;   ///< Writer dropped-value count at beginCached().
+};
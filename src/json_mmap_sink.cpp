@@ -0,0 +1,144 @@
+#include "json_mmap_sink.hpp"
+
+#if defined(JSON_BUF_WRITER_HAS_MMAP)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+JsonMmapSink::JsonMmapSink(size_t growStep)
+    : growStep_(0), fd_(-1), map_(nullptr), mapped_(0), committed_(0), writer_(nullptr)
+{
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    growStep_ = (growStep < page ? page : growStep + page - 1) / page * page;
+}
+
+JsonMmapSink::~JsonMmapSink()
+{
+    close();
+}
+
+bool JsonMmapSink::open(const char *path, JsonBufWriter &writer)
+{
+    close();
+    committed_ = 0;
+    fd_ = ::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0)
+    {
+        return false;
+    }
+    if (ftruncate(fd_, static_cast<off_t>(growStep_)) != 0)
+    {
+        release(0);
+        return false;
+    }
+
+    void *map = mmap(nullptr, growStep_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED)
+    {
+        release(0);
+        return false;
+    }
+    map_ = static_cast<uint8_t *>(map);
+    mapped_ = growStep_;
+    madvise(map_, mapped_, MADV_SEQUENTIAL);
+
+    writer_ = &writer;
+    writer.reset(map_, mapped_);
+    writer.setFlushHandler(&JsonMmapSink::onFlush, this);
+    return true;
+}
+
+bool JsonMmapSink::finish(JsonBufWriter &writer)
+{
+    // Without the handler, finalize() leaves the tail in the mapping
+    writer.setFlushHandler(nullptr, nullptr);
+    writer_ = nullptr;
+    if (fd_ < 0)
+    {
+        return false;
+    }
+
+    const uint8_t *output;
+    size_t length;
+    const bool complete = writer.finalize(output, length);
+    release(committed_ + writer.size());
+    return complete;
+}
+
+void JsonMmapSink::close()
+{
+    if (writer_)
+    {
+        writer_->setFlushHandler(nullptr, nullptr);
+        writer_ = nullptr;
+    }
+    if (fd_ >= 0)
+    {
+        release(committed_);
+    }
+}
+
+bool JsonMmapSink::isOpen() const
+{
+    return fd_ >= 0;
+}
+
+size_t JsonMmapSink::length() const
+{
+    return committed_;
+}
+
+bool JsonMmapSink::onFlush(void *context, const uint8_t *data, size_t length)
+{
+    JsonMmapSink *sink = static_cast<JsonMmapSink *>(context);
+    if (!sink->writer_ || data != sink->map_ + sink->committed_)
+    {
+        return false;
+    }
+
+    // The bytes are already in the file; extend it and continue right after them
+    if (!sink->grow())
+    {
+        return false;
+    }
+    sink->committed_ += length;
+    sink->writer_->continueIn(sink->map_ + sink->committed_, sink->mapped_ - sink->committed_);
+    return true;
+}
+
+bool JsonMmapSink::grow()
+{
+    const size_t size = mapped_ + growStep_;
+    if (size < mapped_ || ftruncate(fd_, static_cast<off_t>(size)) != 0)
+    {
+        return false;
+    }
+
+    void *map = mremap(map_, mapped_, size, MREMAP_MAYMOVE);
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+    map_ = static_cast<uint8_t *>(map);
+    mapped_ = size;
+    return true;
+}
+
+void JsonMmapSink::release(size_t length)
+{
+    if (map_)
+    {
+        munmap(map_, mapped_);
+    }
+    if (ftruncate(fd_, static_cast<off_t>(length)) == 0)
+    {
+        committed_ = length;
+    }
+    ::close(fd_);
+    fd_ = -1;
+    map_ = nullptr;
+    mapped_ = 0;
+}
+
+#endif // JSON_BUF_WRITER_HAS_MMAP
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "json_buffer_writer.hpp"
+
+/**
+ * @file
+ * @brief Output written straight into a memory-mapped file (Linux).
+ *
+ * @details
+ * `JsonMmapSink` maps the output file and points the writer at the mapping, so the
+ * document is serialized directly into the page cache: there is no staging buffer to
+ * copy from and no `write()` call per buffer. When the mapped region is full, the sink
+ * (installed as the flush handler) extends the file by `growStep` bytes with
+ * `ftruncate()`, remaps it with `mremap()` and lets the writer continue right after the
+ * last byte (JsonBufWriter::continueIn()). finish() finalizes the document and truncates
+ * the file to its exact length.
+ *
+ * Placeholders can only be filled until the region they are in has been flushed.
+ *
+ * Only available on Linux (`JSON_BUF_WRITER_HAS_MMAP`).
+ *
+ * ### Example
+ * @code{.cpp}
+ * JsonMmapSink sink;
+ * JsonBufWriter jw(nullptr, 0);
+ * if (sink.open("/var/export/archive.json", jw)) {
+ *   // ... write the document ...
+ *   bool complete = sink.finish(jw); // file is now exactly sink.length() bytes
+ * }
+ * @endcode
+ */
+
+#if defined(__linux__)
+#define JSON_BUF_WRITER_HAS_MMAP 1
+#endif
+
+#if defined(JSON_BUF_WRITER_HAS_MMAP)
+
+/**
+ * @class JsonMmapSink
+ * @brief Flush handler that grows a memory-mapped output file under the writer.
+ */
+class JsonMmapSink
+{
+public:
+    static constexpr size_t DEFAULT_GROW_STEP = 64u << 20; ///< File growth per remap (64 MiB).
+
+    /**
+     * @brief Create a closed sink.
+     * @param growStep Bytes added to the file each time the mapping is full (rounded up
+     *                 to the page size).
+     */
+    explicit JsonMmapSink(size_t growStep = DEFAULT_GROW_STEP);
+
+    /** @brief Closes the file if still open (see close()). */
+    ~JsonMmapSink();
+
+    JsonMmapSink(const JsonMmapSink &) = delete;
+    JsonMmapSink &operator=(const JsonMmapSink &) = delete;
+
+    /**
+     * @brief Create or truncate @p path, map its first region and point @p writer at it.
+     * @details Resets @p writer and installs the sink as its flush handler.
+     * @retval false The file could not be created, sized or mapped (`errno` is set).
+     */
+    bool open(const char *path, JsonBufWriter &writer);
+
+    /**
+     * @brief Finalize the document, truncate the file to its length and close it.
+     * @details Removes the flush handler from @p writer. The writer's buffer is no
+     *          longer valid afterwards.
+     * @retval true The document is complete and on disk as length() bytes.
+     */
+    bool finish(JsonBufWriter &writer);
+
+    /**
+     * @brief Unmap and close without finalizing.
+     * @details The file keeps the bytes flushed so far, truncated to their length.
+     */
+    void close();
+
+    /** @brief Whether a file is open. */
+    bool isOpen() const;
+
+    /** @brief Document bytes in the file: flushed so far, or the total after finish(). */
+    size_t length() const;
+
+    /** @brief `JsonBufWriter::FlushHandler` entry point; @p context is the sink. */
+    static bool onFlush(void *context, const uint8_t *data, size_t length);
+
+private:
+    size_t growStep_;       ///< Bytes added per remap, a multiple of the page size.
+    int fd_;                ///< Output file, or -1.
+    uint8_t *map_;          ///< Start of the mapping.
+    size_t mapped_;         ///< Bytes mapped (= current file size).
+    size_t committed_;      ///< Document bytes before the writer's buffer.
+    JsonBufWriter *writer_; ///< Writer being fed (between open() and finish()).
+
+    bool grow();
+    void release(size_t length);
+};
+
+#endif // JSON_BUF_WRITER_HAS_MMAP
@@ -0,0 +1,601 @@
+#include "json_reader.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_scan.hpp"
+
+namespace
+{
+    bool isDigit(uint8_t c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    int hexValue(uint8_t c)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            return c - '0';
+        }
+        c |= 0x20; // Fold to lower case
+        return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+    }
+
+    /** @brief Value of the 4 hex digits at @p p (already validated by the tokenizer). */
+    uint32_t readHex4(const uint8_t *p)
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            value = (value << 4) | static_cast<uint32_t>(hexValue(p[i]));
+        }
+        return value;
+    }
+
+    size_t encodeUtf8(uint32_t cp, uint8_t *out)
+    {
+        if (cp < 0x80)
+        {
+            out[0] = static_cast<uint8_t>(cp);
+            return 1;
+        }
+        if (cp < 0x800)
+        {
+            out[0] = static_cast<uint8_t>(0xC0 | (cp >> 6));
+            out[1] = static_cast<uint8_t>(0x80 | (cp & 0x3F));
+            return 2;
+        }
+        if (cp < 0x10000)
+        {
+            out[0] = static_cast<uint8_t>(0xE0 | (cp >> 12));
+            out[1] = static_cast<uint8_t>(0x80 | ((cp >> 6) & 0x3F));
+            out[2] = static_cast<uint8_t>(0x80 | (cp & 0x3F));
+            return 3;
+        }
+        out[0] = static_cast<uint8_t>(0xF0 | (cp >> 18));
+        out[1] = static_cast<uint8_t>(0x80 | ((cp >> 12) & 0x3F));
+        out[2] = static_cast<uint8_t>(0x80 | ((cp >> 6) & 0x3F));
+        out[3] = static_cast<uint8_t>(0x80 | (cp & 0x3F));
+        return 4;
+    }
+
+    /**
+     * @brief Decode the escape sequence at @p p (a validated backslash) and advance past it.
+     * @return Number of UTF-8 bytes written to @p out (1-4).
+     */
+    size_t decodeEscape(const uint8_t *&p, const uint8_t *end, uint8_t *out)
+    {
+        uint8_t c = p[1];
+        p += 2;
+        switch (c)
+        {
+        case 'b': out[0] = '\b'; return 1;
+        case 'f': out[0] = '\f'; return 1;
+        case 'n': out[0] = '\n'; return 1;
+        case 'r': out[0] = '\r'; return 1;
+        case 't': out[0] = '\t'; return 1;
+        case 'u': break;
+        default: out[0] = c; return 1; // '"', '\\' and '/'
+        }
+
+        uint32_t cp = readHex4(p);
+        p += 4;
+        if (cp >= 0xD800 && cp <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u')
+        {
+            uint32_t low = readHex4(p + 2);
+            if (low >= 0xDC00 && low <= 0xDFFF)
+            {
+                p += 6;
+                return encodeUtf8(0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00), out);
+            }
+        }
+        if (cp >= 0xD800 && cp <= 0xDFFF)
+        {
+            cp = 0xFFFD; // Unpaired surrogate
+        }
+        return encodeUtf8(cp, out);
+    }
+}
+
+JsonReader::JsonReader(const uint8_t *input, size_t length)
+    : jsonLines_(false), validateUtf8_(false)
+{
+    reset(input, length);
+}
+
+JsonReader::JsonReader(const char *input, size_t length)
+    : JsonReader(reinterpret_cast<const uint8_t *>(input), length)
+{
+}
+
+void JsonReader::reset(const uint8_t *input, size_t length)
+{
+    input_ = input;
+    length_ = input ? length : 0;
+    pos_ = 0;
+    start_ = 0;
+    size_ = 0;
+    objects_ = 0;
+    depth_ = 0;
+    token_ = Token::None;
+    expect_ = Expect::Value;
+    escapes_ = false;
+    integer_ = false;
+}
+
+void JsonReader::setJsonLines(bool enabled)
+{
+    jsonLines_ = enabled;
+}
+
+void JsonReader::setValidateUtf8(bool enabled)
+{
+    validateUtf8_ = enabled;
+}
+
+JsonReader::Token JsonReader::next()
+{
+    if (token_ == Token::End || token_ == Token::Error)
+    {
+        return token_;
+    }
+
+    const size_t gap = skipWhitespace();
+    switch (expect_)
+    {
+    case Expect::Value:
+        return readValue();
+    case Expect::ValueOrEnd:
+        return pos_ < length_ && input_[pos_] == ']' ? close() : readValue();
+    case Expect::Key:
+        return readKey();
+    case Expect::KeyOrEnd:
+        return pos_ < length_ && input_[pos_] == '}' ? close() : readKey();
+    case Expect::SeparatorOrEnd:
+        break;
+    }
+
+    if (depth_ == 0)
+    {
+        if (pos_ == length_)
+        {
+            return emit(Token::End, pos_, 0);
+        }
+        // Top-level values must be kept apart, or "1" "2" would read as "12"
+        return jsonLines_ && gap > 0 ? readValue() : fail(pos_);
+    }
+    if (pos_ == length_)
+    {
+        return fail(pos_);
+    }
+
+    const uint8_t c = input_[pos_];
+    if (c == ',')
+    {
+        ++pos_;
+        skipWhitespace();
+        return inObject() ? readKey() : readValue();
+    }
+    return c == (inObject() ? '}' : ']') ? close() : fail(pos_);
+}
+
+bool JsonReader::skip()
+{
+    if (token_ == Token::Key)
+    {
+        next();
+    }
+    if (token_ == Token::BeginObject || token_ == Token::BeginArray)
+    {
+        const uint8_t outer = depth_ - 1;
+        while (depth_ > outer && next() != Token::Error)
+        {
+        }
+    }
+    return token_ != Token::Error;
+}
+
+JsonReader::Token JsonReader::token() const
+{
+    return token_;
+}
+
+bool JsonReader::ok() const
+{
+    return token_ != Token::Error;
+}
+
+const char *JsonReader::data() const
+{
+    return reinterpret_cast<const char *>(input_ + start_);
+}
+
+size_t JsonReader::size() const
+{
+    return size_;
+}
+
+bool JsonReader::hasEscapes() const
+{
+    return (token_ == Token::String || token_ == Token::Key) && escapes_;
+}
+
+bool JsonReader::isInteger() const
+{
+    return token_ == Token::Number && integer_;
+}
+
+uint8_t JsonReader::depth() const
+{
+    return depth_;
+}
+
+size_t JsonReader::offset() const
+{
+    return pos_;
+}
+
+bool JsonReader::getString(char *out, size_t capacity, size_t &length) const
+{
+    if ((token_ != Token::String && token_ != Token::Key) || capacity == 0)
+    {
+        return false;
+    }
+
+    const uint8_t *p = input_ + start_;
+    const uint8_t *end = p + size_;
+    size_t written = 0;
+    while (p < end)
+    {
+        // Inside a validated span the only byte the scan stops at is a backslash
+        const size_t run = json_detail::scanPlain(p, static_cast<size_t>(end - p), false);
+        uint8_t decoded[4];
+        const uint8_t *chunk = p;
+        size_t chunkLength = run;
+        if (run == 0)
+        {
+            chunkLength = decodeEscape(p, end, decoded);
+            chunk = decoded;
+        }
+        else
+        {
+            p += run;
+        }
+        if (capacity - written <= chunkLength)
+        {
+            return false;
+        }
+        memcpy(out + written, chunk, chunkLength);
+        written += chunkLength;
+    }
+
+    out[written] = '\0';
+    length = written;
+    return true;
+}
+
+bool JsonReader::equals(const char *text) const
+{
+    if (token_ != Token::String && token_ != Token::Key)
+    {
+        return false;
+    }
+
+    const size_t textLength = strlen(text);
+    if (!escapes_)
+    {
+        return textLength == size_ && memcmp(input_ + start_, text, size_) == 0;
+    }
+
+    const uint8_t *p = input_ + start_;
+    const uint8_t *end = p + size_;
+    const uint8_t *expected = reinterpret_cast<const uint8_t *>(text);
+    const uint8_t *expectedEnd = expected + textLength;
+    while (p < end)
+    {
+        uint8_t decoded[4];
+        const uint8_t *chunk = decoded;
+        size_t chunkLength = 1;
+        if (*p == '\\')
+        {
+            chunkLength = decodeEscape(p, end, decoded);
+        }
+        else
+        {
+            chunk = p++;
+        }
+        if (static_cast<size_t>(expectedEnd - expected) < chunkLength || memcmp(expected, chunk, chunkLength) != 0)
+        {
+            return false;
+        }
+        expected += chunkLength;
+    }
+    return expected == expectedEnd;
+}
+
+bool JsonReader::getInt(int64_t &out) const
+{
+    if (!isInteger())
+    {
+        return false;
+    }
+
+    const bool negative = input_[start_] == '-';
+    uint64_t magnitude = 0;
+    for (size_t i = negative ? 1 : 0; i < size_; ++i)
+    {
+        const uint64_t digit = input_[start_ + i] - '0';
+        if (magnitude > (UINT64_MAX - digit) / 10)
+        {
+            return false;
+        }
+        magnitude = magnitude * 10 + digit;
+    }
+
+    const uint64_t limit = static_cast<uint64_t>(INT64_MAX) + (negative ? 1 : 0);
+    if (magnitude > limit)
+    {
+        return false;
+    }
+    out = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+bool JsonReader::getUint(uint64_t &out) const
+{
+    if (!isInteger() || input_[start_] == '-')
+    {
+        return false;
+    }
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < size_; ++i)
+    {
+        const uint64_t digit = input_[start_ + i] - '0';
+        if (value > (UINT64_MAX - digit) / 10)
+        {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    out = value;
+    return true;
+}
+
+bool JsonReader::getDouble(double &out) const
+{
+    char text[64];
+    if (token_ != Token::Number || size_ >= sizeof(text))
+    {
+        return false;
+    }
+
+    // The span is not null-terminated
+    memcpy(text, input_ + start_, size_);
+    text[size_] = '\0';
+    out = strtod(text, nullptr);
+    return true;
+}
+
+bool JsonReader::inObject() const
+{
+    return depth_ > 0 && ((objects_ >> (depth_ - 1)) & 1u) != 0;
+}
+
+size_t JsonReader::skipWhitespace()
+{
+    const size_t gap = json_detail::scanWhitespace(input_ + pos_, length_ - pos_);
+    pos_ += gap;
+    return gap;
+}
+
+JsonReader::Token JsonReader::emit(Token token, size_t start, size_t size)
+{
+    token_ = token;
+    start_ = start;
+    size_ = size;
+    return token;
+}
+
+JsonReader::Token JsonReader::fail(size_t offset)
+{
+    pos_ = offset;
+    return emit(Token::Error, offset, 0);
+}
+
+JsonReader::Token JsonReader::readValue()
+{
+    if (pos_ >= length_)
+    {
+        return fail(pos_);
+    }
+
+    expect_ = Expect::SeparatorOrEnd;
+    const uint8_t c = input_[pos_];
+    switch (c)
+    {
+    case '{': return open(true);
+    case '[': return open(false);
+    case '"': return readString(Token::String);
+    case 't': return readLiteral("true", 4, Token::True);
+    case 'f': return readLiteral("false", 5, Token::False);
+    case 'n': return readLiteral("null", 4, Token::Null);
+    default: break;
+    }
+    return c == '-' || isDigit(c) ? readNumber() : fail(pos_);
+}
+
+JsonReader::Token JsonReader::readKey()
+{
+    if (pos_ >= length_ || input_[pos_] != '"')
+    {
+        return fail(pos_);
+    }
+    if (readString(Token::Key) == Token::Error)
+    {
+        return Token::Error;
+    }
+
+    skipWhitespace();
+    if (pos_ >= length_ || input_[pos_] != ':')
+    {
+        return fail(pos_);
+    }
+    ++pos_;
+    expect_ = Expect::Value;
+    return token_;
+}
+
+JsonReader::Token JsonReader::readString(Token token)
+{
+    size_t p = pos_ + 1;
+    bool escapes = false;
+    for (;;)
+    {
+        p += json_detail::scanPlain(input_ + p, length_ - p, validateUtf8_);
+        if (p >= length_)
+        {
+            return fail(p);
+        }
+
+        const uint8_t c = input_[p];
+        if (c == '"')
+        {
+            break;
+        }
+        if (c >= 0x80)
+        {
+            uint32_t codePoint;
+            size_t consumed;
+            if (!json_detail::decodeUtf8(input_ + p, length_ - p, codePoint, consumed))
+            {
+                return fail(p);
+            }
+            p += consumed;
+            continue;
+        }
+        if (c != '\\' || p + 1 >= length_)
+        {
+            return fail(p); // Control character or truncated escape
+        }
+
+        escapes = true;
+        const uint8_t e = input_[p + 1];
+        if (e == 'u')
+        {
+            if (length_ - p < 6 || hexValue(input_[p + 2]) < 0 || hexValue(input_[p + 3]) < 0 ||
+                hexValue(input_[p + 4]) < 0 || hexValue(input_[p + 5]) < 0)
+            {
+                return fail(p);
+            }
+            p += 6;
+        }
+        else if (e == '"' || e == '\\' || e == '/' || e == 'b' || e == 'f' || e == 'n' || e == 'r' || e == 't')
+        {
+            p += 2;
+        }
+        else
+        {
+            return fail(p);
+        }
+    }
+
+    escapes_ = escapes;
+    emit(token, pos_ + 1, p - pos_ - 1);
+    pos_ = p + 1;
+    return token;
+}
+
+JsonReader::Token JsonReader::readNumber()
+{
+    // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+    size_t p = pos_;
+    if (input_[p] == '-')
+    {
+        ++p;
+    }
+    if (p >= length_ || !isDigit(input_[p]))
+    {
+        return fail(p);
+    }
+    if (input_[p++] != '0')
+    {
+        while (p < length_ && isDigit(input_[p]))
+        {
+            ++p;
+        }
+    }
+
+    bool integer = true;
+    if (p < length_ && input_[p] == '.')
+    {
+        integer = false;
+        if (++p >= length_ || !isDigit(input_[p]))
+        {
+            return fail(p);
+        }
+        while (p < length_ && isDigit(input_[p]))
+        {
+            ++p;
+        }
+    }
+    if (p < length_ && (input_[p] == 'e' || input_[p] == 'E'))
+    {
+        integer = false;
+        if (++p < length_ && (input_[p] == '+' || input_[p] == '-'))
+        {
+            ++p;
+        }
+        if (p >= length_ || !isDigit(input_[p]))
+        {
+            return fail(p);
+        }
+        while (p < length_ && isDigit(input_[p]))
+        {
+            ++p;
+        }
+    }
+
+    integer_ = integer;
+    emit(Token::Number, pos_, p - pos_);
+    pos_ = p;
+    return Token::Number;
+}
+
+JsonReader::Token JsonReader::readLiteral(const char *text, size_t length, Token token)
+{
+    if (length_ - pos_ < length || memcmp(input_ + pos_, text, length) != 0)
+    {
+        return fail(pos_);
+    }
+    emit(token, pos_, length);
+    pos_ += length;
+    return token;
+}
+
+JsonReader::Token JsonReader::open(bool object)
+{
+    if (depth_ >= MAX_DEPTH)
+    {
+        return fail(pos_);
+    }
+
+    const uint32_t bit = 1u << depth_;
+    objects_ = object ? (objects_ | bit) : (objects_ & ~bit);
+    ++depth_;
+    expect_ = object ? Expect::KeyOrEnd : Expect::ValueOrEnd;
+    emit(object ? Token::BeginObject : Token::BeginArray, pos_, 1);
+    ++pos_;
+    return token_;
+}
+
+JsonReader::Token JsonReader::close()
+{
+    const Token token = inObject() ? Token::EndObject : Token::EndArray;
+    --depth_;
+    expect_ = Expect::SeparatorOrEnd;
+    emit(token, pos_, 1);
+    ++pos_;
+    return token;
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file
+ * @brief Zero-allocation pull parser, the reading counterpart of JsonBufWriter.
+ *
+ * @details
+ * `JsonReader` tokenizes a complete document held in caller memory. Each call to next()
+ * advances by one token and validates it against the JSON grammar (RFC 8259) on the way:
+ * brackets must match, keys must be followed by a colon, commas may not trail, numbers and
+ * escapes must be well-formed. Nesting is tracked in a bit stack, so the reader needs no
+ * memory beyond the object itself.
+ *
+ * Tokens are spans into the input: strings and keys without their quotes (escapes are
+ * left as-is), numbers and literals as written. getString() decodes escapes into a caller
+ * buffer, equals() compares a key without copying, and getInt() / getUint() / getDouble()
+ * convert numbers.
+ *
+ * String bodies and whitespace runs are scanned 16 bytes at a time with SSE2 or NEON on
+ * hosts and a word at a time (SWAR) on MCUs, using the same scanners the writer uses for
+ * escaping.
+ *
+ * ### Example
+ * @code{.cpp}
+ * JsonReader reader(payload, length);
+ * reader.next(); // BeginObject
+ * while (reader.next() == JsonReader::Token::Key) {
+ *   if (reader.equals("interval")) {
+ *     reader.next();
+ *     reader.getUint(interval);
+ *   } else {
+ *     reader.skip(); // ignore unknown members
+ *   }
+ * }
+ * bool valid = reader.next() == JsonReader::Token::End;
+ * @endcode
+ */
+
+/**
+ * @class JsonReader
+ * @brief Pull parser over a caller-provided buffer.
+ *
+ * The input must stay valid and unchanged while the reader and its spans are used.
+ */
+class JsonReader
+{
+public:
+    static constexpr uint8_t MAX_DEPTH = 32; ///< Maximum nesting of objects and arrays.
+
+    /** @brief Kind of the current token. */
+    enum class Token : uint8_t
+    {
+        None,        ///< next() has not been called yet.
+        BeginObject, ///< `{`
+        EndObject,   ///< `}`
+        BeginArray,  ///< `[`
+        EndArray,    ///< `]`
+        Key,         ///< Object member name; the colon has been consumed.
+        String,      ///< String value.
+        Number,      ///< Number value.
+        True,        ///< `true`
+        False,       ///< `false`
+        Null,        ///< `null`
+        End,         ///< The document is complete and only whitespace follows.
+        Error        ///< Malformed or truncated input; see offset().
+    };
+
+    /**
+     * @brief Start reading a document.
+     * @param input Document bytes (need not be null-terminated).
+     * @param length Number of bytes in @p input.
+     */
+    JsonReader(const uint8_t *input, size_t length);
+
+    /** @overload */
+    JsonReader(const char *input, size_t length);
+
+    /**
+     * @brief Start over with another document.
+     * @details Options set with setJsonLines() and setValidateUtf8() are kept.
+     */
+    void reset(const uint8_t *input, size_t length);
+
+    /**
+     * @brief Accept a sequence of top-level values separated by whitespace (JSON Lines).
+     * @details next() returns Token::End only once all values have been read.
+     */
+    void setJsonLines(bool enabled);
+
+    /**
+     * @brief Reject strings and keys that are not well-formed UTF-8 (off by default).
+     * @details Off, bytes >= 0x80 are passed through unchecked, like the writer's
+     *          default Utf8Mode::Passthrough.
+     */
+    void setValidateUtf8(bool enabled);
+
+    /**
+     * @brief Advance to the next token.
+     * @return The new current token. Token::End and Token::Error are sticky.
+     */
+    Token next();
+
+    /**
+     * @brief Skip the value the current token starts.
+     * @details On Token::Key, moves past the member's value. On Token::BeginObject or
+     *          Token::BeginArray, moves to the matching closing token. Scalars are
+     *          already complete, so nothing moves.
+     * @retval false The input is malformed.
+     */
+    bool skip();
+
+    /** @brief The current token. */
+    Token token() const;
+
+    /** @brief Whether no error has been found so far. */
+    bool ok() const;
+
+    /**
+     * @brief First byte of the current token.
+     * @details Strings and keys start after the opening quote; brackets point at the
+     *          bracket itself.
+     */
+    const char *data() const;
+
+    /** @brief Length of the current token's span in bytes (without quotes). */
+    size_t size() const;
+
+    /** @brief Whether the current string or key contains escape sequences. */
+    bool hasEscapes() const;
+
+    /** @brief Whether the current number has neither fraction nor exponent. */
+    bool isInteger() const;
+
+    /** @brief Number of enclosing objects and arrays after the current token. */
+    uint8_t depth() const;
+
+    /**
+     * @brief Input position: just past the current token, or where the error was found.
+     */
+    size_t offset() const;
+
+    /**
+     * @brief Decode the current string or key into @p out, null-terminated.
+     * @details Escapes are decoded to UTF-8; a `\\u` escape of an unpaired surrogate
+     *          becomes U+FFFD.
+     * @param out Destination buffer.
+     * @param capacity Size of @p out, including the terminator.
+     * @param[out] length Decoded bytes, excluding the terminator.
+     * @retval false Not a string or key, or @p out is too small.
+     */
+    bool getString(char *out, size_t capacity, size_t &length) const;
+
+    /**
+     * @brief Compare the decoded current string or key with @p text.
+     * @param text Null-terminated UTF-8 text.
+     */
+    bool equals(const char *text) const;
+
+    /**
+     * @brief Convert the current number.
+     * @retval false Not an integer number, or out of range.
+     */
+    bool getInt(int64_t &out) const;
+
+    /** @copydoc getInt */
+    bool getUint(uint64_t &out) const;
+
+    /**
+     * @brief Convert the current number with `strtod()`.
+     * @retval false Not a number, or longer than 63 characters.
+     */
+    bool getDouble(double &out) const;
+
+private:
+    /** @brief What the grammar allows at the current position. */
+    enum class Expect : uint8_t
+    {
+        Value,         ///< A value (top level, after a colon, or after a comma in an array).
+        ValueOrEnd,    ///< A value or `]` (just after `[`).
+        Key,           ///< A key (after a comma in an object).
+        KeyOrEnd,      ///< A key or `}` (just after `{`).
+        SeparatorOrEnd ///< A comma, the closing bracket, or the end of the document.
+    };
+
+    const uint8_t *input_; ///< Document being read.
+    size_t length_;        ///< Bytes in input_.
+    size_t pos_;           ///< Next unread byte.
+    size_t start_;         ///< Offset of the current token's span.
+    size_t size_;          ///< Length of the current token's span.
+    uint32_t objects_;     ///< Bit n set: nesting level n + 1 is an object.
+    uint8_t depth_;        ///< Current nesting level.
+    Token token_;          ///< Current token.
+    Expect expect_;        ///< Grammar state.
+    bool escapes_;         ///< The current string contains escapes.
+    bool integer_;         ///< The current number is an integer.
+    bool jsonLines_;       ///< Several top-level values are allowed.
+    bool validateUtf8_;    ///< Strings must be well-formed UTF-8.
+
+    bool inObject() const;
+    size_t skipWhitespace();
+    Token emit(Token token, size_t start, size_t size);
+    Token fail(size_t offset);
+    Token readValue();
+    Token readKey();
+    Token readString(Token token);
+    Token readNumber();
+    Token readLiteral(const char *text, size_t length, Token token);
+    Token open(bool object);
+    Token close();
+};
@@ -0,0 +1,315 @@
+#include "json_record_serializer.hpp"
+
+#include <string.h>
+
+namespace
+{
+    // Cached key at cursor; advances cursor to the next one
+    const char *nextKey(const char *&cursor, uint16_t &length)
+    {
+        memcpy(&length, cursor, sizeof(length));
+        const char *key = cursor + sizeof(length);
+        cursor = key + length;
+        return key;
+    }
+
+    template <typename T>
+    T load(const uint8_t *data)
+    {
+        T value;
+        memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    template <>
+    bool load<bool>(const uint8_t *data)
+    {
+        return data[0] != 0;
+    }
+
+    // One field of consecutive records, iterable by JsonBufWriter::array(). Iterators count
+    // elements rather than compare pointers, so a zero stride repeats one record
+    template <typename T>
+    class Column
+    {
+    public:
+        class Iterator
+        {
+        public:
+            Iterator(const uint8_t *first, size_t stride, size_t index) : first_(first), stride_(stride), index_(index) {}
+            T operator*() const { return load<T>(first_ + index_ * stride_); }
+            Iterator &operator++()
+            {
+                ++index_;
+                return *this;
+            }
+            bool operator!=(const Iterator &other) const { return index_ != other.index_; }
+
+        private:
+            const uint8_t *first_;
+            size_t stride_;
+            size_t index_;
+        };
+
+        Column(const uint8_t *first, size_t count, size_t stride)
+            : first_(first), count_(count), stride_(stride) {}
+        Iterator begin() const { return Iterator(first_, stride_, 0); }
+        Iterator end() const { return Iterator(first_, stride_, count_); }
+
+    private:
+        const uint8_t *first_;
+        size_t count_;
+        size_t stride_;
+    };
+
+    // Like JsonBufWriter::array(): a container refused in best-effort mode still needs its
+    // closing call, so the writer can keep closing the document cleanly
+    bool openContainer(JsonBufWriter &writer, bool object)
+    {
+        if (object ? writer.beginObject() : writer.beginArray())
+        {
+            return true;
+        }
+        if (writer.ok())
+        {
+            object ? writer.endObject() : writer.endArray();
+        }
+        return false;
+    }
+
+    template <typename T>
+    bool writeTyped(JsonBufWriter &writer, const uint8_t *first, size_t count, size_t stride)
+    {
+        return writer.array(Column<T>(first, count, stride));
+    }
+}
+
+JsonRecordSerializer::JsonRecordSerializer(const JsonRecordField *fields, size_t count)
+    : fields_(fields), count_(count), keys_(nullptr), compiled_(false)
+{
+}
+
+bool JsonRecordSerializer::compile(char *storage, size_t capacity, JsonBufWriter::Utf8Mode utf8Mode, bool asciiOnly)
+{
+    compiled_ = false;
+    size_t used = 0;
+
+    for (size_t i = 0; i < count_; ++i)
+    {
+        const JsonRecordField &field = fields_[i];
+        const size_t room = capacity - used;
+        if (!field.key || room <= sizeof(uint16_t))
+        {
+            return false;
+        }
+
+        // Reuse the writer's escaping: a root string value is exactly the quoted key
+        uint8_t *out = reinterpret_cast<uint8_t *>(storage + used + sizeof(uint16_t));
+        JsonBufWriter encoder(out, room - sizeof(uint16_t));
+        encoder.setUtf8Mode(utf8Mode);
+        encoder.setAsciiOnly(asciiOnly);
+        if (!encoder.value(field.key) || encoder.size() >= room - sizeof(uint16_t))
+        {
+            return false;
+        }
+
+        size_t length = encoder.size();
+        out[length++] = ':';
+        if (length > UINT16_MAX)
+        {
+            return false;
+        }
+
+        const uint16_t encodedLength = static_cast<uint16_t>(length);
+        memcpy(storage + used, &encodedLength, sizeof(encodedLength));
+        used += sizeof(encodedLength) + length;
+    }
+
+    keys_ = storage;
+    compiled_ = true;
+    return true;
+}
+
+bool JsonRecordSerializer::compiled() const
+{
+    return compiled_;
+}
+
+bool JsonRecordSerializer::writeObject(JsonBufWriter &writer, const void *record) const
+{
+    if (!compiled_)
+    {
+        return false;
+    }
+    return writeFields(writer, static_cast<const uint8_t *>(record));
+}
+
+bool JsonRecordSerializer::writeArray(JsonBufWriter &writer, const void *records, size_t count, size_t stride) const
+{
+    if (!compiled_ || !openContainer(writer, false))
+    {
+        return false;
+    }
+
+    bool complete = true;
+    const uint8_t *record = static_cast<const uint8_t *>(records);
+    for (size_t i = 0; i < count; ++i, record += stride)
+    {
+        if (!writeFields(writer, record))
+        {
+            if (!writer.ok())
+            {
+                return false;
+            }
+            complete = false; // Dropped in best-effort mode
+        }
+    }
+
+    return writer.endArray() && complete;
+}
+
+bool JsonRecordSerializer::writeColumns(JsonBufWriter &writer, const void *records, size_t count, size_t stride) const
+{
+    if (!compiled_ || !openContainer(writer, true))
+    {
+        return false;
+    }
+
+    bool complete = true;
+    const uint8_t *first = static_cast<const uint8_t *>(records);
+    const char *cursor = keys_;
+    for (size_t i = 0; i < count_; ++i)
+    {
+        const JsonRecordField &field = fields_[i];
+        uint16_t length;
+        const char *key = nextKey(cursor, length);
+        // A dropped key still needs its value call, which is then refused as well
+        const bool keyWritten = writer.rawKey(key, length);
+        if (!writeColumn(writer, field, first + field.offset, count, stride) || !keyWritten)
+        {
+            if (!writer.ok())
+            {
+                return false;
+            }
+            complete = false;
+        }
+    }
+
+    return writer.endObject() && complete;
+}
+
+bool JsonRecordSerializer::writeFields(JsonBufWriter &writer, const uint8_t *record) const
+{
+    if (!openContainer(writer, true))
+    {
+        return false;
+    }
+
+    bool complete = true;
+    const char *cursor = keys_;
+    for (size_t i = 0; i < count_; ++i)
+    {
+        const JsonRecordField &field = fields_[i];
+        uint16_t length;
+        const char *key = nextKey(cursor, length);
+        const bool keyWritten = writer.rawKey(key, length);
+        if (!writeField(writer, field, record + field.offset) || !keyWritten)
+        {
+            if (!writer.ok())
+            {
+                return false;
+            }
+            complete = false;
+        }
+    }
+
+    return writer.endObject() && complete;
+}
+
+bool JsonRecordSerializer::writeField(JsonBufWriter &writer, const JsonRecordField &field, const uint8_t *data)
+{
+    switch (field.type)
+    {
+    case JsonFieldType::Bool:
+        return writer.value(data[0] != 0);
+    case JsonFieldType::Int8:
+        return writer.value(static_cast<int32_t>(static_cast<int8_t>(data[0])));
+    case JsonFieldType::UInt8:
+        return writer.value(static_cast<uint32_t>(data[0]));
+    case JsonFieldType::Int16:
+        return writer.value(static_cast<int32_t>(load<int16_t>(data)));
+    case JsonFieldType::UInt16:
+        return writer.value(static_cast<uint32_t>(load<uint16_t>(data)));
+    case JsonFieldType::Int32:
+        return writer.value(load<int32_t>(data));
+    case JsonFieldType::UInt32:
+        return writer.value(load<uint32_t>(data));
+    case JsonFieldType::Int64:
+        return writer.value(load<int64_t>(data));
+    case JsonFieldType::UInt64:
+        return writer.value(load<uint64_t>(data));
+    case JsonFieldType::Float:
+        return writer.value(load<float>(data));
+    case JsonFieldType::Double:
+        return writer.value(load<double>(data));
+    case JsonFieldType::String:
+    {
+        const char *str = reinterpret_cast<const char *>(data);
+        const void *end = memchr(str, '\0', field.size);
+        size_t length = end ? static_cast<size_t>(static_cast<const char *>(end) - str) : field.size;
+        return writer.value(str, length);
+    }
+    }
+    return false;
+}
+
+bool JsonRecordSerializer::writeColumn(JsonBufWriter &writer, const JsonRecordField &field, const uint8_t *records,
+                                       size_t count, size_t stride)
+{
+    switch (field.type)
+    {
+    case JsonFieldType::Bool:
+        return writeTyped<bool>(writer, records, count, stride);
+    case JsonFieldType::Int8:
+        return writeTyped<int8_t>(writer, records, count, stride);
+    case JsonFieldType::UInt8:
+        return writeTyped<uint8_t>(writer, records, count, stride);
+    case JsonFieldType::Int16:
+        return writeTyped<int16_t>(writer, records, count, stride);
+    case JsonFieldType::UInt16:
+        return writeTyped<uint16_t>(writer, records, count, stride);
+    case JsonFieldType::Int32:
+        return writeTyped<int32_t>(writer, records, count, stride);
+    case JsonFieldType::UInt32:
+        return writeTyped<uint32_t>(writer, records, count, stride);
+    case JsonFieldType::Int64:
+        return writeTyped<int64_t>(writer, records, count, stride);
+    case JsonFieldType::UInt64:
+        return writeTyped<uint64_t>(writer, records, count, stride);
+    case JsonFieldType::Float:
+        return writeTyped<float>(writer, records, count, stride);
+    case JsonFieldType::Double:
+        return writeTyped<double>(writer, records, count, stride);
+    case JsonFieldType::String:
+        break;
+    }
+
+    // Strings have no range fast path: write them one by one
+    if (!openContainer(writer, false))
+    {
+        return false;
+    }
+    bool complete = true;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!writeField(writer, field, records + i * stride))
+        {
+            if (!writer.ok())
+            {
+                return false;
+            }
+            complete = false;
+        }
+    }
+    return writer.endArray() && complete;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "json_buffer_writer.hpp"
+
+/**
+ * @file
+ * @brief Schema-driven serializer for packed binary records.
+ *
+ * @details
+ * `JsonRecordSerializer` turns raw records whose layout is only known at runtime
+ * (e.g. loaded from a schema file) into JSON objects. The layout is described by a
+ * caller-owned table of #JsonRecordField entries. compile() escapes every key once
+ * into caller-provided storage, so serializing a record is a single loop over the
+ * table that copies cached keys and formats values through `JsonBufWriter`.
+ *
+ * Fields are read with `memcpy`, so records may be packed and unaligned. Multi-byte
+ * fields are interpreted in the host's native byte order.
+ *
+ * ### Example
+ * @code{.cpp}
+ * JsonRecordField fields[] = {
+ *   {"id",   0, JsonFieldType::UInt16},
+ *   {"temp", 2, JsonFieldType::Float},
+ *   {"name", 6, JsonFieldType::String, 8},
+ * };
+ * char keys[64];
+ * JsonRecordSerializer serializer(fields, 3);
+ * serializer.compile(keys, sizeof(keys));
+ *
+ * serializer.writeArray(jw, records, recordCount, recordSize);
+ * @endcode
+ *
+ * writeColumns() writes the same batch column by column, as `{"id":[...],"temp":[...]}`:
+ * each key appears once and each column goes through the writer's range fast path.
+ */
+
+/** @brief Storage type of a record field. */
+enum class JsonFieldType : uint8_t
+{
+    Bool,   ///< 1 byte, non-zero is `true`.
+    Int8,   ///< Signed 8-bit integer.
+    UInt8,  ///< Unsigned 8-bit integer.
+    Int16,  ///< Signed 16-bit integer.
+    UInt16, ///< Unsigned 16-bit integer.
+    Int32,  ///< Signed 32-bit integer.
+    UInt32, ///< Unsigned 32-bit integer.
+    Int64,  ///< Signed 64-bit integer.
+    UInt64, ///< Unsigned 64-bit integer.
+    Float,  ///< IEEE-754 single precision.
+    Double, ///< IEEE-754 double precision.
+    String  ///< Fixed-size character array of JsonRecordField::size bytes, terminated early by `'\0'`.
+};
+
+/**
+ * @brief Describes one field of a packed record.
+ *
+ * Tables are written as brace lists, e.g. `{"name", 6, JsonFieldType::String, 8}`;
+ * #size may be omitted for other types.
+ */
+struct JsonRecordField
+{
+    const char *key;    ///< Field name (null-terminated UTF-8).
+    uint32_t offset;    ///< Byte offset of the field within a record.
+    JsonFieldType type; ///< Storage type of the field.
+    uint16_t size;      ///< Size in bytes of a #JsonFieldType::String field; ignored otherwise.
+
+    JsonRecordField(const char *key, uint32_t offset, JsonFieldType type, uint16_t size = 0)
+        : key(key), offset(offset), type(type), size(size) {}
+};
+
+/**
+ * @class JsonRecordSerializer
+ * @brief Serializes raw records described by a #JsonRecordField table.
+ *
+ * The serializer does not own the field table or the key storage; both must stay
+ * valid while the serializer is in use.
+ */
+class JsonRecordSerializer
+{
+public:
+    /**
+     * @brief Bind the serializer to a field table.
+     * @param fields Caller-owned field descriptors.
+     * @param count Number of entries in @p fields.
+     */
+    JsonRecordSerializer(const JsonRecordField *fields, size_t count);
+
+    /**
+     * @brief Escape and cache all keys of the field table.
+     * @param storage Buffer receiving the encoded keys: each `"key":` fragment plus two
+     *                bytes per field.
+     * @param capacity Size of @p storage in bytes.
+     * @param utf8Mode Validation of non-ASCII key bytes, see JsonBufWriter::setUtf8Mode().
+     * @param asciiOnly Escape non-ASCII key code points, see JsonBufWriter::setAsciiOnly().
+     * @retval true All keys were encoded.
+     * @retval false @p storage is too small or a key is invalid; the serializer stays uncompiled.
+     * @note Keys are written as cached, so pass the encoding options of the writers the
+     *       records go to.
+     */
+    bool compile(char *storage, size_t capacity,
+                 JsonBufWriter::Utf8Mode utf8Mode = JsonBufWriter::Utf8Mode::Passthrough, bool asciiOnly = false);
+
+    /** @brief Whether compile() succeeded for the current table. */
+    bool compiled() const;
+
+    /**
+     * @brief Write one record as a JSON object.
+     * @param writer Destination writer, positioned where a value is allowed.
+     * @param record Pointer to the first byte of the record.
+     * @retval true Success.
+     * @retval false Not compiled, or the writer reported an error; also when a value was
+     *         dropped in best-effort mode (see JsonBufWriter::setBestEffort()), with the
+     *         containers still closed.
+     */
+    bool writeObject(JsonBufWriter &writer, const void *record) const;
+
+    /**
+     * @brief Write a sequence of records as a JSON array of objects.
+     * @param writer Destination writer, positioned where a value is allowed.
+     * @param records Pointer to the first record.
+     * @param count Number of records.
+     * @param stride Distance in bytes between consecutive records.
+     * @retval true Success.
+     * @retval false Not compiled, or the writer reported an error; also when a value was
+     *         dropped in best-effort mode (see JsonBufWriter::setBestEffort()), with the
+     *         containers still closed.
+     */
+    bool writeArray(JsonBufWriter &writer, const void *records, size_t count, size_t stride) const;
+
+    /**
+     * @brief Write a sequence of records as one object of per-field arrays.
+     * @details Produces `{"key1":[v0,v1,...],"key2":[...]}`, one array per field in table
+     *          order, each as long as @p count. Numeric and bool columns are written with
+     *          JsonBufWriter::array(), so the float format and precision of @p writer apply.
+     * @param writer Destination writer, positioned where a value is allowed.
+     * @param records Pointer to the first record.
+     * @param count Number of records.
+     * @param stride Distance in bytes between consecutive records.
+     * @retval true Success.
+     * @retval false Not compiled, or the writer reported an error; also when a value was
+     *         dropped in best-effort mode (see JsonBufWriter::setBestEffort()), with the
+     *         containers still closed.
+     */
+    bool writeColumns(JsonBufWriter &writer, const void *records, size_t count, size_t stride) const;
+
+private:
+    const JsonRecordField *fields_; ///< Caller-owned field table.
+    size_t count_;                  ///< Number of fields.
+    const char *keys_;              ///< Encoded keys in table order, each after its 16-bit length.
+    bool compiled_;                 ///< True once keys are cached.
+
+    /// @cond INTERNAL
+    bool writeFields(JsonBufWriter &writer, const uint8_t *record) const;
+    static bool writeField(JsonBufWriter &writer, const JsonRecordField &field, const uint8_t *data);
+    static bool writeColumn(JsonBufWriter &writer, const JsonRecordField &field, const uint8_t *records,
+                            size_t count, size_t stride);
+    /// @endcond
+};
@@ -0,0 +1,208 @@
+#include "json_rope.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+    void *heapAllocate(void *, size_t size)
+    {
+        return malloc(size);
+    }
+
+    void heapRelease(void *, void *block)
+    {
+        free(block);
+    }
+}
+
+JsonBlockAllocator JsonBlockAllocator::heap()
+{
+    return JsonBlockAllocator{&heapAllocate, &heapRelease, nullptr};
+}
+
+JsonSlabPool::JsonSlabPool(void *storage, size_t capacity, size_t slabSize)
+    : free_(nullptr), slabSize_(0), freeCount_(0)
+{
+    // Every slab must be able to hold the free-list pointer and stay pointer-aligned
+    const size_t align = sizeof(void *);
+    slabSize_ = (slabSize < align ? align : slabSize + align - 1) / align * align;
+
+    uint8_t *slab = static_cast<uint8_t *>(storage);
+    for (size_t i = capacity / slabSize_; i > 0; --i)
+    {
+        void *next = free_;
+        memcpy(slab + (i - 1) * slabSize_, &next, sizeof(next));
+        free_ = slab + (i - 1) * slabSize_;
+        freeCount_++;
+    }
+}
+
+JsonBlockAllocator JsonSlabPool::allocator()
+{
+    return JsonBlockAllocator{&JsonSlabPool::allocateSlab, &JsonSlabPool::releaseSlab, this};
+}
+
+size_t JsonSlabPool::available() const
+{
+    return freeCount_;
+}
+
+void *JsonSlabPool::allocateSlab(void *context, size_t size)
+{
+    JsonSlabPool *pool = static_cast<JsonSlabPool *>(context);
+    if (size > pool->slabSize_ || !pool->free_)
+    {
+        return nullptr;
+    }
+
+    void *slab = pool->free_;
+    memcpy(&pool->free_, slab, sizeof(pool->free_));
+    pool->freeCount_--;
+    return slab;
+}
+
+void JsonSlabPool::releaseSlab(void *context, void *block)
+{
+    JsonSlabPool *pool = static_cast<JsonSlabPool *>(context);
+    memcpy(block, &pool->free_, sizeof(pool->free_));
+    pool->free_ = block;
+    pool->freeCount_++;
+}
+
+JsonRope::JsonRope(const JsonBlockAllocator &allocator, size_t blockSize)
+    : allocator_(allocator), blockSize_(blockSize), first_(nullptr), last_(nullptr), blockCount_(0),
+      writer_(nullptr)
+{
+}
+
+JsonRope::~JsonRope()
+{
+    clear();
+}
+
+bool JsonRope::attach(JsonBufWriter &writer)
+{
+    clear();
+    writer_ = nullptr;
+    if (!appendBlock())
+    {
+        return false;
+    }
+
+    writer_ = &writer;
+    writer.reset(last_->data(), blockSize_ - sizeof(JsonRopeBlock));
+    writer.setFlushHandler(&JsonRope::onFlush, this);
+    return true;
+}
+
+bool JsonRope::finish(JsonBufWriter &writer)
+{
+    // Without the handler, finalize() leaves the tail in the current block
+    writer.setFlushHandler(nullptr, nullptr);
+    writer_ = nullptr;
+
+    const uint8_t *output;
+    size_t length;
+    if (!last_ || !writer.finalize(output, length))
+    {
+        return false;
+    }
+    last_->length = length;
+    return true;
+}
+
+void JsonRope::clear()
+{
+    while (first_)
+    {
+        JsonRopeBlock *next = first_->next;
+        allocator_.release(allocator_.context, first_);
+        first_ = next;
+    }
+    last_ = nullptr;
+    blockCount_ = 0;
+}
+
+const JsonRopeBlock *JsonRope::first() const
+{
+    return first_;
+}
+
+size_t JsonRope::blockCount() const
+{
+    return blockCount_;
+}
+
+size_t JsonRope::size() const
+{
+    size_t total = 0;
+    for (const JsonRopeBlock *block = first_; block; block = block->next)
+    {
+        total += block->length;
+    }
+    return total;
+}
+
+size_t JsonRope::gather(uint8_t *out, size_t capacity) const
+{
+    const size_t total = size();
+    if (total > capacity)
+    {
+        return 0;
+    }
+
+    for (const JsonRopeBlock *block = first_; block; block = block->next)
+    {
+        memcpy(out, block->data(), block->length);
+        out += block->length;
+    }
+    return total;
+}
+
+bool JsonRope::onFlush(void *context, const uint8_t *data, size_t length)
+{
+    JsonRope *rope = static_cast<JsonRope *>(context);
+    if (!rope->writer_ || !rope->last_ || data != rope->last_->data())
+    {
+        return false;
+    }
+
+    // Seal the full block and let the writer continue in a new one
+    rope->last_->length = length;
+    if (!rope->appendBlock())
+    {
+        return false;
+    }
+    rope->writer_->continueIn(rope->last_->data(), rope->blockSize_ - sizeof(JsonRopeBlock));
+    return true;
+}
+
+bool JsonRope::appendBlock()
+{
+    if (blockSize_ <= sizeof(JsonRopeBlock))
+    {
+        return false;
+    }
+
+    void *memory = allocator_.allocate(allocator_.context, blockSize_);
+    if (!memory)
+    {
+        return false;
+    }
+
+    JsonRopeBlock *block = static_cast<JsonRopeBlock *>(memory);
+    block->next = nullptr;
+    block->length = 0;
+    if (last_)
+    {
+        last_->next = block;
+    }
+    else
+    {
+        first_ = block;
+    }
+    last_ = block;
+    blockCount_++;
+    return true;
+}
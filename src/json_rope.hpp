@@ -0,0 +1,176 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "json_buffer_writer.hpp"
+
+/**
+ * @file
+ * @brief Output into a chain of fixed-size blocks for documents of unknown size.
+ *
+ * @details
+ * A `JsonRope` installs itself as the writer's flush handler. Whenever the current block
+ * is full, the writer continues in a freshly allocated block (JsonBufWriter::continueIn()),
+ * so bytes are written exactly once and never moved, unlike a growing buffer that is
+ * reallocated and copied. Long strings may span blocks; other values always start in the
+ * block that holds them whole, which can leave a few bytes unused at the end of a block.
+ *
+ * Blocks come from a `JsonBlockAllocator`: JsonBlockAllocator::heap() on hosts, or a
+ * `JsonSlabPool` carved out of static memory on MCUs without a heap. The result is read
+ * block by block (first(), JsonRopeBlock::next), e.g. for scatter/gather I/O, or copied
+ * once into contiguous memory with gather().
+ *
+ * Placeholders can only be filled while they are in the current block.
+ *
+ * ### Example
+ * @code{.cpp}
+ * alignas(void *) static uint8_t slabs[8 * 256];
+ * static JsonSlabPool pool(slabs, sizeof(slabs), 256);
+ * JsonRope rope(pool.allocator(), 256);
+ *
+ * JsonBufWriter jw(nullptr, 0);
+ * rope.attach(jw);
+ * // ... write the document ...
+ * if (rope.finish(jw)) {
+ *   for (const JsonRopeBlock *b = rope.first(); b; b = b->next) {
+ *     send(b->data(), b->length);
+ *   }
+ * }
+ * rope.clear(); // return the blocks to the pool
+ * @endcode
+ */
+
+/**
+ * @brief Source of rope blocks: two callbacks and their context.
+ *
+ * `allocate` returns `size` bytes aligned for a pointer, or `nullptr` when exhausted;
+ * `release` takes back a block returned by `allocate`.
+ */
+struct JsonBlockAllocator
+{
+    typedef void *(*AllocateFn)(void *context, size_t size);
+    typedef void (*ReleaseFn)(void *context, void *block);
+
+    AllocateFn allocate; ///< Obtain a block of the requested size.
+    ReleaseFn release;   ///< Return a block.
+    void *context;       ///< Forwarded to both callbacks.
+
+    /** @brief Allocator backed by `malloc()`/`free()`. */
+    static JsonBlockAllocator heap();
+};
+
+/**
+ * @class JsonSlabPool
+ * @brief Fixed-size blocks carved out of caller-provided memory (no heap).
+ *
+ * Blocks are handed out from a free list; requests larger than the slab size fail.
+ */
+class JsonSlabPool
+{
+public:
+    /**
+     * @brief Split @p storage into slabs.
+     * @param storage Memory for the slabs, aligned for a pointer; must outlive the pool.
+     * @param capacity Size of @p storage in bytes.
+     * @param slabSize Bytes per slab (rounded up to pointer alignment).
+     */
+    JsonSlabPool(void *storage, size_t capacity, size_t slabSize);
+
+    /** @brief Allocator handing out this pool's slabs. */
+    JsonBlockAllocator allocator();
+
+    /** @brief Slabs currently free. */
+    size_t available() const;
+
+private:
+    void *free_;       ///< First free slab; each free slab stores the next pointer.
+    size_t slabSize_;  ///< Bytes per slab.
+    size_t freeCount_; ///< Number of free slabs.
+
+    static void *allocateSlab(void *context, size_t size);
+    static void releaseSlab(void *context, void *block);
+};
+
+/**
+ * @brief One block of a rope. The payload follows the header in the same allocation.
+ */
+struct JsonRopeBlock
+{
+    JsonRopeBlock *next; ///< Following block, or `nullptr` for the last one.
+    size_t length;       ///< Payload bytes written.
+
+    /** @brief Start of the payload. */
+    uint8_t *data() { return reinterpret_cast<uint8_t *>(this + 1); }
+
+    /** @brief Start of the payload. */
+    const uint8_t *data() const { return reinterpret_cast<const uint8_t *>(this + 1); }
+};
+
+/**
+ * @class JsonRope
+ * @brief Flush handler that chains the writer's output through allocated blocks.
+ */
+class JsonRope
+{
+public:
+    /**
+     * @brief Create an empty rope.
+     * @param allocator Block source; must stay valid while the rope holds blocks.
+     * @param blockSize Bytes per allocation, including the JsonRopeBlock header.
+     */
+    JsonRope(const JsonBlockAllocator &allocator, size_t blockSize);
+
+    /** @brief Releases all blocks. */
+    ~JsonRope();
+
+    JsonRope(const JsonRope &) = delete;
+    JsonRope &operator=(const JsonRope &) = delete;
+
+    /**
+     * @brief Start a new document: release old blocks and point @p writer at a fresh block.
+     * @details Resets @p writer and installs the rope as its flush handler.
+     * @retval false No block could be allocated.
+     */
+    bool attach(JsonBufWriter &writer);
+
+    /**
+     * @brief Finalize the document and record the length of the last block.
+     * @details Removes the flush handler from @p writer.
+     * @retval true The document is complete; read it through first() or gather().
+     */
+    bool finish(JsonBufWriter &writer);
+
+    /** @brief Release all blocks back to the allocator. */
+    void clear();
+
+    /** @brief First block, or `nullptr` if empty. */
+    const JsonRopeBlock *first() const;
+
+    /** @brief Number of blocks. */
+    size_t blockCount() const;
+
+    /** @brief Total payload bytes. */
+    size_t size() const;
+
+    /**
+     * @brief Copy the document into contiguous memory.
+     * @param out Destination.
+     * @param capacity Size of @p out in bytes.
+     * @return Bytes copied, or 0 if @p capacity is smaller than size().
+     */
+    size_t gather(uint8_t *out, size_t capacity) const;
+
+    /** @brief `JsonBufWriter::FlushHandler` entry point; @p context is the rope. */
+    static bool onFlush(void *context, const uint8_t *data, size_t length);
+
+private:
+    JsonBlockAllocator allocator_; ///< Block source.
+    size_t blockSize_;             ///< Bytes per allocation.
+    JsonRopeBlock *first_;         ///< Head of the chain.
+    JsonRopeBlock *last_;          ///< Block the writer is filling.
+    size_t blockCount_;            ///< Blocks in the chain.
+    JsonBufWriter *writer_;        ///< Writer being fed (between attach() and finish()).
+
+    bool appendBlock();
+};
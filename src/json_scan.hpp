@@ -0,0 +1,274 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/**
+ * @file
+ * @brief Internal byte-scanning helpers shared by the writer and the reader.
+ *
+ * @details
+ * Scanning picks the widest implementation available at compile time:
+ * SSE2 on x86 hosts, NEON on AArch64 hosts, and 32-bit SWAR (SIMD within a
+ * register) everywhere else, which is what MCU builds use.
+ *
+ * UTF-8 decoding is table-driven following RFC 3629 / Unicode table 3-7: a 256-entry
+ * table gives the sequence length for each lead byte, and the handful of leads with a
+ * restricted second-byte range (overlongs, surrogates, > U+10FFFF) are special-cased.
+ */
+
+/// @cond INTERNAL
+namespace json_detail
+{
+    /** @brief True if byte @p c must be escaped inside a JSON string. */
+    inline bool needsEscape(uint8_t c)
+    {
+        return c < 0x20 || c == '"' || c == '\\';
+    }
+
+    /**
+     * @brief Length of the leading run of bytes that can be copied into a JSON string verbatim.
+     * @param data Bytes to scan.
+     * @param length Number of bytes in @p data.
+     * @param stopAtNonAscii Also end the run at the first byte >= 0x80.
+     * @return Number of leading bytes needing no escaping (== @p length if all are plain).
+     */
+    inline size_t scanPlain(const uint8_t *data, size_t length, bool stopAtNonAscii)
+    {
+        size_t i = 0;
+
+#if defined(__SSE2__)
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control = _mm_set1_epi8(0x1F);
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            __m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash));
+            // Unsigned v <= 0x1F  <=>  max(v, 0x1F) == 0x1F
+            special = _mm_or_si128(special, _mm_cmpeq_epi8(_mm_max_epu8(v, control), control));
+            int mask = _mm_movemask_epi8(special);
+            if (stopAtNonAscii)
+            {
+                mask |= _mm_movemask_epi8(v);
+            }
+            if (mask != 0)
+            {
+                return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+            }
+        }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+        const uint8x16_t quote = vdupq_n_u8('"');
+        const uint8x16_t backslash = vdupq_n_u8('\\');
+        const uint8x16_t control = vdupq_n_u8(0x20);
+        const uint8x16_t high = vdupq_n_u8(stopAtNonAscii ? 0x80 : 0x00);
+        for (; i + 16 <= length; i += 16)
+        {
+            uint8x16_t v = vld1q_u8(data + i);
+            uint8x16_t special = vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash));
+            special = vorrq_u8(special, vcltq_u8(v, control));
+            special = vorrq_u8(special, vtstq_u8(v, high));
+            if (vmaxvq_u8(special) != 0)
+            {
+                break; // Locate the exact byte with the scalar tail below
+            }
+        }
+#else
+        // SWAR: test four bytes per step; the has-less/has-zero tricks are exact as booleans
+        const uint32_t ones = 0x01010101u;
+        const uint32_t highs = 0x80808080u;
+        for (; i + 4 <= length; i += 4)
+        {
+            uint32_t word;
+            memcpy(&word, data + i, sizeof(word));
+            uint32_t q = word ^ (ones * '"');
+            uint32_t b = word ^ (ones * '\\');
+            uint32_t special = ((word - ones * 0x20) & ~word) |
+                               ((q - ones) & ~q) |
+                               ((b - ones) & ~b);
+            if (stopAtNonAscii)
+            {
+                special |= word;
+            }
+            if ((special & highs) != 0)
+            {
+                break;
+            }
+        }
+#endif
+
+        for (; i < length; ++i)
+        {
+            uint8_t c = data[i];
+            if (needsEscape(c) || (stopAtNonAscii && c >= 0x80))
+            {
+                return i;
+            }
+        }
+        return length;
+    }
+
+    /** @brief True if byte @p c is insignificant whitespace between JSON tokens. */
+    inline bool isWhitespace(uint8_t c)
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    /**
+     * @brief Length of the leading run of JSON whitespace.
+     * @details Most gaps between tokens are empty or a single byte, so the first byte is
+     *          tested before the vector loop; the loop pays off on indentation.
+     * @param data Bytes to scan.
+     * @param length Number of bytes in @p data.
+     * @return Number of leading whitespace bytes (== @p length if all are whitespace).
+     */
+    inline size_t scanWhitespace(const uint8_t *data, size_t length)
+    {
+        if (length == 0 || !isWhitespace(data[0]))
+        {
+            return 0;
+        }
+        size_t i = 1;
+
+#if defined(__SSE2__)
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i newline = _mm_set1_epi8('\n');
+        const __m128i carriage = _mm_set1_epi8('\r');
+        const __m128i tab = _mm_set1_epi8('\t');
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, newline));
+            ws = _mm_or_si128(ws, _mm_or_si128(_mm_cmpeq_epi8(v, carriage), _mm_cmpeq_epi8(v, tab)));
+            unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(ws)) & 0xFFFFu;
+            if (mask != 0)
+            {
+                return i + static_cast<size_t>(__builtin_ctz(mask));
+            }
+        }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+        const uint8x16_t space = vdupq_n_u8(' ');
+        const uint8x16_t newline = vdupq_n_u8('\n');
+        const uint8x16_t carriage = vdupq_n_u8('\r');
+        const uint8x16_t tab = vdupq_n_u8('\t');
+        for (; i + 16 <= length; i += 16)
+        {
+            uint8x16_t v = vld1q_u8(data + i);
+            uint8x16_t ws = vorrq_u8(vceqq_u8(v, space), vceqq_u8(v, newline));
+            ws = vorrq_u8(ws, vorrq_u8(vceqq_u8(v, carriage), vceqq_u8(v, tab)));
+            if (vminvq_u8(ws) == 0)
+            {
+                break; // Locate the exact byte with the scalar tail below
+            }
+        }
+#else
+        // SWAR: indentation is runs of spaces, so skip whole words of them
+        const uint32_t spaces = 0x20202020u;
+        for (; i + 4 <= length; i += 4)
+        {
+            uint32_t word;
+            memcpy(&word, data + i, sizeof(word));
+            if (word != spaces)
+            {
+                break;
+            }
+        }
+#endif
+
+        while (i < length && isWhitespace(data[i]))
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    /**
+     * @brief Expected UTF-8 sequence length by lead byte (0 = never valid as a lead).
+     * @details 0x80-0xBF are continuation bytes, 0xC0/0xC1 would be overlong, 0xF5+ exceed U+10FFFF.
+     */
+    inline uint8_t utf8SequenceLength(uint8_t lead)
+    {
+        static const uint8_t table[256] = {
+            // 0x00-0x7F: ASCII
+            1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+            1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+            1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+            1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+            // 0x80-0xBF: continuation bytes
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            // 0xC0-0xDF: two-byte leads (0xC0, 0xC1 overlong)
+            0, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+            // 0xE0-0xEF: three-byte leads
+            3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+            // 0xF0-0xFF: four-byte leads (0xF5+ invalid)
+            4, 4, 4, 4, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+        return table[lead];
+    }
+
+    /**
+     * @brief Decode one UTF-8 sequence.
+     * @param data Bytes starting at a non-ASCII byte.
+     * @param length Bytes available in @p data (>= 1).
+     * @param[out] codePoint Decoded scalar value on success.
+     * @param[out] consumed Bytes making up the sequence on success, or the length of the
+     *             maximal ill-formed subpart (>= 1) on failure.
+     * @return true if a well-formed sequence was decoded.
+     */
+    inline bool decodeUtf8(const uint8_t *data, size_t length, uint32_t &codePoint, size_t &consumed)
+    {
+        uint8_t lead = data[0];
+        size_t expected = utf8SequenceLength(lead);
+        consumed = 1;
+        if (expected == 1)
+        {
+            codePoint = lead;
+            return true;
+        }
+        if (expected == 0)
+        {
+            return false;
+        }
+
+        // Allowed range of the second byte (Unicode table 3-7)
+        uint8_t low = 0x80;
+        uint8_t high = 0xBF;
+        switch (lead)
+        {
+        case 0xE0: low = 0xA0; break; // Overlong
+        case 0xED: high = 0x9F; break; // UTF-16 surrogates
+        case 0xF0: low = 0x90; break; // Overlong
+        case 0xF4: high = 0x8F; break; // Beyond U+10FFFF
+        default: break;
+        }
+
+        uint32_t cp = lead & (0x7Fu >> expected);
+        for (size_t i = 1; i < expected; ++i)
+        {
+            if (i >= length)
+            {
+                return false;
+            }
+            uint8_t c = data[i];
+            if (c < low || c > high)
+            {
+                return false;
+            }
+            low = 0x80;
+            high = 0xBF;
+            cp = (cp << 6) | (c & 0x3Fu);
+            consumed = i + 1;
+        }
+
+        codePoint = cp;
+        return true;
+    }
+}
+/// @endcond
@@ -0,0 +1,473 @@
+#include "json_uring_sink.hpp"
+
+#if defined(JSON_BUF_WRITER_HAS_IO_URING)
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace
+{
+    // Raw system calls, so the library does not depend on liburing
+    int uringSetup(unsigned entries, io_uring_params *params)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int uringEnter(int ring, unsigned submit, unsigned minComplete, unsigned flags)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_enter, ring, submit, minComplete, flags, nullptr, 0));
+    }
+
+    int uringRegister(int ring, unsigned opcode, const void *arg, unsigned count)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_register, ring, opcode, arg, count));
+    }
+
+    uint32_t *ringField(void *ring, uint32_t offset)
+    {
+        return reinterpret_cast<uint32_t *>(static_cast<uint8_t *>(ring) + offset);
+    }
+}
+
+JsonUringSink::JsonUringSink(uint8_t *storage, size_t bufferSize, uint8_t bufferCount)
+    : storage_(storage), bufferSize_(bufferSize), bufferCount_(bufferCount), current_(0), sequence_(0), slots_(),
+      fd_(-1), seekable_(false), offset_(0), written_(0), failed_(false), writer_(nullptr), ringFd_(-1), fixed_(false),
+      sqRing_(nullptr), sqRingSize_(0), cqRing_(nullptr), cqRingSize_(0), sqes_(nullptr), sqesSize_(0),
+      sqTail_(nullptr), sqMask_(0), sqArray_(nullptr), cqHead_(nullptr), cqTail_(nullptr), cqMask_(0),
+      cqes_(nullptr)
+{
+}
+
+JsonUringSink::~JsonUringSink()
+{
+    close();
+}
+
+bool JsonUringSink::open(int fd, JsonBufWriter &writer, bool useUring)
+{
+    close();
+    if (!storage_ || bufferSize_ == 0 || bufferCount_ < 2 || bufferCount_ > MAX_BUFFERS)
+    {
+        return false;
+    }
+
+    fd_ = fd;
+    const off_t position = lseek(fd, 0, SEEK_CUR);
+    seekable_ = position >= 0;
+    offset_ = seekable_ ? static_cast<uint64_t>(position) : 0;
+    written_ = 0;
+    failed_ = false;
+    current_ = 0;
+    sequence_ = 0;
+    for (uint8_t i = 0; i < bufferCount_; ++i)
+    {
+        slots_[i] = Slot();
+    }
+    if (useUring)
+    {
+        setupRing(); // Falls back to blocking writes on failure
+    }
+
+    writer_ = &writer;
+    writer.reset(bufferAt(0), bufferSize_);
+    writer.setFlushHandler(&JsonUringSink::onFlush, this);
+    return true;
+}
+
+bool JsonUringSink::finish(JsonBufWriter &writer)
+{
+    // Without the handler, finalize() leaves the tail in the current buffer
+    writer.setFlushHandler(nullptr, nullptr);
+    writer_ = nullptr;
+    if (fd_ < 0)
+    {
+        return false;
+    }
+
+    const uint8_t *output;
+    size_t length;
+    bool complete = writer.finalize(output, length);
+    if (complete && length != 0)
+    {
+        if (ringFd_ >= 0)
+        {
+            queue(current_, length);
+        }
+        else
+        {
+            complete = writeBlocking(output, length);
+        }
+    }
+    drain(true);
+
+    // Leave the file position after the document, as write() would
+    if (seekable_)
+    {
+        lseek(fd_, static_cast<off_t>(offset_), SEEK_SET);
+    }
+    closeRing();
+    fd_ = -1;
+    return complete && !failed_;
+}
+
+void JsonUringSink::close()
+{
+    if (writer_)
+    {
+        writer_->setFlushHandler(nullptr, nullptr);
+        writer_ = nullptr;
+    }
+    drain(false);
+    closeRing();
+    fd_ = -1;
+}
+
+bool JsonUringSink::isAsync() const
+{
+    return ringFd_ >= 0;
+}
+
+bool JsonUringSink::ok() const
+{
+    return !failed_;
+}
+
+size_t JsonUringSink::written() const
+{
+    return written_;
+}
+
+bool JsonUringSink::onFlush(void *context, const uint8_t *data, size_t length)
+{
+    JsonUringSink *sink = static_cast<JsonUringSink *>(context);
+    if (!sink->writer_ || data != sink->bufferAt(sink->current_) || sink->failed_)
+    {
+        return false;
+    }
+
+    if (sink->ringFd_ < 0)
+    {
+        // Blocking fallback: the buffer is free again once write() returns
+        if (!sink->writeBlocking(data, length))
+        {
+            return false;
+        }
+        sink->writer_->continueIn(sink->bufferAt(sink->current_), sink->bufferSize_);
+        return true;
+    }
+
+    sink->queue(sink->current_, length);
+    sink->current_ = static_cast<uint8_t>((sink->current_ + 1) % sink->bufferCount_);
+
+    // Only block when the writer has caught up with the oldest write
+    sink->reap();
+    while (sink->slots_[sink->current_].state != SLOT_FREE)
+    {
+        if (!sink->waitForCompletion())
+        {
+            return false;
+        }
+        sink->reap();
+    }
+    if (sink->failed_)
+    {
+        return false;
+    }
+
+    sink->writer_->continueIn(sink->bufferAt(sink->current_), sink->bufferSize_);
+    return true;
+}
+
+uint8_t *JsonUringSink::bufferAt(uint8_t index) const
+{
+    return storage_ + index * bufferSize_;
+}
+
+bool JsonUringSink::setupRing()
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ringFd_ = uringSetup(bufferCount_, &params);
+    if (ringFd_ < 0)
+    {
+        ringFd_ = -1;
+        return false;
+    }
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && cqRingSize_ > sqRingSize_)
+    {
+        sqRingSize_ = cqRingSize_;
+    }
+
+    void *sq = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_,
+                    IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED)
+    {
+        closeRing();
+        return false;
+    }
+    sqRing_ = sq;
+
+    if (single)
+    {
+        cqRing_ = sqRing_;
+    }
+    else
+    {
+        void *cq = mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_,
+                        IORING_OFF_CQ_RING);
+        if (cq == MAP_FAILED)
+        {
+            closeRing();
+            return false;
+        }
+        cqRing_ = cq;
+    }
+
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_,
+                      IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        closeRing();
+        return false;
+    }
+    sqes_ = sqes;
+
+    sqTail_ = ringField(sqRing_, params.sq_off.tail);
+    sqMask_ = *ringField(sqRing_, params.sq_off.ring_mask);
+    sqArray_ = ringField(sqRing_, params.sq_off.array);
+    cqHead_ = ringField(cqRing_, params.cq_off.head);
+    cqTail_ = ringField(cqRing_, params.cq_off.tail);
+    cqMask_ = *ringField(cqRing_, params.cq_off.ring_mask);
+    cqes_ = static_cast<uint8_t *>(cqRing_) + params.cq_off.cqes;
+
+    // Registered buffers save the kernel from pinning the pages on every write
+    struct iovec iov[MAX_BUFFERS];
+    for (uint8_t i = 0; i < bufferCount_; ++i)
+    {
+        iov[i].iov_base = bufferAt(i);
+        iov[i].iov_len = bufferSize_;
+    }
+    fixed_ = uringRegister(ringFd_, IORING_REGISTER_BUFFERS, iov, bufferCount_) == 0;
+    return true;
+}
+
+void JsonUringSink::closeRing()
+{
+    if (sqes_)
+    {
+        munmap(sqes_, sqesSize_);
+    }
+    if (cqRing_ && cqRing_ != sqRing_)
+    {
+        munmap(cqRing_, cqRingSize_);
+    }
+    if (sqRing_)
+    {
+        munmap(sqRing_, sqRingSize_);
+    }
+    if (ringFd_ >= 0)
+    {
+        ::close(ringFd_); // Also drops the buffer registration
+    }
+    ringFd_ = -1;
+    fixed_ = false;
+    sqRing_ = nullptr;
+    cqRing_ = nullptr;
+    sqes_ = nullptr;
+}
+
+bool JsonUringSink::writeBlocking(const uint8_t *data, size_t length)
+{
+    size_t done = 0;
+    while (done < length)
+    {
+        const ssize_t result = seekable_ ? pwrite(fd_, data + done, length - done, static_cast<off_t>(offset_ + done))
+                                         : write(fd_, data + done, length - done);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result <= 0)
+        {
+            failed_ = true;
+            return false;
+        }
+        done += static_cast<size_t>(result);
+    }
+    offset_ += length;
+    written_ += length;
+    return true;
+}
+
+void JsonUringSink::queue(uint8_t index, size_t length)
+{
+    Slot &slot = slots_[index];
+    slot.offset = offset_;
+    slot.length = length;
+    slot.done = 0;
+    slot.sequence = sequence_++;
+    slot.state = SLOT_QUEUED;
+    offset_ += length;
+    submitQueued();
+}
+
+void JsonUringSink::submitQueued()
+{
+    int oldest = -1;
+    for (uint8_t i = 0; i < bufferCount_ && !failed_; ++i)
+    {
+        if (slots_[i].state == SLOT_IN_FLIGHT && !seekable_)
+        {
+            return; // Streams are written strictly in order, one request at a time
+        }
+        if (slots_[i].state != SLOT_QUEUED)
+        {
+            continue;
+        }
+        if (seekable_)
+        {
+            submit(i); // Files: every buffer at its own offset, concurrently
+        }
+        else if (oldest < 0 || slots_[i].sequence - slots_[oldest].sequence > UINT32_MAX / 2)
+        {
+            oldest = i;
+        }
+    }
+    if (oldest >= 0 && !failed_)
+    {
+        submit(static_cast<uint8_t>(oldest));
+    }
+}
+
+bool JsonUringSink::submit(uint8_t index)
+{
+    Slot &slot = slots_[index];
+    const uint32_t tail = *sqTail_;
+    const uint32_t entry = tail & sqMask_;
+    io_uring_sqe *sqe = static_cast<io_uring_sqe *>(sqes_) + entry;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = fixed_ ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe->fd = fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(bufferAt(index) + slot.done);
+    sqe->len = static_cast<uint32_t>(slot.length - slot.done);
+    sqe->off = seekable_ ? slot.offset + slot.done : static_cast<uint64_t>(-1); // -1: current position
+    sqe->buf_index = fixed_ ? index : 0;
+    sqe->user_data = index;
+    sqArray_[entry] = entry;
+    __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+
+    int result;
+    do
+    {
+        result = uringEnter(ringFd_, 1, 0, 0);
+    } while (result < 0 && errno == EINTR);
+    if (result != 1)
+    {
+        failed_ = true;
+        slot.state = SLOT_FREE;
+        return false;
+    }
+    slot.state = SLOT_IN_FLIGHT;
+    return true;
+}
+
+void JsonUringSink::reap()
+{
+    uint32_t head = *cqHead_;
+    const uint32_t tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head)
+    {
+        const io_uring_cqe *cqe = static_cast<const io_uring_cqe *>(cqes_) + (head & cqMask_);
+        Slot &slot = slots_[cqe->user_data];
+        if (cqe->res <= 0)
+        {
+            failed_ = true;
+            slot.state = SLOT_FREE;
+            continue;
+        }
+
+        slot.done += static_cast<size_t>(cqe->res);
+        written_ += static_cast<size_t>(cqe->res);
+        slot.state = slot.done < slot.length ? SLOT_QUEUED : SLOT_FREE; // Short write: resubmit the rest
+    }
+    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+
+    if (failed_)
+    {
+        // Nothing more is submitted; queued buffers are discarded
+        for (uint8_t i = 0; i < bufferCount_; ++i)
+        {
+            if (slots_[i].state == SLOT_QUEUED)
+            {
+                slots_[i].state = SLOT_FREE;
+            }
+        }
+    }
+    submitQueued();
+}
+
+bool JsonUringSink::waitForCompletion()
+{
+    int result;
+    do
+    {
+        result = uringEnter(ringFd_, 0, 1, IORING_ENTER_GETEVENTS);
+    } while (result < 0 && errno == EINTR);
+    if (result < 0)
+    {
+        failed_ = true;
+        return false;
+    }
+    return true;
+}
+
+void JsonUringSink::drain(bool submitQueuedSlots)
+{
+    if (ringFd_ < 0)
+    {
+        return;
+    }
+
+    if (!submitQueuedSlots)
+    {
+        for (uint8_t i = 0; i < bufferCount_; ++i)
+        {
+            if (slots_[i].state == SLOT_QUEUED)
+            {
+                slots_[i].state = SLOT_FREE;
+            }
+        }
+    }
+
+    // The kernel may still read from the buffers: wait for every request in flight
+    for (;;)
+    {
+        reap();
+        bool busy = false;
+        for (uint8_t i = 0; i < bufferCount_; ++i)
+        {
+            busy = busy || slots_[i].state != SLOT_FREE;
+        }
+        if (!busy)
+        {
+            return;
+        }
+
+        if (!waitForCompletion())
+        {
+            return;
+        }
+    }
+}
+
+#endif // JSON_BUF_WRITER_HAS_IO_URING
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "json_buffer_writer.hpp"
+
+/**
+ * @file
+ * @brief Asynchronous flushing of writer buffers through io_uring (Linux).
+ *
+ * @details
+ * `JsonUringSink` owns a small ring of equally sized buffers carved out of caller memory.
+ * Installed as the writer's flush handler, it queues each filled buffer as a write
+ * request and lets the writer continue at once in the next buffer of the ring
+ * (JsonBufWriter::continueIn()). Completions are reaped on later flushes; the serializing
+ * thread only waits when every buffer is still being written.
+ *
+ * The buffers are registered with the kernel (`IORING_OP_WRITE_FIXED`), so it does not
+ * have to map them for every request. For seekable files all queued buffers are written
+ * concurrently at their own offsets; for pipes and sockets they are written one at a time,
+ * in order. Short writes are resubmitted.
+ *
+ * When io_uring cannot be set up (old kernel, seccomp policy, or `useUring == false`),
+ * the sink falls back to blocking `write()` calls from the flush handler, so callers do
+ * not need a separate path. isAsync() tells which one is in use.
+ *
+ * Placeholders can only be filled until their buffer has been flushed.
+ *
+ * Only available on Linux with io_uring headers (`JSON_BUF_WRITER_HAS_IO_URING`).
+ *
+ * ### Example
+ * @code{.cpp}
+ * static uint8_t buffers[4 * 16384];
+ * JsonUringSink sink(buffers, 16384, 4);
+ * JsonBufWriter jw(nullptr, 0);
+ * jw.setJsonLines(true);
+ * sink.open(logFd, jw);
+ * // ... write records; full buffers are written in the background ...
+ * bool complete = sink.finish(jw); // waits for the outstanding writes
+ * @endcode
+ */
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define JSON_BUF_WRITER_HAS_IO_URING 1
+#endif
+#endif
+
+#if defined(JSON_BUF_WRITER_HAS_IO_URING)
+
+/**
+ * @class JsonUringSink
+ * @brief Flush handler that rotates the writer through a ring of buffers written by io_uring.
+ */
+class JsonUringSink
+{
+public:
+    static constexpr uint8_t MAX_BUFFERS = 16; ///< Upper bound for the ring size.
+
+    /**
+     * @brief Create a closed sink.
+     * @param storage Memory for the buffers (`bufferSize * bufferCount` bytes); must
+     *                outlive the sink.
+     * @param bufferSize Bytes per buffer.
+     * @param bufferCount Buffers in the ring, 2 to #MAX_BUFFERS.
+     */
+    JsonUringSink(uint8_t *storage, size_t bufferSize, uint8_t bufferCount);
+
+    /** @brief Waits for outstanding writes and closes the ring (see close()). */
+    ~JsonUringSink();
+
+    JsonUringSink(const JsonUringSink &) = delete;
+    JsonUringSink &operator=(const JsonUringSink &) = delete;
+
+    /**
+     * @brief Start writing to @p fd and point @p writer at the first buffer.
+     * @details Resets @p writer and installs the sink as its flush handler. Seekable
+     *          files are written from their current position, which is advanced past the
+     *          document by finish(). The sink does not take ownership of @p fd.
+     * @param fd Open file, pipe or socket.
+     * @param writer Writer to feed.
+     * @param useUring Set to `false` to force blocking writes.
+     * @retval false Invalid configuration (no buffers, or too many).
+     */
+    bool open(int fd, JsonBufWriter &writer, bool useUring = true);
+
+    /**
+     * @brief Finalize the document, write the tail and wait for all writes.
+     * @details Removes the flush handler from @p writer and closes the ring.
+     * @retval true The document is complete and every byte was written.
+     */
+    bool finish(JsonBufWriter &writer);
+
+    /**
+     * @brief Stop without finalizing: wait for writes in progress and close the ring.
+     * @details Buffers that were queued but not yet submitted are discarded.
+     */
+    void close();
+
+    /** @brief Whether writes go through io_uring (false: blocking fallback). */
+    bool isAsync() const;
+
+    /** @brief Whether every completed write so far succeeded. */
+    bool ok() const;
+
+    /** @brief Bytes written to the file descriptor so far. */
+    size_t written() const;
+
+    /** @brief `JsonBufWriter::FlushHandler` entry point; @p context is the sink. */
+    static bool onFlush(void *context, const uint8_t *data, size_t length);
+
+private:
+    enum SlotState : uint8_t
+    {
+        SLOT_FREE,     ///< Available to the writer.
+        SLOT_QUEUED,   ///< Filled, waiting to be submitted.
+        SLOT_IN_FLIGHT ///< Submitted, waiting for its completion.
+    };
+
+    /** @brief Bookkeeping for one buffer of the ring. */
+    struct Slot
+    {
+        uint64_t offset;   ///< File offset of the first byte (seekable files).
+        size_t length;     ///< Bytes to write.
+        size_t done;       ///< Bytes already written.
+        uint32_t sequence; ///< Queue order, for in-order writes to streams.
+        SlotState state;   ///< Where the buffer is in its cycle.
+    };
+
+    uint8_t *storage_;        ///< Buffer memory.
+    size_t bufferSize_;       ///< Bytes per buffer.
+    uint8_t bufferCount_;     ///< Buffers in the ring.
+    uint8_t current_;         ///< Buffer the writer is filling.
+    uint32_t sequence_;       ///< Sequence number of the next queued buffer.
+    Slot slots_[MAX_BUFFERS]; ///< State of every buffer.
+
+    int fd_;                ///< Output descriptor, or -1.
+    bool seekable_;         ///< Writes carry explicit offsets and may run concurrently.
+    uint64_t offset_;       ///< Offset of the next buffer to queue.
+    size_t written_;        ///< Bytes completed.
+    bool failed_;           ///< A write failed.
+    JsonBufWriter *writer_; ///< Writer being fed (between open() and finish()).
+
+    // io_uring instance (ringFd_ < 0 in blocking mode)
+    int ringFd_;            ///< io_uring file descriptor.
+    bool fixed_;            ///< Buffers are registered (WRITE_FIXED).
+    void *sqRing_;          ///< Submission ring mapping.
+    size_t sqRingSize_;     ///< Bytes mapped for sqRing_.
+    void *cqRing_;          ///< Completion ring mapping (may equal sqRing_).
+    size_t cqRingSize_;     ///< Bytes mapped for cqRing_.
+    void *sqes_;            ///< Submission queue entries.
+    size_t sqesSize_;       ///< Bytes mapped for sqes_.
+    uint32_t *sqTail_;      ///< Submission ring tail (owned by us).
+    uint32_t sqMask_;       ///< Submission ring index mask.
+    uint32_t *sqArray_;     ///< Submission ring index array.
+    uint32_t *cqHead_;      ///< Completion ring head (owned by us).
+    uint32_t *cqTail_;      ///< Completion ring tail (owned by the kernel).
+    uint32_t cqMask_;       ///< Completion ring index mask.
+    void *cqes_;            ///< Completion queue entries.
+
+    uint8_t *bufferAt(uint8_t index) const;
+    bool setupRing();
+    void closeRing();
+    bool writeBlocking(const uint8_t *data, size_t length);
+    void queue(uint8_t index, size_t length);
+    void submitQueued();
+    bool submit(uint8_t index);
+    void reap();
+    bool waitForCompletion();
+    void drain(bool submitQueuedSlots);
+};
+
+#endif // JSON_BUF_WRITER_HAS_IO_URING
@@ -0,0 +1,860 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <time.h>
+#include "../../src/json_buffer_writer.hpp"
+#include "../../src/json_checksum.hpp"
+#include "../../src/json_compressor.hpp"
+#include "../../src/json_reader.hpp"
+#include "../../src/json_record_serializer.hpp"
+
+// Throughput benchmarks. Results are reported with TEST_MESSAGE; run with `pio test -e bench -v`.
+// Build the same suite with `-e bench_header_only` to compare speed and the flash size printed by the build.
+
+constexpr size_t BUFFER_SIZE = 1024;
+static uint8_t benchBuffer[BUFFER_SIZE];
+
+#if defined(JSON_BUF_WRITER_HEADER_ONLY)
+static const char *CONFIGURATION = "header-only";
+#else
+static const char *CONFIGURATION = "out-of-line";
+#endif
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void report(const char *name, unsigned long elapsedMicros, unsigned long iterations, size_t bytesPerIteration)
+{
+    char message[160];
+    double perIteration = static_cast<double>(elapsedMicros) / static_cast<double>(iterations);
+    double megabytesPerSecond = elapsedMicros ? static_cast<double>(bytesPerIteration) * iterations / elapsedMicros : 0.0;
+    snprintf(message, sizeof(message), "[%s] %s: %.3f us/iter, %u bytes/iter, %.2f MB/s",
+             CONFIGURATION, name, perIteration, static_cast<unsigned>(bytesPerIteration), megabytesPerSecond);
+    TEST_MESSAGE(message);
+}
+
+// Representative telemetry frame: scalars, a short string and a small float array
+static void writeTelemetryFrame(JsonBufWriter &jw, uint32_t sequence)
+{
+    jw.beginObject();
+    jw.key("seq");
+    jw.value(sequence);
+    jw.key("device");
+    jw.value("pump-station-07");
+    jw.key("online");
+    jw.value(true);
+    jw.key("uptime");
+    jw.value(static_cast<uint64_t>(1234567890ULL + sequence));
+    jw.key("rssi");
+    jw.value(static_cast<int32_t>(-67));
+    jw.key("error");
+    jw.null();
+    jw.key("samples");
+    jw.beginArray();
+    for (int i = 0; i < 8; ++i)
+    {
+        jw.value(static_cast<int32_t>(sequence * 31 + i * 977));
+    }
+    jw.endArray();
+    jw.key("temps");
+    jw.beginArray();
+    for (int i = 0; i < 4; ++i)
+    {
+        jw.value(20.0f + 0.125f * i);
+    }
+    jw.endArray();
+    jw.endObject();
+}
+
+static size_t writeTelemetry(JsonBufWriter &jw, uint32_t sequence)
+{
+    jw.reset(benchBuffer, BUFFER_SIZE);
+    writeTelemetryFrame(jw, sequence);
+    return jw.size();
+}
+
+void test_bench_telemetry_document()
+{
+    JsonBufWriter jw(benchBuffer, BUFFER_SIZE);
+    const unsigned long iterations = 2000;
+
+    size_t bytes = 0;
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        bytes = writeTelemetry(jw, i);
+    }
+    unsigned long elapsed = micros() - start;
+
+    TEST_ASSERT_TRUE(jw.ok());
+    report("telemetry document", elapsed, iterations, bytes);
+}
+
+void test_bench_integer_array()
+{
+    JsonBufWriter jw(benchBuffer, BUFFER_SIZE);
+    const unsigned long iterations = 2000;
+
+    size_t bytes = 0;
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.beginArray();
+        for (uint32_t v = 0; v < 64; ++v)
+        {
+            jw.value(v * 2654435761u);
+        }
+        jw.endArray();
+        bytes = jw.size();
+    }
+    unsigned long elapsed = micros() - start;
+
+    TEST_ASSERT_TRUE(jw.ok());
+    report("64 x uint32 array", elapsed, iterations, bytes);
+}
+
+// Same 64 integers from an array: array() decides only the separator per element
+void test_bench_integer_array_range()
+{
+    static uint32_t values[64];
+    for (uint32_t v = 0; v < 64; ++v)
+    {
+        values[v] = v * 2654435761u;
+    }
+    JsonBufWriter jw(benchBuffer, BUFFER_SIZE);
+    const unsigned long iterations = 2000;
+
+    size_t bytes = 0;
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.array(values);
+        bytes = jw.size();
+    }
+    unsigned long elapsed = micros() - start;
+
+    TEST_ASSERT_TRUE(jw.ok());
+    report("64 x uint32 array, array()", elapsed, iterations, bytes);
+}
+
+// Decimal vs. scaled-integer floats; the scaled form skips snprintf()
+static void benchFloatArray(JsonBufWriter::FloatFormat format, const char *name)
+{
+    static float values[64];
+    for (uint32_t v = 0; v < 64; ++v)
+    {
+        values[v] = 20.0f + static_cast<float>((v * 2654435761u) % 10000) / 1000.0f - 5.0f;
+    }
+    JsonBufWriter jw(benchBuffer, BUFFER_SIZE);
+    const unsigned long iterations = 2000;
+
+    size_t bytes = 0;
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.setFloatFormat(format);
+        jw.array(values);
+        bytes = jw.size();
+    }
+    unsigned long elapsed = micros() - start;
+
+    TEST_ASSERT_TRUE(jw.ok());
+    report(name, elapsed, iterations, bytes);
+}
+
+void test_bench_float_array_decimal()
+{
+    benchFloatArray(JsonBufWriter::FloatFormat::Decimal, "64 x float array, decimal");
+}
+
+void test_bench_float_array_scaled()
+{
+    benchFloatArray(JsonBufWriter::FloatFormat::ScaledInteger, "64 x float array, scaled integers");
+}
+
+// 100 records of {"t":uint32,"v":float}: array of objects vs. one object of columns
+struct BatchSample
+{
+    uint32_t t;
+    float v;
+};
+
+static void benchBatch(bool columns, const char *name)
+{
+    static BatchSample samples[100];
+    static uint8_t batchBuffer[4096];
+    static JsonRecordField batchFields[] = {
+        {"t", offsetof(BatchSample, t), JsonFieldType::UInt32},
+        {"v", offsetof(BatchSample, v), JsonFieldType::Float},
+    };
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        samples[i].t = 1700000000u + i * 10;
+        samples[i].v = 20.0f + static_cast<float>((i * 2654435761u) % 1000) / 100.0f;
+    }
+    char keys[16];
+    JsonRecordSerializer serializer(batchFields, 2);
+    TEST_ASSERT_TRUE(serializer.compile(keys, sizeof(keys)));
+    JsonBufWriter jw(batchBuffer, sizeof(batchBuffer));
+    const unsigned long iterations = 500;
+
+    size_t bytes = 0;
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(batchBuffer, sizeof(batchBuffer));
+        jw.setFloatPrecision(2);
+        columns ? serializer.writeColumns(jw, samples, 100, sizeof(BatchSample))
+                : serializer.writeArray(jw, samples, 100, sizeof(BatchSample));
+        bytes = jw.size();
+    }
+    unsigned long elapsed = micros() - start;
+
+    TEST_ASSERT_TRUE(jw.ok());
+    report(name, elapsed, iterations, bytes);
+}
+
+void test_bench_batch_rows()
+{
+    benchBatch(false, "100 records, array of objects");
+}
+
+void test_bench_batch_columns()
+{
+    benchBatch(true, "100 records, columns");
+}
+
+void test_bench_bool_null_array()
+{
+    JsonBufWriter jw(benchBuffer, BUFFER_SIZE);
+    const unsigned long iterations = 2000;
+
+    size_t bytes = 0;
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.beginArray();
+        for (int v = 0; v < 64; ++v)
+        {
+            if (v % 3 == 0)
+            {
+                jw.null();
+            }
+            else
+            {
+                jw.value((v & 1) != 0);
+            }
+        }
+        jw.endArray();
+        bytes = jw.size();
+    }
+    unsigned long elapsed = micros() - start;
+
+    TEST_ASSERT_TRUE(jw.ok());
+    report("64 x bool/null array", elapsed, iterations, bytes);
+}
+
+static void benchStrings(const char *name, JsonBufWriter::Utf8Mode mode, bool asciiOnly)
+{
+    static const char *text = "Sensor \xC3\xA9tat nominal; pressure within limits, valve #3 closed \xE2\x9C\x93";
+    JsonBufWriter jw(benchBuffer, BUFFER_SIZE);
+    jw.setUtf8Mode(mode);
+    jw.setAsciiOnly(asciiOnly);
+    const unsigned long iterations = 2000;
+
+    size_t bytes = 0;
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.beginArray();
+        for (int v = 0; v < 8; ++v)
+        {
+            jw.value(text);
+        }
+        jw.endArray();
+        bytes = jw.size();
+    }
+    unsigned long elapsed = micros() - start;
+
+    TEST_ASSERT_TRUE(jw.ok());
+    report(name, elapsed, iterations, bytes);
+}
+
+void test_bench_strings_passthrough()
+{
+    benchStrings("8 x string, passthrough", JsonBufWriter::Utf8Mode::Passthrough, false);
+}
+
+void test_bench_strings_validated()
+{
+    benchStrings("8 x string, UTF-8 validated", JsonBufWriter::Utf8Mode::Reject, false);
+}
+
+void test_bench_strings_ascii_only()
+{
+    benchStrings("8 x string, ASCII-only", JsonBufWriter::Utf8Mode::Replace, true);
+}
+
+void test_bench_token_keys()
+{
+    static const char *names[] = {"temperature", "humidity", "pressure", "battery_voltage"};
+    static JsonToken keys[4];
+    static JsonToken state("nominal");
+    for (int k = 0; k < 4; ++k)
+    {
+        keys[k].assign(names[k], strlen(names[k]), JsonToken::Kind::Key);
+    }
+
+    JsonBufWriter jw(benchBuffer, BUFFER_SIZE);
+    const unsigned long iterations = 2000;
+
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.beginObject();
+        for (int k = 0; k < 4; ++k)
+        {
+            jw.key(names[k]);
+            jw.value("nominal");
+        }
+        jw.endObject();
+    }
+    unsigned long elapsed = micros() - start;
+    TEST_ASSERT_TRUE(jw.ok());
+    report("4 x key/value from strings", elapsed, iterations, jw.size());
+
+    start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.beginObject();
+        for (int k = 0; k < 4; ++k)
+        {
+            jw.key(keys[k]);
+            jw.value(state);
+        }
+        jw.endObject();
+    }
+    elapsed = micros() - start;
+    TEST_ASSERT_TRUE(jw.ok());
+    report("4 x key/value from tokens", elapsed, iterations, jw.size());
+}
+
+void test_bench_embed_cached_object()
+{
+    static uint8_t cached[BUFFER_SIZE];
+    JsonBufWriter child(cached, sizeof(cached));
+    writeTelemetryFrame(child, 7);
+
+    JsonBufWriter jw(benchBuffer, BUFFER_SIZE);
+    const unsigned long iterations = 2000;
+
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.beginArray();
+        for (int k = 0; k < 3; ++k)
+        {
+            writeTelemetryFrame(jw, 7);
+        }
+        jw.endArray();
+    }
+    unsigned long elapsed = micros() - start;
+    TEST_ASSERT_TRUE(jw.ok());
+    report("3 x telemetry object, rebuilt", elapsed, iterations, jw.size());
+
+    start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.beginArray();
+        for (int k = 0; k < 3; ++k)
+        {
+            jw.embed(child);
+        }
+        jw.endArray();
+    }
+    elapsed = micros() - start;
+    TEST_ASSERT_TRUE(jw.ok());
+    report("3 x telemetry object, embedded", elapsed, iterations, jw.size());
+}
+
+// CRC-32 of a multi-frame document: hashed while writing vs. a second pass after finalize()
+void test_bench_checksum()
+{
+    JsonChecksum checksum(JsonChecksum::CRC32);
+    JsonBufWriter jw(benchBuffer, BUFFER_SIZE);
+    const unsigned long iterations = 500;
+    const uint8_t *output = nullptr;
+    size_t length = 0;
+
+    uint32_t secondPass = 0;
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.beginArray();
+        for (uint32_t frame = 0; frame < 4; ++frame)
+        {
+            writeTelemetryFrame(jw, frame);
+        }
+        jw.endArray();
+        jw.finalize(output, length);
+        checksum.reset();
+        checksum.update(output, length);
+        secondPass = checksum.crc32();
+    }
+    unsigned long elapsed = micros() - start;
+    report("4 x telemetry + crc32, second pass", elapsed, iterations, length);
+
+    jw.setChecksum(&checksum);
+    start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.beginArray();
+        for (uint32_t frame = 0; frame < 4; ++frame)
+        {
+            writeTelemetryFrame(jw, frame);
+        }
+        jw.endArray();
+        jw.finalize(output, length);
+    }
+    elapsed = micros() - start;
+    report("4 x telemetry + crc32, while writing", elapsed, iterations, length);
+    TEST_ASSERT_EQUAL_HEX32(secondPass, checksum.crc32());
+}
+
+// Batch of telemetry frames streamed through a 64-byte staging buffer into an encoder
+template <typename Encoder>
+static void benchCompression(const char *name)
+{
+    static uint8_t staging[64];
+    static uint8_t packet[4096];
+    static JsonCompressionSink<Encoder> sink(packet, sizeof(packet));
+    JsonBufWriter jw(staging, sizeof(staging));
+    const unsigned long iterations = 50;
+
+    size_t plain = 0;
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(staging, sizeof(staging));
+        sink.output().reset(packet, sizeof(packet));
+        sink.attach(jw);
+        jw.beginArray();
+        for (uint32_t frame = 0; frame < 16; ++frame)
+        {
+            writeTelemetryFrame(jw, i * 16 + frame);
+        }
+        jw.endArray();
+        TEST_ASSERT_TRUE(sink.finish(jw));
+        plain = jw.flushedSize();
+    }
+    unsigned long elapsed = micros() - start;
+
+    report(name, elapsed, iterations, plain);
+
+    char message[96];
+    snprintf(message, sizeof(message), "[%s] %s: %u -> %u bytes (%.1f%%)", CONFIGURATION, name,
+             static_cast<unsigned>(plain), static_cast<unsigned>(sink.output().size()),
+             100.0 * sink.output().size() / plain);
+    TEST_MESSAGE(message);
+}
+
+void test_bench_compression_heatshrink()
+{
+    benchCompression<JsonHeatshrinkEncoder<8, 4>>("16 x telemetry, heatshrink 8/4");
+}
+
+void test_bench_compression_deflate()
+{
+    benchCompression<JsonDeflateEncoder<12>>("16 x telemetry, deflate fixed 4K");
+}
+
+// One-second-apart timestamps: gmtime_r() + snprintf() + value() vs. valueTimestamp()
+void test_bench_timestamps()
+{
+    JsonBufWriter jw(benchBuffer, BUFFER_SIZE);
+    const unsigned long iterations = 200;
+    const uint32_t perIteration = 32;
+    const int64_t base = 1714566896;
+    size_t length = 0;
+
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.beginArray();
+        for (uint32_t j = 0; j < perIteration; ++j)
+        {
+            time_t seconds = static_cast<time_t>(base + j);
+            struct tm parts;
+            gmtime_r(&seconds, &parts);
+            char text[64];
+            snprintf(text, sizeof(text), "%04d-%02d-%02dT%02d:%02d:%02d.%03uZ", parts.tm_year + 1900,
+                     parts.tm_mon + 1, parts.tm_mday, parts.tm_hour, parts.tm_min, parts.tm_sec,
+                     static_cast<unsigned>(j * 31));
+            jw.value(text);
+        }
+        jw.endArray();
+        length = jw.size();
+    }
+    unsigned long elapsed = micros() - start;
+    report("32 timestamps, gmtime_r + snprintf", elapsed, iterations, length);
+
+    start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.beginArray();
+        for (uint32_t j = 0; j < perIteration; ++j)
+        {
+            jw.valueTimestamp(base + j, j * 31000, 3);
+        }
+        jw.endArray();
+        TEST_ASSERT_EQUAL_UINT(length, jw.size());
+    }
+    elapsed = micros() - start;
+    report("32 timestamps, valueTimestamp", elapsed, iterations, length);
+}
+
+// Device identifiers: snprintf() into scratch strings + value() vs. the typed writers
+void test_bench_identifiers()
+{
+    static const uint8_t mac[6] = {0x24, 0x0A, 0xC4, 0x12, 0xAB, 0xEF};
+    static const uint8_t ip[4] = {192, 168, 4, 1};
+    static const uint8_t uuid[16] = {0x12, 0x3E, 0x45, 0x67, 0xE8, 0x9B, 0x12, 0xD3,
+                                     0xA4, 0x56, 0x42, 0x66, 0x14, 0x17, 0x40, 0x00};
+    const uint64_t chipId = 0x0000240AC412ABEFULL;
+    JsonBufWriter jw(benchBuffer, BUFFER_SIZE);
+    const unsigned long iterations = 2000;
+    size_t length = 0;
+
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        char text[40];
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.beginObject();
+        jw.key("mac");
+        snprintf(text, sizeof(text), "%02x:%02x:%02x:%02x:%02x:%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+        jw.value(text);
+        jw.key("ip");
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+        jw.value(text);
+        jw.key("uuid");
+        snprintf(text, sizeof(text), "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x", uuid[0],
+                 uuid[1], uuid[2], uuid[3], uuid[4], uuid[5], uuid[6], uuid[7], uuid[8], uuid[9], uuid[10], uuid[11],
+                 uuid[12], uuid[13], uuid[14], uuid[15]);
+        jw.value(text);
+        jw.key("chip");
+        snprintf(text, sizeof(text), "%08lx%08lx", static_cast<unsigned long>(chipId >> 32),
+                 static_cast<unsigned long>(chipId & 0xFFFFFFFFu));
+        jw.value(text);
+        jw.endObject();
+        length = jw.size();
+    }
+    unsigned long elapsed = micros() - start;
+    report("identifiers, snprintf + value()", elapsed, iterations, length);
+
+    start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.beginObject();
+        jw.key("mac");
+        jw.valueMac(mac);
+        jw.key("ip");
+        jw.valueIPv4(ip);
+        jw.key("uuid");
+        jw.valueUuid(uuid);
+        jw.key("chip");
+        jw.valueHex64(chipId);
+        jw.endObject();
+        TEST_ASSERT_EQUAL_UINT(length, jw.size());
+    }
+    elapsed = micros() - start;
+    report("identifiers, typed writers", elapsed, iterations, length);
+}
+
+// Indented configuration fragment inserted verbatim vs. validated and minified
+void test_bench_raw_validated()
+{
+    static const char fragment[] =
+        "{\n"
+        "  \"network\": {\n"
+        "    \"ssid\": \"plant-floor-2\",\n"
+        "    \"dhcp\": true,\n"
+        "    \"dns\": [\"10.0.0.1\", \"10.0.0.2\"]\n"
+        "  },\n"
+        "  \"sampling\": { \"interval_ms\": 250, \"channels\": [0, 1, 2, 3, 6, 7] },\n"
+        "  \"thresholds\": { \"high\": 85.5, \"low\": -12.25, \"hysteresis\": 0.5 },\n"
+        "  \"label\": \"Line \\\"B\\\" pumps\"\n"
+        "}\n";
+    const size_t fragmentLength = sizeof(fragment) - 1;
+    JsonBufWriter jw(benchBuffer, BUFFER_SIZE);
+    const unsigned long iterations = 2000;
+    size_t length = 0;
+
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.raw(fragment, fragmentLength);
+        length = jw.size();
+    }
+    unsigned long elapsed = micros() - start;
+    report("config fragment, raw()", elapsed, iterations, length);
+
+    start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        jw.reset(benchBuffer, BUFFER_SIZE);
+        jw.rawValidated(fragment, fragmentLength);
+        length = jw.size();
+    }
+    elapsed = micros() - start;
+    TEST_ASSERT_TRUE(jw.ok());
+    report("config fragment, rawValidated()", elapsed, iterations, fragmentLength);
+
+    char message[96];
+    snprintf(message, sizeof(message), "config fragment minified: %u -> %u bytes", static_cast<unsigned>(fragmentLength),
+             static_cast<unsigned>(length));
+    TEST_MESSAGE(message);
+}
+
+// Pull-parser throughput on generated stand-ins for the usual parser corpora: twitter.json
+// (string-heavy objects), canada.json (long arrays of coordinates) and citm_catalog.json
+// (nested objects, pretty-printed)
+constexpr size_t CORPUS_SIZE = 8192;
+static uint8_t corpusBuffer[CORPUS_SIZE];
+static uint8_t prettyBuffer[CORPUS_SIZE];
+
+static size_t writeTwitterLike()
+{
+    JsonBufWriter jw(corpusBuffer, CORPUS_SIZE);
+    jw.beginObject();
+    jw.key("statuses");
+    jw.beginArray();
+    for (uint32_t i = 0; i < 14; ++i)
+    {
+        jw.beginObject();
+        jw.key("id");
+        jw.value(static_cast<uint64_t>(505874924095815681ULL + i));
+        jw.key("text");
+        jw.value("RT @station_ops: Pump \"north-7\" back online after maintenance \xE2\x9C\x85 #ops https://t.co/x7Kq");
+        jw.key("user");
+        jw.beginObject();
+        jw.key("screen_name");
+        jw.value("station_ops");
+        jw.key("description");
+        jw.value("Operations feed for the water network.\nAlerts, maintenance windows and status.");
+        jw.key("followers_count");
+        jw.value(static_cast<uint32_t>(1024 + i * 37));
+        jw.key("verified");
+        jw.value(false);
+        jw.endObject();
+        jw.key("hashtags");
+        jw.beginArray();
+        jw.value("ops");
+        jw.value("maintenance");
+        jw.endArray();
+        jw.key("in_reply_to");
+        jw.null();
+        jw.key("lang");
+        jw.value("en");
+        jw.endObject();
+    }
+    jw.endArray();
+    jw.endObject();
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(jw.finalize(output, length));
+    return length;
+}
+
+static size_t writeCanadaLike()
+{
+    JsonBufWriter jw(corpusBuffer, CORPUS_SIZE);
+    jw.beginObject();
+    jw.key("type");
+    jw.value("Polygon");
+    jw.key("coordinates");
+    jw.beginArray();
+    for (uint32_t ring = 0; ring < 4; ++ring)
+    {
+        jw.beginArray();
+        for (uint32_t i = 0; i < 80; ++i)
+        {
+            jw.beginArray();
+            jw.value(-65.613616999999977 + 0.000731 * (ring * 80 + i));
+            jw.value(43.420273000000009 - 0.000517 * (ring * 80 + i));
+            jw.endArray();
+        }
+        jw.endArray();
+    }
+    jw.endArray();
+    jw.endObject();
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(jw.finalize(output, length));
+    return length;
+}
+
+// Re-indent a minified document two spaces per level, like citm_catalog.json
+static size_t prettyPrint(const uint8_t *in, size_t length)
+{
+    size_t out = 0;
+    int level = 0;
+    bool inString = false;
+    auto put = [&](uint8_t c) { if (out < CORPUS_SIZE) prettyBuffer[out++] = c; };
+    auto newline = [&]() { put('\n'); for (int i = 0; i < 2 * level; ++i) put(' '); };
+    for (size_t i = 0; i < length; ++i)
+    {
+        uint8_t c = in[i];
+        if (inString)
+        {
+            put(c);
+            if (c == '\\')
+            {
+                put(in[++i]);
+            }
+            inString = c != '"';
+            continue;
+        }
+        switch (c)
+        {
+        case '{':
+        case '[': put(c); ++level; newline(); break;
+        case '}':
+        case ']': --level; newline(); put(c); break;
+        case ',': put(c); newline(); break;
+        case ':': put(c); put(' '); break;
+        default: put(c); inString = c == '"'; break;
+        }
+    }
+    TEST_ASSERT_TRUE(out < CORPUS_SIZE);
+    return out;
+}
+
+static size_t writeCitmLike()
+{
+    JsonBufWriter jw(corpusBuffer, CORPUS_SIZE);
+    jw.beginObject();
+    jw.key("events");
+    jw.beginObject();
+    for (uint32_t i = 0; i < 24; ++i)
+    {
+        char id[12];
+        snprintf(id, sizeof(id), "%u", static_cast<unsigned>(138586341 + i));
+        jw.key(id);
+        jw.beginObject();
+        jw.key("id");
+        jw.value(static_cast<uint32_t>(138586341 + i));
+        jw.key("name");
+        jw.value("Orchestre Philharmonique");
+        jw.key("logo");
+        jw.null();
+        jw.key("subTopicIds");
+        jw.beginArray();
+        jw.value(337184269u);
+        jw.value(337184283u);
+        jw.endArray();
+        jw.key("topicIds");
+        jw.beginArray();
+        jw.value(324846099u);
+        jw.value(107888604u);
+        jw.endArray();
+        jw.endObject();
+    }
+    jw.endObject();
+    jw.endObject();
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(jw.finalize(output, length));
+    return prettyPrint(output, length);
+}
+
+static void benchReader(const char *name, const uint8_t *document, size_t length)
+{
+    const unsigned long iterations = 200;
+    unsigned long tokens = 0;
+    JsonReader::Token token = JsonReader::Token::None;
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        JsonReader reader(document, length);
+        while ((token = reader.next()) != JsonReader::Token::End && token != JsonReader::Token::Error)
+        {
+            ++tokens;
+        }
+    }
+    unsigned long elapsed = micros() - start;
+    TEST_ASSERT_TRUE(token == JsonReader::Token::End);
+    TEST_ASSERT_TRUE(tokens > 0);
+    report(name, elapsed, iterations, length);
+}
+
+void test_bench_reader_twitter_like()
+{
+    benchReader("reader, twitter-like (strings)", corpusBuffer, writeTwitterLike());
+}
+
+void test_bench_reader_canada_like()
+{
+    benchReader("reader, canada-like (numbers)", corpusBuffer, writeCanadaLike());
+}
+
+void test_bench_reader_citm_like()
+{
+    const size_t length = writeCitmLike();
+    benchReader("reader, citm-like (indented)", prettyBuffer, length);
+}
+
+void setup()
+{
+    delay(2000); // Wait for serial monitor
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_bench_telemetry_document);
+    RUN_TEST(test_bench_integer_array);
+    RUN_TEST(test_bench_integer_array_range);
+    RUN_TEST(test_bench_float_array_decimal);
+    RUN_TEST(test_bench_float_array_scaled);
+    RUN_TEST(test_bench_batch_rows);
+    RUN_TEST(test_bench_batch_columns);
+    RUN_TEST(test_bench_bool_null_array);
+    RUN_TEST(test_bench_strings_passthrough);
+    RUN_TEST(test_bench_strings_validated);
+    RUN_TEST(test_bench_strings_ascii_only);
+    RUN_TEST(test_bench_token_keys);
+    RUN_TEST(test_bench_embed_cached_object);
+    RUN_TEST(test_bench_checksum);
+    RUN_TEST(test_bench_compression_heatshrink);
+    RUN_TEST(test_bench_compression_deflate);
+    RUN_TEST(test_bench_timestamps);
+    RUN_TEST(test_bench_identifiers);
+    RUN_TEST(test_bench_raw_validated);
+    RUN_TEST(test_bench_reader_twitter_like);
+    RUN_TEST(test_bench_reader_canada_like);
+    RUN_TEST(test_bench_reader_citm_like);
+
+    UNITY_END();
+}
+
+void loop()
+{
+}
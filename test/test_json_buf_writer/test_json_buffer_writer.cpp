@@ -2,6 +2,12 @@
 #include <Arduino.h>
 #include "../../src/json_buffer_writer.hpp"
 
+#include <array>
+#include <map>
+#include <math.h>
+#include <string>
+#include <vector>
+
 // Test buffer size
 constexpr size_t BUFFER_SIZE = 512;
 static uint8_t testBuffer[BUFFER_SIZE];
@@ -124,6 +130,24 @@ void test_integer_values()
     TEST_ASSERT_EQUAL_STRING("[-123,456,-789123456789,987654321098]", result.c_str());
 }
 
+void test_integer_limits()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value(static_cast<int32_t>(0)));
+    TEST_ASSERT_TRUE(writer.value(static_cast<int32_t>(INT32_MIN)));
+    TEST_ASSERT_TRUE(writer.value(static_cast<uint32_t>(UINT32_MAX)));
+    TEST_ASSERT_TRUE(writer.value(static_cast<int64_t>(INT64_MIN)));
+    TEST_ASSERT_TRUE(writer.value(static_cast<uint64_t>(UINT64_MAX)));
+    TEST_ASSERT_TRUE(writer.value(static_cast<uint64_t>(4294967296ULL)));
+    TEST_ASSERT_TRUE(writer.endArray());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("[0,-2147483648,4294967295,-9223372036854775808,18446744073709551615,4294967296]",
+                             result.c_str());
+}
+
 void test_float_values()
 {
     JsonBufWriter writer(testBuffer, BUFFER_SIZE);
@@ -188,6 +212,85 @@ void test_control_character_escaping()
     TEST_ASSERT_EQUAL_STRING("[\"\\u0001\\u001f\"]", result.c_str());
 }
 
+void test_long_string_escaping()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+
+    // Escapes placed at different offsets around 4- and 16-byte scan blocks
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value("abcdefghijklmnopqrstuvwxyz0123456789"));
+    TEST_ASSERT_TRUE(writer.value("abcdefghijklmno\"qrstuvwxyz\\123456789\n"));
+    TEST_ASSERT_TRUE(writer.value("abc\tdefghijklmnopqrstuvwxyz0123\x7f"));
+    TEST_ASSERT_TRUE(writer.endArray());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("[\"abcdefghijklmnopqrstuvwxyz0123456789\","
+                             "\"abcdefghijklmno\\\"qrstuvwxyz\\\\123456789\\n\","
+                             "\"abc\\tdefghijklmnopqrstuvwxyz0123\x7f\"]",
+                             result.c_str());
+}
+
+void test_utf8_passthrough()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+
+    // Default mode copies non-ASCII bytes verbatim, even when ill-formed
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value("caf\xC3\xA9 \xE2\x82\xAC"));
+    TEST_ASSERT_TRUE(writer.value("bad\xFF"));
+    TEST_ASSERT_TRUE(writer.endArray());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("[\"caf\xC3\xA9 \xE2\x82\xAC\",\"bad\xFF\"]", result.c_str());
+}
+
+void test_utf8_replace_invalid()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    writer.setUtf8Mode(JsonBufWriter::Utf8Mode::Replace);
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value("ok\xC3\xA9"));
+    TEST_ASSERT_TRUE(writer.value("a\xFF" "b"));      // Invalid lead byte
+    TEST_ASSERT_TRUE(writer.value("a\xE2\x82z"));     // Truncated sequence -> one replacement
+    TEST_ASSERT_TRUE(writer.value("\xC0\xAF"));       // Overlong: two invalid bytes
+    TEST_ASSERT_TRUE(writer.value("\xED\xA0\x80"));   // Encoded surrogate
+    TEST_ASSERT_TRUE(writer.endArray());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("[\"ok\xC3\xA9\","
+                             "\"a\xEF\xBF\xBD" "b\","
+                             "\"a\xEF\xBF\xBDz\","
+                             "\"\xEF\xBF\xBD\xEF\xBF\xBD\","
+                             "\"\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\"]",
+                             result.c_str());
+}
+
+void test_utf8_reject_invalid()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    writer.setUtf8Mode(JsonBufWriter::Utf8Mode::Reject);
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value("valid \xF0\x9F\x98\x80"));
+    TEST_ASSERT_FALSE(writer.value("invalid \xF5\x80\x80\x80"));
+    TEST_ASSERT_FALSE(writer.ok());
+}
+
+void test_ascii_only_output()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    writer.setAsciiOnly(true);
+
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("caf\xC3\xA9"));
+    TEST_ASSERT_TRUE(writer.value("\xE2\x82\xAC \xF0\x9F\x98\x80 \xFF"));
+    TEST_ASSERT_TRUE(writer.endObject());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"caf\\u00e9\":\"\\u20ac \\ud83d\\ude00 \\ufffd\"}", result.c_str());
+}
+
 // Nested structure tests
 void test_nested_objects()
 {
@@ -270,163 +373,1262 @@ void test_raw_json()
     TEST_ASSERT_EQUAL_STRING("{\"custom\":{\"raw\":true},\"normal\":\"value\"}", result.c_str());
 }
 
-// Edge cases and error handling
-void test_buffer_overflow()
+void test_raw_validated_minifies()
 {
-    uint8_t smallBuffer[20]; // Increased size slightly
-    JsonBufWriter writer(smallBuffer, 20);
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    const char *fragment = "{\n  \"name\" : \"a b\\n\",\n  \"list\": [ 1, -2.5e3 , true,null, { } ],\r\n\t\"x\":[]\n}\n";
 
-    TEST_ASSERT_TRUE(writer.beginObject());
-    TEST_ASSERT_TRUE(writer.key("key"));
-    // This should fail due to buffer overflow
-    TEST_ASSERT_FALSE(writer.value("very long string that exceeds buffer capacity"));
-    TEST_ASSERT_FALSE(writer.ok());
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.rawValidated(fragment, strlen(fragment)));
+    TEST_ASSERT_TRUE(writer.rawValidated(" \"s\" ", 5));
+    TEST_ASSERT_TRUE(writer.endArray());
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("[{\"name\":\"a b\\n\",\"list\":[1,-2.5e3,true,null,{}],\"x\":[]},\"s\"]",
+                             result.c_str());
+
+    // Indented text that only fits once minified
+    uint8_t smallBuffer[24];
+    JsonBufWriter small(smallBuffer, sizeof(smallBuffer));
+    const char *indented = "{\n    \"a\": [\n        1,\n        2\n    ]\n}";
+    TEST_ASSERT_TRUE(strlen(indented) > sizeof(smallBuffer));
+    TEST_ASSERT_TRUE(small.rawValidated(indented, strlen(indented)));
+    result = getJsonString(small);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":[1,2]}", result.c_str());
 }
 
-void test_invalid_structure()
+void test_raw_validated_rejects_malformed()
 {
-    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    static const char *const fragments[] = {"", "{\"a\":1,}", "[1 2]", "{\"a\" 1}", "01", "tru", "\"open", "1 2"};
+    for (const char *fragment : fragments)
+    {
+        JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+        TEST_ASSERT_TRUE(writer.beginObject());
+        TEST_ASSERT_TRUE(writer.key("cfg"));
+        TEST_ASSERT_FALSE(writer.rawValidated(fragment, strlen(fragment)));
+        TEST_ASSERT_FALSE(writer.ok());
+    }
 
-    // Try to end object without starting one
-    TEST_ASSERT_FALSE(writer.endObject());
-    TEST_ASSERT_FALSE(writer.ok());
+    // Ill-formed UTF-8 is only an error in Utf8Mode::Reject
+    const char *latin1 = "\"caf\xE9\"";
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(writer.rawValidated(latin1, strlen(latin1)));
+    writer.reset(testBuffer, BUFFER_SIZE);
+    writer.setUtf8Mode(JsonBufWriter::Utf8Mode::Reject);
+    TEST_ASSERT_FALSE(writer.rawValidated(latin1, strlen(latin1)));
 }
 
-void test_mismatched_containers()
+void test_raw_validated_reencodes_strings()
 {
+    // Keys and strings follow the writer's encoding options; escapes are kept as written
+    const char *fragment = "{\"h\xC3\xA9\": [\"\\n\\u00e9\xF0\x9F\x98\x80\", \"caf\xE9\"]}";
     JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    writer.setAsciiOnly(true);
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("k"));
+    TEST_ASSERT_TRUE(writer.rawValidated(fragment, strlen(fragment)));
+    TEST_ASSERT_TRUE(writer.endObject());
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"k\":{\"h\\u00e9\":[\"\\n\\u00e9\\ud83d\\ude00\",\"caf\\ufffd\"]}}", result.c_str());
 
+    writer.reset(testBuffer, BUFFER_SIZE);
+    writer.setAsciiOnly(false);
+    writer.setUtf8Mode(JsonBufWriter::Utf8Mode::Replace);
+    TEST_ASSERT_TRUE(writer.rawValidated(fragment, strlen(fragment)));
+    result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"h\xC3\xA9\":[\"\\n\\u00e9\xF0\x9F\x98\x80\",\"caf\xEF\xBF\xBD\"]}", result.c_str());
+
+    // ASCII-only output with Utf8Mode::Reject still refuses ill-formed input
+    writer.reset(testBuffer, BUFFER_SIZE);
+    writer.setAsciiOnly(true);
+    writer.setUtf8Mode(JsonBufWriter::Utf8Mode::Reject);
+    TEST_ASSERT_FALSE(writer.rawValidated(fragment, strlen(fragment)));
+    writer.setAsciiOnly(false);
+    writer.setUtf8Mode(JsonBufWriter::Utf8Mode::Passthrough);
+}
+
+void test_embed_child_writer()
+{
+    uint8_t childBuffer[64];
+    JsonBufWriter child(childBuffer, sizeof(childBuffer));
+    TEST_ASSERT_TRUE(child.beginObject());
+    TEST_ASSERT_TRUE(child.key("id"));
+    TEST_ASSERT_TRUE(child.value("s\"1"));
+    TEST_ASSERT_TRUE(child.endObject());
+
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
     TEST_ASSERT_TRUE(writer.beginObject());
-    // Try to end with array instead of object
-    TEST_ASSERT_FALSE(writer.endArray());
-    TEST_ASSERT_FALSE(writer.ok());
+    TEST_ASSERT_TRUE(writer.key("a"));
+    TEST_ASSERT_TRUE(writer.embed(child));
+    TEST_ASSERT_TRUE(writer.key("list"));
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.embed(child));
+    TEST_ASSERT_TRUE(writer.embed(child));
+    TEST_ASSERT_TRUE(writer.endArray());
+    TEST_ASSERT_TRUE(writer.endObject());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":{\"id\":\"s\\\"1\"},\"list\":[{\"id\":\"s\\\"1\"},{\"id\":\"s\\\"1\"}]}",
+                             result.c_str());
 }
 
-void test_key_without_object()
+void test_embed_rejects_incomplete_child()
 {
+    uint8_t childBuffer[32];
+    JsonBufWriter child(childBuffer, sizeof(childBuffer));
     JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(writer.beginArray());
 
+    TEST_ASSERT_FALSE(writer.embed(child)); // Empty
+    writer.reset(testBuffer, BUFFER_SIZE);
     TEST_ASSERT_TRUE(writer.beginArray());
-    // Try to add key inside array
-    TEST_ASSERT_FALSE(writer.key("invalid"));
+    TEST_ASSERT_TRUE(child.beginArray());
+    TEST_ASSERT_FALSE(writer.embed(child)); // Open container
     TEST_ASSERT_FALSE(writer.ok());
+
+    writer.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_FALSE(writer.embed(writer)); // Self
 }
 
-void test_multiple_root_values()
+void test_raw_key()
 {
     JsonBufWriter writer(testBuffer, BUFFER_SIZE);
 
-    TEST_ASSERT_TRUE(writer.value("first"));
-    // Second root value should fail
-    TEST_ASSERT_FALSE(writer.value("second"));
-    TEST_ASSERT_FALSE(writer.ok());
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.rawKey("\"a\":", 4));
+    TEST_ASSERT_TRUE(writer.value(1));
+    TEST_ASSERT_TRUE(writer.rawKey("\"b\":", 4));
+    TEST_ASSERT_TRUE(writer.value(2));
+    TEST_ASSERT_TRUE(writer.endObject());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1,\"b\":2}", result.c_str());
 }
 
-void test_max_depth()
+void test_reserve_value()
 {
     JsonBufWriter writer(testBuffer, BUFFER_SIZE);
 
-    // Create nested structure up to max depth
-    for (int i = 0; i < JsonBufWriter::MAX_DEPTH; i++)
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("ts"));
+    char *span = writer.reserveValue(24);
+    TEST_ASSERT_NOT_NULL(span);
+    TEST_ASSERT_TRUE(writer.commitValue(snprintf(span, 24, "\"%02d:%02d:%02d\"", 12, 5, 9)));
+    TEST_ASSERT_TRUE(writer.key("v"));
+    TEST_ASSERT_TRUE(writer.beginArray());
+    for (int i = 0; i < 3; i++)
     {
-        TEST_ASSERT_TRUE(writer.beginObject());
-        TEST_ASSERT_TRUE(writer.key("level"));
+        span = writer.reserveValue(4);
+        TEST_ASSERT_NOT_NULL(span);
+        span[0] = static_cast<char>('7' + i);
+        TEST_ASSERT_TRUE(writer.commitValue(1));
     }
+    TEST_ASSERT_TRUE(writer.endArray());
+    TEST_ASSERT_TRUE(writer.endObject());
 
-    // This should fail (exceeds max depth)
-    TEST_ASSERT_FALSE(writer.beginObject());
-    TEST_ASSERT_FALSE(writer.ok());
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"ts\":\"12:05:09\",\"v\":[7,8,9]}", result.c_str());
 }
 
-// Reset and reuse tests
-void test_reset_functionality()
+void test_reserve_value_errors()
 {
-    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    uint8_t smallBuffer[8];
+    JsonBufWriter writer(smallBuffer, sizeof(smallBuffer));
 
-    // First use
-    TEST_ASSERT_TRUE(writer.beginObject());
-    TEST_ASSERT_TRUE(writer.key("test"));
-    TEST_ASSERT_TRUE(writer.value(123));
-    TEST_ASSERT_TRUE(writer.endObject());
+    // Commit without a reservation, or longer than reserved
+    TEST_ASSERT_FALSE(writer.commitValue(1));
+    writer.reset(smallBuffer, sizeof(smallBuffer));
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_NOT_NULL(writer.reserveValue(2));
+    TEST_ASSERT_FALSE(writer.commitValue(3));
+    TEST_ASSERT_FALSE(writer.ok());
 
-    String result1 = getJsonString(writer);
-    TEST_ASSERT_EQUAL_STRING("{\"test\":123}", result1.c_str());
+    // A span larger than the free space fails cleanly
+    writer.reset(smallBuffer, sizeof(smallBuffer));
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_NULL(writer.reserveValue(8));
+    TEST_ASSERT_FALSE(writer.ok());
 
-    // Reset and reuse
-    writer.reset(testBuffer, BUFFER_SIZE);
+    // In best-effort mode the value is dropped instead
+    writer.reset(smallBuffer, sizeof(smallBuffer));
+    writer.setBestEffort(true);
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_NULL(writer.reserveValue(8));
     TEST_ASSERT_TRUE(writer.ok());
-    TEST_ASSERT_EQUAL_UINT32(0, writer.size());
+    TEST_ASSERT_EQUAL_UINT(1, writer.droppedCount());
+    TEST_ASSERT_TRUE(writer.endArray());
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("[]", result.c_str());
+}
+
+// Typed value tests
+void test_value_timestamp()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
 
     TEST_ASSERT_TRUE(writer.beginArray());
-    TEST_ASSERT_TRUE(writer.value("new"));
+    TEST_ASSERT_TRUE(writer.valueTimestamp(0));
+    TEST_ASSERT_TRUE(writer.valueTimestamp(1714566896, 250000, 3));
+    TEST_ASSERT_TRUE(writer.valueTimestamp(1714566897, 7, 6)); // Same day: cached date
+    TEST_ASSERT_TRUE(writer.valueTimestamp(951868799, 999999, 1));
+    TEST_ASSERT_TRUE(writer.valueTimestamp(-1));
+    TEST_ASSERT_TRUE(writer.valueTimestamp(4107542400LL));
+    TEST_ASSERT_TRUE(writer.valueTimestamp(-62167219200LL));
+    TEST_ASSERT_TRUE(writer.valueTimestamp(253402300799LL));
     TEST_ASSERT_TRUE(writer.endArray());
 
-    String result2 = getJsonString(writer);
-    TEST_ASSERT_EQUAL_STRING("[\"new\"]", result2.c_str());
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("[\"1970-01-01T00:00:00Z\",\"2024-05-01T12:34:56.250Z\",\"2024-05-01T12:34:57.000007Z\","
+                             "\"2000-02-29T23:59:59.9Z\",\"1969-12-31T23:59:59Z\",\"2100-03-01T00:00:00Z\","
+                             "\"0000-01-01T00:00:00Z\",\"9999-12-31T23:59:59Z\"]",
+                             result.c_str());
+
+    // Out of range
+    writer.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_FALSE(writer.valueTimestamp(253402300800LL));
+    writer.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_FALSE(writer.valueTimestamp(0, 1000000));
+    writer.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_FALSE(writer.valueTimestamp(0, 0, 7));
+
+    // Capacity is checked once for the whole string
+    uint8_t smallBuffer[22];
+    JsonBufWriter small(smallBuffer, sizeof(smallBuffer));
+    TEST_ASSERT_TRUE(small.valueTimestamp(1714566896));
+    small.reset(smallBuffer, sizeof(smallBuffer));
+    TEST_ASSERT_FALSE(small.valueTimestamp(1714566896, 0, 1));
+    TEST_ASSERT_EQUAL_UINT(0, small.size());
 }
 
-void test_float_precision_setting()
+void test_identifier_values()
 {
+    static const uint8_t mac[6] = {0x24, 0x0A, 0xC4, 0x12, 0xAB, 0xEF};
+    static const uint8_t ipv4[4] = {192, 168, 4, 1};
+    static const uint8_t ipv6[16] = {0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01};
+    static const uint8_t ipv6Mapped[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF, 192, 0, 2, 33};
+    static const uint8_t ipv6Full[16] = {0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0};
+    static const uint8_t uuid[16] = {0x12, 0x3E, 0x45, 0x67, 0xE8, 0x9B, 0x12, 0xD3,
+                                     0xA4, 0x56, 0x42, 0x66, 0x14, 0x17, 0x40, 0x00};
+    static const uint8_t zeros[16] = {};
     JsonBufWriter writer(testBuffer, BUFFER_SIZE);
 
-    // Test with default precision
-    writer.setFloatPrecision(1);
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("mac"));
+    TEST_ASSERT_TRUE(writer.valueMac(mac));
+    TEST_ASSERT_TRUE(writer.key("ip"));
+    TEST_ASSERT_TRUE(writer.valueIPv4(ipv4));
+    TEST_ASSERT_TRUE(writer.key(7u));
     TEST_ASSERT_TRUE(writer.beginArray());
-    TEST_ASSERT_TRUE(writer.value(3.14159));
+    TEST_ASSERT_TRUE(writer.valueIPv6(ipv6));
+    TEST_ASSERT_TRUE(writer.valueIPv6(ipv6Mapped));
+    TEST_ASSERT_TRUE(writer.valueIPv6(ipv6Full));
+    TEST_ASSERT_TRUE(writer.valueIPv6(zeros));
     TEST_ASSERT_TRUE(writer.endArray());
+    TEST_ASSERT_TRUE(writer.key(4294967295u));
+    TEST_ASSERT_TRUE(writer.valueUuid(uuid));
+    TEST_ASSERT_TRUE(writer.key(0u));
+    TEST_ASSERT_TRUE(writer.valueHex64(0x1234ABCDEF01ULL));
+    TEST_ASSERT_TRUE(writer.key("eth"));
+    TEST_ASSERT_TRUE(writer.valueMac(mac, '-'));
+    TEST_ASSERT_TRUE(writer.endObject());
 
     String result = getJsonString(writer);
-    TEST_ASSERT_EQUAL_STRING("[3.1]", result.c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"mac\":\"24:0a:c4:12:ab:ef\",\"ip\":\"192.168.4.1\","
+                             "\"7\":[\"2001:db8::1\",\"::ffff:192.0.2.33\",\"2001:db8:0:1::1:0\",\"::\"],"
+                             "\"4294967295\":\"123e4567-e89b-12d3-a456-426614174000\",\"0\":\"00001234abcdef01\","
+                             "\"eth\":\"24-0a-c4-12-ab-ef\"}",
+                             result.c_str());
+
+    // An integer key outside an object is an error, like key(const char *)
+    writer.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_FALSE(writer.key(1u));
+
+    // Capacity is checked for the longest form before writing
+    uint8_t smallBuffer[18];
+    JsonBufWriter small(smallBuffer, sizeof(smallBuffer));
+    TEST_ASSERT_TRUE(small.valueHex64(1));
+    small.reset(smallBuffer, sizeof(smallBuffer));
+    TEST_ASSERT_FALSE(small.valueMac(mac));
+    TEST_ASSERT_EQUAL_UINT(0, small.size());
 }
 
-// Performance/stress test
-void test_large_object()
+// Range writer tests
+void test_range_array_scalars()
 {
     JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    const std::vector<double> temps = {20.5, -1.25};
+    const std::array<int, 3> counts = {{3, 0, -7}};
+    const int8_t small[] = {-128, 127};
+    const std::vector<uint64_t> big = {UINT64_MAX};
+    const std::vector<bool> flags = {true, false};
+    const char *names[] = {"a", "b\"c"};
+    const std::vector<int> none;
 
     TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("temps"));
+    TEST_ASSERT_TRUE(writer.array(temps));
+    TEST_ASSERT_TRUE(writer.key("counts"));
+    TEST_ASSERT_TRUE(writer.array(counts));
+    TEST_ASSERT_TRUE(writer.key("small"));
+    TEST_ASSERT_TRUE(writer.array(small));
+    TEST_ASSERT_TRUE(writer.key("big"));
+    TEST_ASSERT_TRUE(writer.array(big));
+    TEST_ASSERT_TRUE(writer.key("flags"));
+    TEST_ASSERT_TRUE(writer.array(flags));
+    TEST_ASSERT_TRUE(writer.key("names"));
+    TEST_ASSERT_TRUE(writer.array(names));
+    TEST_ASSERT_TRUE(writer.key("none"));
+    TEST_ASSERT_TRUE(writer.array(none));
+    TEST_ASSERT_TRUE(writer.endObject());
 
-    // Add many key-value pairs
-    for (int i = 0; i < 10; i++)
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"temps\":[20.500,-1.250],\"counts\":[3,0,-7],\"small\":[-128,127],"
+                             "\"big\":[18446744073709551615],\"flags\":[true,false],\"names\":[\"a\",\"b\\\"c\"],"
+                             "\"none\":[]}",
+                             result.c_str());
+}
+
+struct RangePoint
+{
+    int x;
+    int y;
+};
+
+static bool writePoint(JsonBufWriter &writer, const RangePoint &point)
+{
+    return writer.beginArray() && writer.value(point.x) && writer.value(point.y) && writer.endArray();
+}
+
+void test_range_object_and_serializer()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    const std::map<std::string, uint32_t> totals = {{"in", 10}, {"out", 4}};
+    const std::vector<RangePoint> path = {{0, 1}, {2, -3}};
+    const std::map<std::string, RangePoint> named = {{"home", {5, 6}}};
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.object(totals));
+    TEST_ASSERT_TRUE(writer.array(path, writePoint));
+    TEST_ASSERT_TRUE(writer.object(named, writePoint));
+    TEST_ASSERT_TRUE(writer.array(path, [](JsonBufWriter &w, const RangePoint &p) { return w.value(p.x); }));
+    TEST_ASSERT_TRUE(writer.endArray());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("[{\"in\":10,\"out\":4},[[0,1],[2,-3]],{\"home\":[5,6]},[0,2]]", result.c_str());
+}
+
+void test_range_best_effort_matches_per_value()
+{
+    // Elements take the per-value path, so the same values are dropped
+    const std::vector<int32_t> values = {1, 22, 333, 4444, 55555, 6, 7};
+    uint8_t rangeBuffer[20];
+    uint8_t loopBuffer[20];
+
+    JsonBufWriter ranged(rangeBuffer, sizeof(rangeBuffer));
+    ranged.setBestEffort(true);
+    TEST_ASSERT_TRUE(ranged.beginObject());
+    TEST_ASSERT_TRUE(ranged.key("v"));
+    TEST_ASSERT_FALSE(ranged.array(values));
+    TEST_ASSERT_TRUE(ranged.ok());
+    TEST_ASSERT_TRUE(ranged.endObject());
+
+    JsonBufWriter looped(loopBuffer, sizeof(loopBuffer));
+    looped.setBestEffort(true);
+    looped.beginObject();
+    looped.key("v");
+    looped.beginArray();
+    for (int32_t v : values)
     {
-        char key[16];
-        sprintf(key, "key%d", i);
-        TEST_ASSERT_TRUE(writer.key(key));
-        TEST_ASSERT_TRUE(writer.value(i * 100));
+        looped.value(v);
     }
+    looped.endArray();
+    looped.endObject();
+
+    String expected = getJsonString(looped);
+    String result = getJsonString(ranged);
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), result.c_str());
+    TEST_ASSERT_EQUAL_UINT(looped.droppedCount(), ranged.droppedCount());
+    TEST_ASSERT_TRUE(ranged.droppedCount() > 0);
+}
+
+// Token tests
+void test_token_key_and_value()
+{
+    JsonToken stateKey("st\"ate", JsonToken::Kind::Key);
+    JsonToken running("running");
+    TEST_ASSERT_TRUE(stateKey.ok());
+    TEST_ASSERT_TRUE(stateKey.isKey());
+    TEST_ASSERT_EQUAL_UINT(10, stateKey.size());
 
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key(stateKey));
+    TEST_ASSERT_TRUE(writer.value(running));
+    TEST_ASSERT_TRUE(writer.key("modes"));
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value(running));
+    TEST_ASSERT_TRUE(writer.value(running));
+    TEST_ASSERT_TRUE(writer.endArray());
     TEST_ASSERT_TRUE(writer.endObject());
-    TEST_ASSERT_TRUE(writer.ok());
 
     String result = getJsonString(writer);
-    TEST_ASSERT_TRUE(result.length() > 0);
-    TEST_ASSERT_TRUE(result.startsWith("{"));
-    TEST_ASSERT_TRUE(result.endsWith("}"));
+    TEST_ASSERT_EQUAL_STRING("{\"st\\\"ate\":\"running\",\"modes\":[\"running\",\"running\"]}", result.c_str());
 }
 
-// Test runner setup
-void setup()
+void test_token_kind_mismatch()
 {
-    delay(2000); // Wait for serial monitor
+    JsonToken running("running");
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
 
-    UNITY_BEGIN();
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_FALSE(writer.key(running));
+    TEST_ASSERT_FALSE(writer.ok());
+}
 
-    // Basic functionality
-    RUN_TEST(test_empty_object);
-    RUN_TEST(test_empty_array);
-    RUN_TEST(test_simple_object);
-    RUN_TEST(test_simple_array);
+void test_token_too_long()
+{
+    char text[JsonToken::CAPACITY];
+    memset(text, 'x', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
 
-    // Data types
-    RUN_TEST(test_string_values);
-    RUN_TEST(test_boolean_values);
-    RUN_TEST(test_integer_values);
-    RUN_TEST(test_float_values);
-    RUN_TEST(test_null_values);
+    JsonToken token(text); // 63 chars + quotes exceeds capacity
+    TEST_ASSERT_FALSE(token.ok());
 
-    // String escaping
-    RUN_TEST(test_string_escaping);
-    RUN_TEST(test_control_character_escaping);
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_FALSE(writer.value(token));
+    TEST_ASSERT_FALSE(writer.ok());
+
+    TEST_ASSERT_TRUE(token.assign(text, 10, JsonToken::Kind::Key));
+    TEST_ASSERT_EQUAL_UINT(13, token.size());
+}
+
+// Flush handler tests
+struct FlushCapture
+{
+    String text;
+    size_t calls;
+    bool fail;
+};
+
+static bool captureFlush(void *context, const uint8_t *data, size_t length)
+{
+    FlushCapture *capture = static_cast<FlushCapture *>(context);
+    capture->calls++;
+    if (capture->fail)
+    {
+        return false;
+    }
+    capture->text += String(reinterpret_cast<const char *>(data), length);
+    return true;
+}
+
+void test_flush_handler_streaming()
+{
+    uint8_t smallBuffer[16];
+    FlushCapture capture = {"", 0, false};
+    JsonBufWriter writer(smallBuffer, sizeof(smallBuffer));
+    writer.setFlushHandler(captureFlush, &capture);
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    for (int i = 0; i < 20; i++)
+    {
+        TEST_ASSERT_TRUE(writer.value(i * 1000));
+    }
+    TEST_ASSERT_TRUE(writer.endArray());
+
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(writer.finalize(output, length));
+    TEST_ASSERT_TRUE(capture.calls > 1);
+    TEST_ASSERT_EQUAL_STRING("[0,1000,2000,3000,4000,5000,6000,7000,8000,9000,10000,"
+                             "11000,12000,13000,14000,15000,16000,17000,18000,19000]",
+                             capture.text.c_str());
+}
+
+void test_flush_handler_long_string()
+{
+    uint8_t smallBuffer[8];
+    FlushCapture capture = {"", 0, false};
+    JsonBufWriter writer(smallBuffer, sizeof(smallBuffer));
+    writer.setFlushHandler(captureFlush, &capture);
+
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("text"));
+    TEST_ASSERT_TRUE(writer.value("a string much longer than the buffer\n"));
+    TEST_ASSERT_TRUE(writer.key("raw"));
+    TEST_ASSERT_TRUE(writer.raw("[1,2,3,4,5,6,7,8,9]", 19));
+    TEST_ASSERT_TRUE(writer.endObject());
+    TEST_ASSERT_TRUE(writer.flush());
+
+    TEST_ASSERT_EQUAL_STRING("{\"text\":\"a string much longer than the buffer\\n\",\"raw\":[1,2,3,4,5,6,7,8,9]}",
+                             capture.text.c_str());
+    TEST_ASSERT_EQUAL_UINT(capture.text.length(), writer.flushedSize());
+    TEST_ASSERT_EQUAL_UINT(0, writer.size());
+}
+
+void test_flush_handler_raw_validated()
+{
+    uint8_t smallBuffer[8];
+    FlushCapture capture = {"", 0, false};
+    JsonBufWriter writer(smallBuffer, sizeof(smallBuffer));
+    writer.setFlushHandler(captureFlush, &capture);
+    const char *fragment = "{ \"message\": \"a string much longer than the buffer\", \"n\": [ 10, 20 ] }";
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.rawValidated(fragment, strlen(fragment)));
+    TEST_ASSERT_TRUE(writer.endArray());
+    TEST_ASSERT_TRUE(writer.flush());
+    TEST_ASSERT_EQUAL_STRING("[{\"message\":\"a string much longer than the buffer\",\"n\":[10,20]}]",
+                             capture.text.c_str());
+}
+
+void test_flush_handler_failure()
+{
+    uint8_t smallBuffer[8];
+    FlushCapture capture = {"", 0, true};
+    JsonBufWriter writer(smallBuffer, sizeof(smallBuffer));
+    writer.setFlushHandler(captureFlush, &capture);
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_FALSE(writer.value("does not fit"));
+    TEST_ASSERT_FALSE(writer.ok());
+    TEST_ASSERT_EQUAL_UINT(1, capture.calls);
+}
+
+void test_flush_keeps_root_state()
+{
+    FlushCapture capture = {"", 0, false};
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    writer.setFlushHandler(captureFlush, &capture);
+
+    TEST_ASSERT_TRUE(writer.value(42));
+    TEST_ASSERT_TRUE(writer.flush());
+    // The buffer is empty again but the root value is already complete
+    TEST_ASSERT_FALSE(writer.value(43));
+    TEST_ASSERT_FALSE(writer.ok());
+    TEST_ASSERT_EQUAL_STRING("42", capture.text.c_str());
+}
+
+// JSON Lines tests
+void test_json_lines_records()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    writer.setJsonLines(true);
+
+    for (int i = 0; i < 3; i++)
+    {
+        TEST_ASSERT_TRUE(writer.beginObject());
+        TEST_ASSERT_TRUE(writer.key("n"));
+        TEST_ASSERT_TRUE(writer.value(i));
+        TEST_ASSERT_TRUE(writer.endObject());
+        TEST_ASSERT_EQUAL_UINT(writer.size(), writer.completeSize());
+    }
+    TEST_ASSERT_TRUE(writer.value("scalar"));
+    TEST_ASSERT_EQUAL_UINT(4, writer.recordCount());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"n\":0}\n{\"n\":1}\n{\"n\":2}\n\"scalar\"\n", result.c_str());
+
+    // Persists across reset, counters do not
+    writer.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_EQUAL_UINT(0, writer.recordCount());
+    TEST_ASSERT_TRUE(writer.value(1));
+    TEST_ASSERT_TRUE(writer.value(2));
+    result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("1\n2\n", result.c_str());
+}
+
+void test_json_lines_partial_record()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    writer.setJsonLines(true);
+
+    TEST_ASSERT_TRUE(writer.value(true));
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value(1));
+    TEST_ASSERT_EQUAL_UINT(5, writer.completeSize());
+    TEST_ASSERT_EQUAL_UINT(7, writer.size());
+}
+
+void test_json_lines_rollback()
+{
+    uint8_t smallBuffer[24];
+    JsonBufWriter writer(smallBuffer, sizeof(smallBuffer));
+    writer.setJsonLines(true, true);
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value(1));
+    TEST_ASSERT_TRUE(writer.endArray());
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("text"));
+    TEST_ASSERT_FALSE(writer.value("does not fit in the rest"));
+
+    // The unfinished record is gone and the writer refuses the rest of it
+    TEST_ASSERT_TRUE(writer.rolledBack());
+    TEST_ASSERT_FALSE(writer.ok());
+    TEST_ASSERT_FALSE(writer.endObject());
+    TEST_ASSERT_EQUAL_UINT(4, writer.size());
+    TEST_ASSERT_EQUAL_STRING_LEN("[1]\n", reinterpret_cast<const char *>(writer.data()), 4);
+
+    writer.reset(smallBuffer, sizeof(smallBuffer));
+    TEST_ASSERT_FALSE(writer.rolledBack());
+    TEST_ASSERT_TRUE(writer.value("fits"));
+    TEST_ASSERT_EQUAL_UINT(7, writer.size());
+}
+
+void test_json_lines_disabled_rejects_second_root()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    writer.setJsonLines(true);
+    writer.setJsonLines(false);
+
+    TEST_ASSERT_TRUE(writer.value(1));
+    TEST_ASSERT_FALSE(writer.value(2));
+    TEST_ASSERT_EQUAL_UINT(0, writer.recordCount());
+}
+
+// Pagination tests
+struct PageCapture
+{
+    String pages[16];
+    size_t count;
+};
+
+static bool capturePage(void *context, const uint8_t *data, size_t length)
+{
+    PageCapture *capture = static_cast<PageCapture *>(context);
+    if (capture->count >= 16)
+    {
+        return false;
+    }
+    capture->pages[capture->count++] = String(reinterpret_cast<const char *>(data), length);
+    return true;
+}
+
+void test_pagination_splits_array()
+{
+    uint8_t smallBuffer[40];
+    PageCapture capture = {};
+    JsonBufWriter writer(smallBuffer, sizeof(smallBuffer));
+    writer.setFlushHandler(capturePage, &capture);
+    writer.setPagination(true);
+
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("dev"));
+    TEST_ASSERT_TRUE(writer.value("x"));
+    TEST_ASSERT_TRUE(writer.key("samples"));
+    TEST_ASSERT_TRUE(writer.beginArray());
+    for (int i = 0; i < 20; i++)
+    {
+        TEST_ASSERT_TRUE(writer.value(i * 100));
+    }
+    TEST_ASSERT_TRUE(writer.endArray());
+    TEST_ASSERT_TRUE(writer.endObject());
+
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(writer.finalize(output, length));
+    TEST_ASSERT_EQUAL_UINT(capture.count, writer.pageCount());
+    TEST_ASSERT_TRUE(capture.count > 2);
+
+    // Every page is a complete document with the same envelope
+    const char envelope[] = "{\"dev\":\"x\",\"samples\":[";
+    String elements;
+    for (size_t i = 0; i < capture.count; i++)
+    {
+        const String &page = capture.pages[i];
+        TEST_ASSERT_TRUE(page.length() <= sizeof(smallBuffer));
+        TEST_ASSERT_EQUAL_STRING_LEN(envelope, page.c_str(), sizeof(envelope) - 1);
+        TEST_ASSERT_EQUAL_STRING("]}", page.c_str() + page.length() - 2);
+        if (i != 0)
+        {
+            elements += ",";
+        }
+        elements += String(page.c_str() + sizeof(envelope) - 1, page.length() - sizeof(envelope) - 1);
+    }
+    TEST_ASSERT_EQUAL_STRING("0,100,200,300,400,500,600,700,800,900,1000,"
+                             "1100,1200,1300,1400,1500,1600,1700,1800,1900",
+                             elements.c_str());
+}
+
+void test_pagination_moves_unfinished_element()
+{
+    uint8_t smallBuffer[32];
+    PageCapture capture = {};
+    JsonBufWriter writer(smallBuffer, sizeof(smallBuffer));
+    writer.setFlushHandler(capturePage, &capture);
+    writer.setPagination(true);
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    for (int i = 0; i < 4; i++)
+    {
+        TEST_ASSERT_TRUE(writer.beginObject());
+        TEST_ASSERT_TRUE(writer.key("id"));
+        TEST_ASSERT_TRUE(writer.value(i));
+        TEST_ASSERT_TRUE(writer.key("name"));
+        TEST_ASSERT_TRUE(writer.value("item"));
+        TEST_ASSERT_TRUE(writer.endObject());
+    }
+    TEST_ASSERT_TRUE(writer.endArray());
+
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(writer.finalize(output, length));
+    TEST_ASSERT_EQUAL_UINT(4, capture.count);
+    TEST_ASSERT_EQUAL_STRING("[{\"id\":0,\"name\":\"item\"}]", capture.pages[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("[{\"id\":3,\"name\":\"item\"}]", capture.pages[3].c_str());
+}
+
+void test_pagination_element_too_large()
+{
+    uint8_t smallBuffer[16];
+    PageCapture capture = {};
+    JsonBufWriter writer(smallBuffer, sizeof(smallBuffer));
+    writer.setFlushHandler(capturePage, &capture);
+    writer.setPagination(true);
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value(1));
+    TEST_ASSERT_FALSE(writer.value("longer than any page"));
+    TEST_ASSERT_FALSE(writer.ok());
+
+    // Objects alone cannot be paginated
+    capture.count = 0;
+    writer.reset(smallBuffer, sizeof(smallBuffer));
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("a"));
+    TEST_ASSERT_TRUE(writer.value(12345));
+    TEST_ASSERT_FALSE(writer.key("bb"));
+    TEST_ASSERT_EQUAL_UINT(0, capture.count);
+}
+
+void test_pagination_refuses_placeholders()
+{
+    // A page cut moves or delivers bytes, so a slot could no longer be filled in place
+    uint8_t smallBuffer[48];
+    PageCapture capture = {};
+    JsonBufWriter writer(smallBuffer, sizeof(smallBuffer));
+    writer.setFlushHandler(capturePage, &capture);
+    writer.setPagination(true);
+    JsonPlaceholder slot;
+
+    TEST_ASSERT_FALSE(writer.reserveLengthPrefix(slot));
+    TEST_ASSERT_FALSE(writer.ok());
+
+    writer.reset(smallBuffer, sizeof(smallBuffer));
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value(1));
+    TEST_ASSERT_FALSE(writer.reserveNumber(slot, 4));
+    TEST_ASSERT_FALSE(writer.ok());
+
+    // A slot reserved before pagination was enabled stops the page cut instead
+    writer.setPagination(false);
+    writer.reset(smallBuffer, sizeof(smallBuffer));
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("n"));
+    TEST_ASSERT_TRUE(writer.reserveNumber(slot, 4));
+    writer.setPagination(true);
+    TEST_ASSERT_TRUE(writer.key("a"));
+    TEST_ASSERT_TRUE(writer.beginArray());
+    bool written = true;
+    for (int i = 0; i < 20 && written; i++)
+    {
+        written = writer.value(i);
+    }
+    TEST_ASSERT_FALSE(written);
+    TEST_ASSERT_FALSE(writer.ok());
+    TEST_ASSERT_EQUAL_UINT(0, capture.count);
+    writer.setPagination(false);
+}
+
+// Best-effort tests
+void test_best_effort_drops_value_and_closes()
+{
+    uint8_t smallBuffer[32];
+    JsonBufWriter writer(smallBuffer, sizeof(smallBuffer));
+    writer.setBestEffort(true);
+
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("id"));
+    TEST_ASSERT_TRUE(writer.value(7));
+    TEST_ASSERT_TRUE(writer.key("data"));
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value(1));
+    TEST_ASSERT_TRUE(writer.value(2));
+    // The closing bytes stay reserved, so the failing value is refused instead
+    TEST_ASSERT_FALSE(writer.value("does not fit"));
+    TEST_ASSERT_TRUE(writer.ok());
+    TEST_ASSERT_TRUE(writer.value(3));
+    TEST_ASSERT_TRUE(writer.endArray());
+    TEST_ASSERT_TRUE(writer.endObject());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":7,\"data\":[1,2,3]}", result.c_str());
+    TEST_ASSERT_EQUAL_UINT(1, writer.droppedCount());
+}
+
+void test_best_effort_drops_key_with_value()
+{
+    uint8_t smallBuffer[24];
+    JsonBufWriter writer(smallBuffer, sizeof(smallBuffer));
+    writer.setBestEffort(true);
+
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("a"));
+    TEST_ASSERT_TRUE(writer.value(1));
+    TEST_ASSERT_TRUE(writer.key("name"));
+    TEST_ASSERT_FALSE(writer.value("too long for the rest"));
+    TEST_ASSERT_FALSE(writer.key("a much longer key"));
+    TEST_ASSERT_FALSE(writer.value(2)); // Value of the dropped key
+    TEST_ASSERT_TRUE(writer.key("b"));
+    TEST_ASSERT_TRUE(writer.value(true));
+    TEST_ASSERT_TRUE(writer.endObject());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1,\"b\":true}", result.c_str());
+    TEST_ASSERT_EQUAL_UINT(2, writer.droppedCount());
+}
+
+void test_best_effort_drops_container()
+{
+    uint8_t smallBuffer[15];
+    JsonBufWriter writer(smallBuffer, sizeof(smallBuffer));
+    writer.setBestEffort(true);
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value(123456));
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("k"));
+    TEST_ASSERT_FALSE(writer.value(1234));
+    TEST_ASSERT_TRUE(writer.endObject());
+    TEST_ASSERT_TRUE(writer.value(1));
+    TEST_ASSERT_FALSE(writer.beginArray());
+    // Everything up to the matching close belongs to the dropped container
+    TEST_ASSERT_FALSE(writer.value(2));
+    TEST_ASSERT_FALSE(writer.endArray());
+    TEST_ASSERT_TRUE(writer.endArray());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("[123456,{},1]", result.c_str());
+    TEST_ASSERT_EQUAL_UINT(2, writer.droppedCount());
+    TEST_ASSERT_TRUE(writer.ok());
+}
+
+// Placeholder tests
+void test_number_placeholder()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    JsonPlaceholder count;
+
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("count"));
+    TEST_ASSERT_TRUE(writer.reserveNumber(count, 4));
+    TEST_ASSERT_TRUE(writer.key("items"));
+    TEST_ASSERT_TRUE(writer.beginArray());
+    uint32_t items = 0;
+    for (; items < 12; items++)
+    {
+        TEST_ASSERT_TRUE(writer.value(items));
+    }
+    TEST_ASSERT_TRUE(writer.endArray());
+    TEST_ASSERT_TRUE(writer.endObject());
+    TEST_ASSERT_TRUE(writer.fill(count, items));
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"count\":12  ,\"items\":[0,1,2,3,4,5,6,7,8,9,10,11]}", result.c_str());
+}
+
+void test_number_placeholder_in_array()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    JsonPlaceholder first;
+    JsonPlaceholder second;
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.reserveNumber(first, 3));
+    TEST_ASSERT_TRUE(writer.reserveNumber(second, 3));
+    TEST_ASSERT_TRUE(writer.endArray());
+    TEST_ASSERT_TRUE(writer.fill(second, 999));
+
+    // An unfilled slot still reads as a valid number
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("[0  ,999]", result.c_str());
+
+    TEST_ASSERT_FALSE(writer.fill(first, 1000)); // Wider than the slot
+    TEST_ASSERT_FALSE(writer.ok());
+}
+
+void test_length_prefix()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    JsonPlaceholder prefix;
+
+    TEST_ASSERT_TRUE(writer.reserveLengthPrefix(prefix, 2));
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value("payload"));
+    TEST_ASSERT_TRUE(writer.endArray());
+    TEST_ASSERT_EQUAL_UINT(11, writer.documentLength());
+    TEST_ASSERT_TRUE(writer.fill(prefix, writer.documentLength()));
+
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(writer.finalize(output, length));
+    TEST_ASSERT_EQUAL_UINT(13, length);
+    TEST_ASSERT_EQUAL_UINT8(0x00, output[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x0B, output[1]);
+    TEST_ASSERT_EQUAL_STRING_LEN("[\"payload\"]", reinterpret_cast<const char *>(output + 2), 11);
+
+    // Little-endian prefix; a single root value is still enforced after it
+    JsonBufWriter little(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(little.reserveLengthPrefix(prefix, 4, false));
+    TEST_ASSERT_TRUE(little.value(300));
+    TEST_ASSERT_TRUE(little.fill(prefix, 0x01020304));
+    TEST_ASSERT_EQUAL_UINT8(0x04, little.data()[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x01, little.data()[3]);
+    TEST_ASSERT_FALSE(little.value(301));
+}
+
+void test_placeholder_errors()
+{
+    JsonPlaceholder slot = {};
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_FALSE(writer.fill(slot, 1)); // Never reserved
+    TEST_ASSERT_FALSE(writer.ok());
+
+    writer.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_FALSE(writer.reserveNumber(slot, JsonBufWriter::MAX_NUMBER_WIDTH + 1));
+
+    writer.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_FALSE(writer.reserveLengthPrefix(slot, 4)); // Document already started
+
+    writer.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(writer.reserveLengthPrefix(slot, 1));
+    TEST_ASSERT_FALSE(writer.fill(slot, 256)); // Does not fit in one byte
+
+    // Slots that already left the buffer cannot be patched
+    uint8_t other[16];
+    writer.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.reserveNumber(slot, 2));
+    writer.continueIn(other, sizeof(other));
+    TEST_ASSERT_TRUE(writer.endArray());
+    TEST_ASSERT_FALSE(writer.fill(slot, 5));
+}
+
+// Resumable state tests
+void test_continue_in_new_buffer()
+{
+    uint8_t first[16];
+    uint8_t second[64];
+    JsonBufWriter writer(first, sizeof(first));
+
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("a"));
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value(1));
+    String head(reinterpret_cast<const char *>(writer.data()), writer.size());
+
+    writer.continueIn(second, sizeof(second));
+    TEST_ASSERT_EQUAL_UINT(head.length(), writer.flushedSize());
+    TEST_ASSERT_TRUE(writer.value(2));
+    TEST_ASSERT_TRUE(writer.endArray());
+    TEST_ASSERT_TRUE(writer.key("b"));
+    TEST_ASSERT_TRUE(writer.value(true));
+    TEST_ASSERT_TRUE(writer.endObject());
+
+    head += getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":[1,2],\"b\":true}", head.c_str());
+}
+
+void test_save_and_restore_state()
+{
+    uint8_t first[32];
+    JsonBufWriter writer(first, sizeof(first));
+    writer.setFloatPrecision(1);
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value(1));
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("x"));
+    String head(reinterpret_cast<const char *>(writer.data()), writer.size());
+    JsonWriterState state = writer.saveState();
+    TEST_ASSERT_EQUAL_UINT(head.length(), state.offset);
+
+    // A different writer object resumes after the pending key
+    JsonBufWriter resumed(testBuffer, 0);
+    TEST_ASSERT_TRUE(resumed.restoreState(state, testBuffer, BUFFER_SIZE));
+    TEST_ASSERT_TRUE(resumed.value(2.25));
+    TEST_ASSERT_TRUE(resumed.endObject());
+    TEST_ASSERT_TRUE(resumed.value(3));
+    TEST_ASSERT_TRUE(resumed.endArray());
+    TEST_ASSERT_EQUAL_UINT(head.length(), resumed.flushedSize());
+
+    head += getJsonString(resumed);
+    TEST_ASSERT_EQUAL_STRING("[1,{\"x\":2.2},3]", head.c_str());
+}
+
+void test_restore_invalid_state()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    JsonWriterState state = writer.saveState();
+    state.depth = JsonBufWriter::MAX_DEPTH + 1;
+    TEST_ASSERT_FALSE(writer.restoreState(state, testBuffer, BUFFER_SIZE));
+    TEST_ASSERT_FALSE(writer.ok());
+
+    // Snapshots taken in the error state stay failed
+    JsonBufWriter failed(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_FALSE(failed.endArray());
+    TEST_ASSERT_FALSE(writer.restoreState(failed.saveState(), testBuffer, BUFFER_SIZE));
+}
+
+struct DoubleBuffer
+{
+    JsonBufWriter *writer;
+    uint8_t buffers[2][8];
+    String text;
+};
+
+static bool swapOnFlush(void *context, const uint8_t *data, size_t length)
+{
+    // Hand out the full buffer and continue in the other one
+    DoubleBuffer *target = static_cast<DoubleBuffer *>(context);
+    target->text += String(reinterpret_cast<const char *>(data), length);
+    target->writer->continueIn(target->buffers[data == target->buffers[0] ? 1 : 0], sizeof(target->buffers[0]));
+    return true;
+}
+
+void test_continue_in_from_flush_handler()
+{
+    static DoubleBuffer target;
+    target.text = "";
+    JsonBufWriter writer(target.buffers[0], sizeof(target.buffers[0]));
+    target.writer = &writer;
+    writer.setFlushHandler(swapOnFlush, &target);
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    for (int i = 0; i < 6; i++)
+    {
+        TEST_ASSERT_TRUE(writer.value("abc"));
+    }
+    TEST_ASSERT_TRUE(writer.endArray());
+    TEST_ASSERT_TRUE(writer.flush());
+
+    TEST_ASSERT_EQUAL_STRING("[\"abc\",\"abc\",\"abc\",\"abc\",\"abc\",\"abc\"]", target.text.c_str());
+    TEST_ASSERT_EQUAL_UINT(target.text.length(), writer.flushedSize());
+}
+
+// Edge cases and error handling
+void test_buffer_overflow()
+{
+    uint8_t smallBuffer[20]; // Increased size slightly
+    JsonBufWriter writer(smallBuffer, 20);
+
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("key"));
+    // This should fail due to buffer overflow
+    TEST_ASSERT_FALSE(writer.value("very long string that exceeds buffer capacity"));
+    TEST_ASSERT_FALSE(writer.ok());
+}
+
+void test_invalid_structure()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+
+    // Try to end object without starting one
+    TEST_ASSERT_FALSE(writer.endObject());
+    TEST_ASSERT_FALSE(writer.ok());
+}
+
+void test_mismatched_containers()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+
+    TEST_ASSERT_TRUE(writer.beginObject());
+    // Try to end with array instead of object
+    TEST_ASSERT_FALSE(writer.endArray());
+    TEST_ASSERT_FALSE(writer.ok());
+}
+
+void test_key_without_object()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    // Try to add key inside array
+    TEST_ASSERT_FALSE(writer.key("invalid"));
+    TEST_ASSERT_FALSE(writer.ok());
+}
+
+void test_multiple_root_values()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+
+    TEST_ASSERT_TRUE(writer.value("first"));
+    // Second root value should fail
+    TEST_ASSERT_FALSE(writer.value("second"));
+    TEST_ASSERT_FALSE(writer.ok());
+}
+
+void test_max_depth()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+
+    // Create nested structure up to max depth
+    for (int i = 0; i < JsonBufWriter::MAX_DEPTH; i++)
+    {
+        TEST_ASSERT_TRUE(writer.beginObject());
+        TEST_ASSERT_TRUE(writer.key("level"));
+    }
+
+    // This should fail (exceeds max depth)
+    TEST_ASSERT_FALSE(writer.beginObject());
+    TEST_ASSERT_FALSE(writer.ok());
+}
+
+// Reset and reuse tests
+void test_reset_functionality()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+
+    // First use
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("test"));
+    TEST_ASSERT_TRUE(writer.value(123));
+    TEST_ASSERT_TRUE(writer.endObject());
+
+    String result1 = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"test\":123}", result1.c_str());
+
+    // Reset and reuse
+    writer.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(writer.ok());
+    TEST_ASSERT_EQUAL_UINT32(0, writer.size());
+
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value("new"));
+    TEST_ASSERT_TRUE(writer.endArray());
+
+    String result2 = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("[\"new\"]", result2.c_str());
+}
+
+void test_float_precision_setting()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+
+    // Test with default precision
+    writer.setFloatPrecision(1);
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_TRUE(writer.value(3.14159));
+    TEST_ASSERT_TRUE(writer.endArray());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("[3.1]", result.c_str());
+}
+
+void test_float_scaled_integers()
+{
+    static const float samples[] = {21.375f, -0.5f, 0.0004f, -0.0004f, 1013.25f};
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    writer.setFloatPrecision(2);
+    writer.setFloatFormat(JsonBufWriter::FloatFormat::ScaledInteger);
+    TEST_ASSERT_EQUAL_UINT(100, static_cast<unsigned>(writer.floatScale()));
+
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("scale"));
+    TEST_ASSERT_TRUE(writer.value(writer.floatScale()));
+    TEST_ASSERT_TRUE(writer.key("t"));
+    TEST_ASSERT_TRUE(writer.value(3.14159));
+    TEST_ASSERT_TRUE(writer.key("v"));
+    TEST_ASSERT_TRUE(writer.array(samples));
+    TEST_ASSERT_TRUE(writer.endObject());
+
+    // Rounded half away from zero; tiny negatives do not become -0
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"scale\":100,\"t\":314,\"v\":[2138,-50,0,0,101325]}", result.c_str());
+
+    // Values that do not fit an int64 once scaled are errors
+    writer.reset(testBuffer, BUFFER_SIZE);
+    writer.setFloatFormat(JsonBufWriter::FloatFormat::ScaledInteger);
+    TEST_ASSERT_TRUE(writer.beginArray());
+    TEST_ASSERT_FALSE(writer.value(1e300));
+    writer.reset(testBuffer, BUFFER_SIZE);
+    writer.setFloatFormat(JsonBufWriter::FloatFormat::ScaledInteger);
+    static const double invalid[] = {1.0, NAN};
+    TEST_ASSERT_FALSE(writer.array(invalid));
+
+    // reset() returns to decimal output; the format survives saveState()/restoreState()
+    writer.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_EQUAL_UINT(1000, static_cast<unsigned>(writer.floatScale()));
+    writer.setFloatFormat(JsonBufWriter::FloatFormat::ScaledInteger);
+    TEST_ASSERT_TRUE(writer.beginArray());
+    JsonWriterState state = writer.saveState();
+    JsonBufWriter resumed(testBuffer, 0);
+    TEST_ASSERT_TRUE(resumed.restoreState(state, testBuffer, BUFFER_SIZE));
+    TEST_ASSERT_TRUE(resumed.value(-2.5f));
+    TEST_ASSERT_TRUE(resumed.endArray());
+    result = getJsonString(resumed);
+    TEST_ASSERT_EQUAL_STRING("-2500]", result.c_str());
+}
+
+// Performance/stress test
+void test_large_object()
+{
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+
+    TEST_ASSERT_TRUE(writer.beginObject());
+
+    // Add many key-value pairs
+    for (int i = 0; i < 10; i++)
+    {
+        char key[16];
+        sprintf(key, "key%d", i);
+        TEST_ASSERT_TRUE(writer.key(key));
+        TEST_ASSERT_TRUE(writer.value(i * 100));
+    }
+
+    TEST_ASSERT_TRUE(writer.endObject());
+    TEST_ASSERT_TRUE(writer.ok());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_TRUE(result.length() > 0);
+    TEST_ASSERT_TRUE(result.startsWith("{"));
+    TEST_ASSERT_TRUE(result.endsWith("}"));
+}
+
+// Test runner setup
+void setup()
+{
+    delay(2000); // Wait for serial monitor
+
+    UNITY_BEGIN();
+
+    // Basic functionality
+    RUN_TEST(test_empty_object);
+    RUN_TEST(test_empty_array);
+    RUN_TEST(test_simple_object);
+    RUN_TEST(test_simple_array);
+
+    // Data types
+    RUN_TEST(test_string_values);
+    RUN_TEST(test_boolean_values);
+    RUN_TEST(test_integer_values);
+    RUN_TEST(test_integer_limits);
+    RUN_TEST(test_float_values);
+    RUN_TEST(test_null_values);
+
+    // String escaping
+    RUN_TEST(test_string_escaping);
+    RUN_TEST(test_control_character_escaping);
+    RUN_TEST(test_long_string_escaping);
+
+    // UTF-8 handling
+    RUN_TEST(test_utf8_passthrough);
+    RUN_TEST(test_utf8_replace_invalid);
+    RUN_TEST(test_utf8_reject_invalid);
+    RUN_TEST(test_ascii_only_output);
 
     // Nested structures
     RUN_TEST(test_nested_objects);
@@ -435,6 +1637,60 @@ void setup()
 
     // Raw JSON
     RUN_TEST(test_raw_json);
+    RUN_TEST(test_raw_validated_minifies);
+    RUN_TEST(test_raw_validated_rejects_malformed);
+    RUN_TEST(test_raw_validated_reencodes_strings);
+    RUN_TEST(test_raw_key);
+    RUN_TEST(test_reserve_value);
+    RUN_TEST(test_reserve_value_errors);
+    RUN_TEST(test_value_timestamp);
+    RUN_TEST(test_identifier_values);
+    RUN_TEST(test_range_array_scalars);
+    RUN_TEST(test_range_object_and_serializer);
+    RUN_TEST(test_range_best_effort_matches_per_value);
+    RUN_TEST(test_embed_child_writer);
+    RUN_TEST(test_embed_rejects_incomplete_child);
+
+    // Tokens
+    RUN_TEST(test_token_key_and_value);
+    RUN_TEST(test_token_kind_mismatch);
+    RUN_TEST(test_token_too_long);
+
+    // Flush handler
+    RUN_TEST(test_flush_handler_streaming);
+    RUN_TEST(test_flush_handler_long_string);
+    RUN_TEST(test_flush_handler_raw_validated);
+    RUN_TEST(test_flush_handler_failure);
+    RUN_TEST(test_flush_keeps_root_state);
+
+    // JSON Lines
+    RUN_TEST(test_json_lines_records);
+    RUN_TEST(test_json_lines_partial_record);
+    RUN_TEST(test_json_lines_rollback);
+    RUN_TEST(test_json_lines_disabled_rejects_second_root);
+
+    // Pagination
+    RUN_TEST(test_pagination_splits_array);
+    RUN_TEST(test_pagination_moves_unfinished_element);
+    RUN_TEST(test_pagination_element_too_large);
+    RUN_TEST(test_pagination_refuses_placeholders);
+
+    // Best effort
+    RUN_TEST(test_best_effort_drops_value_and_closes);
+    RUN_TEST(test_best_effort_drops_key_with_value);
+    RUN_TEST(test_best_effort_drops_container);
+
+    // Placeholders
+    RUN_TEST(test_number_placeholder);
+    RUN_TEST(test_number_placeholder_in_array);
+    RUN_TEST(test_length_prefix);
+    RUN_TEST(test_placeholder_errors);
+
+    // Resumable state
+    RUN_TEST(test_continue_in_new_buffer);
+    RUN_TEST(test_save_and_restore_state);
+    RUN_TEST(test_restore_invalid_state);
+    RUN_TEST(test_continue_in_from_flush_handler);
 
     // Error handling
     RUN_TEST(test_buffer_overflow);
@@ -447,6 +1703,7 @@ void setup()
     // Reset and configuration
     RUN_TEST(test_reset_functionality);
     RUN_TEST(test_float_precision_setting);
+    RUN_TEST(test_float_scaled_integers);
 
     // Stress test
     RUN_TEST(test_large_object);
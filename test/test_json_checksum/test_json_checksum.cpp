@@ -0,0 +1,204 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "../../src/json_buffer_writer.hpp"
+#include "../../src/json_checksum.hpp"
+
+constexpr size_t BUFFER_SIZE = 4096;
+static uint8_t testBuffer[BUFFER_SIZE];
+
+void setUp(void)
+{
+    memset(testBuffer, 0, BUFFER_SIZE);
+}
+
+void tearDown(void)
+{
+}
+
+static uint32_t crcOf(const uint8_t *data, size_t length)
+{
+    JsonChecksum checksum(JsonChecksum::CRC32);
+    checksum.update(data, length);
+    return checksum.crc32();
+}
+
+static void writeReadings(JsonBufWriter &jw, int count)
+{
+    jw.beginObject();
+    jw.key("device");
+    jw.value("sensor-7");
+    jw.key("readings");
+    jw.beginArray();
+    for (int i = 0; i < count; i++)
+    {
+        jw.beginObject();
+        jw.key("t");
+        jw.value(static_cast<uint32_t>(1700000000u + i));
+        jw.key("v");
+        jw.value(i * 0.25);
+        jw.endObject();
+    }
+    jw.endArray();
+    jw.endObject();
+}
+
+void test_reference_values()
+{
+    const char *text = "Nobody inspects the spammish repetition";
+    const size_t length = strlen(text);
+    JsonChecksum checksum(JsonChecksum::CRC32 | JsonChecksum::XXHASH32);
+
+    // Uneven pieces exercise the partial-stripe and tail paths
+    for (size_t i = 0; i < length;)
+    {
+        size_t piece = (i % 7) + 1;
+        piece = piece < length - i ? piece : length - i;
+        checksum.update(reinterpret_cast<const uint8_t *>(text) + i, piece);
+        i += piece;
+    }
+    TEST_ASSERT_EQUAL_HEX32(0xAD4270ED, checksum.crc32());
+    TEST_ASSERT_EQUAL_HEX32(0xE2293B2F, checksum.xxhash32());
+    TEST_ASSERT_EQUAL_UINT(length, checksum.length());
+
+    checksum.reset();
+    TEST_ASSERT_EQUAL_HEX32(0x00000000, checksum.crc32());
+    TEST_ASSERT_EQUAL_HEX32(0x02CC5D05, checksum.xxhash32());
+    checksum.update(reinterpret_cast<const uint8_t *>("abc"), 3);
+    TEST_ASSERT_EQUAL_HEX32(0x352441C2, checksum.crc32());
+    TEST_ASSERT_EQUAL_HEX32(0x32D153FF, checksum.xxhash32());
+}
+
+void test_writer_matches_one_pass()
+{
+    JsonChecksum checksum(JsonChecksum::CRC32 | JsonChecksum::XXHASH32);
+    JsonBufWriter jw(testBuffer, BUFFER_SIZE);
+    jw.setChecksum(&checksum);
+    writeReadings(jw, 80);
+    // Most of the document is already hashed while writing
+    TEST_ASSERT_TRUE(checksum.length() + JsonBufWriter::CHECKSUM_CHUNK >= jw.size());
+
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(jw.finalize(output, length));
+    TEST_ASSERT_TRUE(length > 4 * JsonBufWriter::CHECKSUM_CHUNK);
+    TEST_ASSERT_EQUAL_UINT(length, checksum.length());
+    TEST_ASSERT_EQUAL_HEX32(crcOf(output, length), checksum.crc32());
+
+    JsonChecksum reference(JsonChecksum::XXHASH32);
+    reference.update(output, length);
+    TEST_ASSERT_EQUAL_HEX32(reference.xxhash32(), checksum.xxhash32());
+
+    // reset() starts a new document
+    jw.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_EQUAL_UINT(0, checksum.length());
+    TEST_ASSERT_TRUE(jw.value(true));
+    TEST_ASSERT_TRUE(jw.finalize(output, length));
+    TEST_ASSERT_EQUAL_HEX32(crcOf(reinterpret_cast<const uint8_t *>("true"), 4), checksum.crc32());
+}
+
+struct StreamCapture
+{
+    JsonChecksum *reference;
+    size_t calls;
+};
+
+static bool hashChunk(void *context, const uint8_t *data, size_t length)
+{
+    StreamCapture *capture = static_cast<StreamCapture *>(context);
+    capture->reference->update(data, length);
+    capture->calls++;
+    return true;
+}
+
+void test_writer_with_flush_handler()
+{
+    uint8_t smallBuffer[96];
+    JsonChecksum checksum(JsonChecksum::CRC32);
+    JsonChecksum reference(JsonChecksum::CRC32);
+    StreamCapture capture = {&reference, 0};
+
+    JsonBufWriter jw(smallBuffer, sizeof(smallBuffer));
+    jw.setChecksum(&checksum);
+    jw.setFlushHandler(hashChunk, &capture);
+    writeReadings(jw, 40);
+
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(jw.finalize(output, length));
+    TEST_ASSERT_TRUE(capture.calls > 1);
+    TEST_ASSERT_EQUAL_UINT(reference.length(), checksum.length());
+    TEST_ASSERT_EQUAL_HEX32(reference.crc32(), checksum.crc32());
+}
+
+void test_placeholders_hashed_after_fill()
+{
+    JsonChecksum checksum(JsonChecksum::CRC32);
+    JsonBufWriter jw(testBuffer, BUFFER_SIZE);
+    jw.setChecksum(&checksum);
+
+    JsonPlaceholder prefix;
+    JsonPlaceholder count;
+    TEST_ASSERT_TRUE(jw.reserveLengthPrefix(prefix));
+    TEST_ASSERT_TRUE(jw.beginObject());
+    TEST_ASSERT_TRUE(jw.key("count"));
+    TEST_ASSERT_TRUE(jw.reserveNumber(count, 4));
+    TEST_ASSERT_TRUE(jw.key("items"));
+    TEST_ASSERT_TRUE(jw.beginArray());
+    for (int i = 0; i < 300; i++)
+    {
+        TEST_ASSERT_TRUE(jw.value(i));
+    }
+    TEST_ASSERT_TRUE(jw.endArray());
+    TEST_ASSERT_TRUE(jw.endObject());
+    TEST_ASSERT_TRUE(jw.fill(count, 300));
+    TEST_ASSERT_TRUE(jw.fill(prefix, jw.documentLength()));
+
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(jw.finalize(output, length));
+    TEST_ASSERT_EQUAL_HEX32(crcOf(output, length), checksum.crc32());
+
+    // Once hashed, a slot can no longer change
+    TEST_ASSERT_FALSE(jw.fill(count, 301));
+}
+
+void test_dropped_values_not_hashed()
+{
+    uint8_t smallBuffer[1200];
+    JsonChecksum checksum(JsonChecksum::CRC32);
+    JsonBufWriter jw(smallBuffer, sizeof(smallBuffer));
+    jw.setChecksum(&checksum);
+    jw.setBestEffort(true);
+
+    TEST_ASSERT_TRUE(jw.beginArray());
+    while (jw.value("a reading that repeats until the buffer is full"))
+    {
+    }
+    TEST_ASSERT_TRUE(jw.droppedCount() > 0);
+    TEST_ASSERT_TRUE(jw.value(1));
+    TEST_ASSERT_TRUE(jw.endArray());
+
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(jw.finalize(output, length));
+    TEST_ASSERT_EQUAL_HEX32(crcOf(output, length), checksum.crc32());
+}
+
+void setup()
+{
+    delay(2000); // Wait for serial monitor
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_reference_values);
+    RUN_TEST(test_writer_matches_one_pass);
+    RUN_TEST(test_writer_with_flush_handler);
+    RUN_TEST(test_placeholders_hashed_after_fill);
+    RUN_TEST(test_dropped_values_not_hashed);
+
+    UNITY_END();
+}
+
+void loop()
+{
+}
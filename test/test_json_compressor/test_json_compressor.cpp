@@ -0,0 +1,369 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "../../src/json_compressor.hpp"
+
+constexpr size_t STAGING_SIZE = 64;
+constexpr size_t OUTPUT_SIZE = 2048;
+constexpr size_t DOCUMENT_SIZE = 4096;
+
+static uint8_t staging[STAGING_SIZE];
+static uint8_t compressed[OUTPUT_SIZE];
+static uint8_t decompressed[DOCUMENT_SIZE];
+static uint8_t reference[DOCUMENT_SIZE];
+
+// ----------------------------
+// Reference decoders (test only)
+// ----------------------------
+
+struct BitReader
+{
+    const uint8_t *data;
+    size_t length;
+    size_t bit;
+
+    bool msbFirst(uint8_t count, uint32_t &value)
+    {
+        value = 0;
+        for (uint8_t i = 0; i < count; ++i, ++bit)
+        {
+            if (bit / 8 >= length)
+            {
+                return false;
+            }
+            value = (value << 1) | ((data[bit / 8] >> (7 - bit % 8)) & 1u);
+        }
+        return true;
+    }
+
+    bool lsbFirst(uint8_t count, uint32_t &value)
+    {
+        value = 0;
+        for (uint8_t i = 0; i < count; ++i, ++bit)
+        {
+            if (bit / 8 >= length)
+            {
+                return false;
+            }
+            value |= static_cast<uint32_t>((data[bit / 8] >> (bit % 8)) & 1u) << i;
+        }
+        return true;
+    }
+
+    // Huffman codes are stored most significant bit first within the LSB-first stream
+    bool huffman(uint8_t count, uint32_t &value)
+    {
+        value = 0;
+        for (uint8_t i = 0; i < count; ++i)
+        {
+            uint32_t b;
+            if (!lsbFirst(1, b))
+            {
+                return false;
+            }
+            value = (value << 1) | b;
+        }
+        return true;
+    }
+};
+
+static size_t heatshrinkDecode(const uint8_t *in, size_t inLength, uint8_t windowBits, uint8_t lookaheadBits, uint8_t *out)
+{
+    BitReader reader{in, inLength, 0};
+    size_t produced = 0;
+    uint32_t flag;
+    while (reader.msbFirst(1, flag))
+    {
+        uint32_t a, b;
+        if (flag)
+        {
+            if (!reader.msbFirst(8, a))
+            {
+                break; // Zero padding
+            }
+            out[produced++] = static_cast<uint8_t>(a);
+        }
+        else
+        {
+            if (!reader.msbFirst(windowBits, a) || !reader.msbFirst(lookaheadBits, b))
+            {
+                break;
+            }
+            for (uint32_t i = 0; i <= b; ++i, ++produced)
+            {
+                out[produced] = out[produced - (a + 1)];
+            }
+        }
+    }
+    return produced;
+}
+
+static size_t inflateFixed(const uint8_t *in, size_t inLength, uint8_t *out)
+{
+    static const uint16_t lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+                                            31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const uint8_t lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                            2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const uint16_t distanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                              193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                                              6145, 8193, 12289, 16385, 24577};
+    static const uint8_t distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                              6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    BitReader reader{in, inLength, 0};
+    size_t produced = 0;
+    uint32_t final = 0;
+    while (!final)
+    {
+        uint32_t type;
+        if (!reader.lsbFirst(1, final) || !reader.lsbFirst(2, type) || type != 1)
+        {
+            return 0;
+        }
+        for (;;)
+        {
+            uint32_t code, more, symbol;
+            if (!reader.huffman(7, code))
+            {
+                return 0;
+            }
+            if (code <= 0x17)
+            {
+                symbol = 256 + code;
+            }
+            else
+            {
+                reader.huffman(1, more);
+                code = (code << 1) | more;
+                if (code >= 0x30 && code <= 0xBF)
+                {
+                    symbol = code - 0x30;
+                }
+                else if (code >= 0xC0 && code <= 0xC7)
+                {
+                    symbol = 280 + code - 0xC0;
+                }
+                else
+                {
+                    reader.huffman(1, more);
+                    symbol = 144 + ((code << 1) | more) - 0x190;
+                }
+            }
+
+            if (symbol < 256)
+            {
+                out[produced++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+            if (symbol == 256)
+            {
+                break;
+            }
+
+            uint32_t extra, d;
+            reader.lsbFirst(lengthExtra[symbol - 257], extra);
+            uint32_t length = lengthBase[symbol - 257] + extra;
+            reader.huffman(5, d);
+            reader.lsbFirst(distanceExtra[d], extra);
+            uint32_t distance = distanceBase[d] + extra;
+            for (uint32_t i = 0; i < length; ++i, ++produced)
+            {
+                out[produced] = out[produced - distance];
+            }
+        }
+    }
+    return produced;
+}
+
+// ----------------------------
+// Helpers
+// ----------------------------
+
+// Telemetry-like document: repetitive keys with varying numbers
+static size_t writeDocument(JsonBufWriter &jw, int records)
+{
+    jw.beginArray();
+    for (int i = 0; i < records; ++i)
+    {
+        jw.beginObject();
+        jw.key("sensor");
+        jw.value("temperature");
+        jw.key("seq");
+        jw.value(static_cast<int32_t>(i));
+        jw.key("value");
+        jw.value(static_cast<int32_t>(2000 + (i * 37) % 100));
+        jw.key("ok");
+        jw.value(i % 5 != 0);
+        jw.endObject();
+    }
+    jw.endArray();
+    return jw.size() + jw.flushedSize();
+}
+
+static size_t writeReference(int records)
+{
+    JsonBufWriter jw(reference, DOCUMENT_SIZE);
+    writeDocument(jw, records);
+    TEST_ASSERT_TRUE(jw.ok());
+    return jw.size();
+}
+
+void setUp(void)
+{
+    memset(compressed, 0, OUTPUT_SIZE);
+    memset(decompressed, 0, DOCUMENT_SIZE);
+}
+
+void tearDown(void)
+{
+}
+
+// ----------------------------
+// Tests
+// ----------------------------
+
+void test_heatshrink_round_trip()
+{
+    size_t expectedLength = writeReference(40);
+
+    static JsonCompressionSink<JsonHeatshrinkEncoder<8, 4>> sink(compressed, OUTPUT_SIZE);
+    sink.output().reset(compressed, OUTPUT_SIZE);
+    JsonBufWriter jw(staging, STAGING_SIZE);
+    sink.attach(jw);
+    writeDocument(jw, 40);
+    TEST_ASSERT_TRUE(sink.finish(jw));
+
+    size_t compressedLength = sink.output().size();
+    TEST_ASSERT_TRUE(compressedLength < expectedLength / 3);
+
+    size_t length = heatshrinkDecode(compressed, compressedLength, 8, 4, decompressed);
+    TEST_ASSERT_EQUAL_UINT(expectedLength, length);
+    TEST_ASSERT_EQUAL_MEMORY(reference, decompressed, expectedLength);
+}
+
+void test_heatshrink_wider_window()
+{
+    size_t expectedLength = writeReference(60);
+
+    static JsonCompressionSink<JsonHeatshrinkEncoder<10, 5>> sink(compressed, OUTPUT_SIZE);
+    sink.output().reset(compressed, OUTPUT_SIZE);
+    JsonBufWriter jw(staging, STAGING_SIZE);
+    sink.attach(jw);
+    writeDocument(jw, 60);
+    TEST_ASSERT_TRUE(sink.finish(jw));
+
+    size_t length = heatshrinkDecode(compressed, sink.output().size(), 10, 5, decompressed);
+    TEST_ASSERT_EQUAL_UINT(expectedLength, length);
+    TEST_ASSERT_EQUAL_MEMORY(reference, decompressed, expectedLength);
+}
+
+void test_deflate_round_trip()
+{
+    size_t expectedLength = writeReference(60);
+
+    static JsonCompressionSink<JsonDeflateEncoder<10>> sink(compressed, OUTPUT_SIZE);
+    sink.output().reset(compressed, OUTPUT_SIZE);
+    JsonBufWriter jw(staging, STAGING_SIZE);
+    sink.attach(jw);
+    writeDocument(jw, 60);
+    TEST_ASSERT_TRUE(sink.finish(jw));
+
+    size_t compressedLength = sink.output().size();
+    TEST_ASSERT_TRUE(compressedLength < expectedLength / 3);
+
+    size_t length = inflateFixed(compressed, compressedLength, decompressed);
+    TEST_ASSERT_EQUAL_UINT(expectedLength, length);
+    TEST_ASSERT_EQUAL_MEMORY(reference, decompressed, expectedLength);
+}
+
+void test_empty_and_tiny_documents()
+{
+    static JsonCompressionSink<JsonDeflateEncoder<9>> sink(compressed, OUTPUT_SIZE);
+    sink.output().reset(compressed, OUTPUT_SIZE);
+    JsonBufWriter jw(staging, STAGING_SIZE);
+    sink.attach(jw);
+    TEST_ASSERT_TRUE(jw.value(true));
+    TEST_ASSERT_TRUE(sink.finish(jw));
+
+    size_t length = inflateFixed(compressed, sink.output().size(), decompressed);
+    TEST_ASSERT_EQUAL_UINT(4, length);
+    TEST_ASSERT_EQUAL_MEMORY("true", decompressed, 4);
+}
+
+static size_t downstreamBytes = 0;
+
+static bool countDownstream(void *context, const uint8_t *data, size_t length)
+{
+    (void)context;
+    memcpy(decompressed + downstreamBytes, data, length); // Collect compressed chunks
+    downstreamBytes += length;
+    return true;
+}
+
+void test_output_streams_through_handler()
+{
+    size_t expectedLength = writeReference(60);
+
+    static uint8_t smallOutput[16];
+    static JsonCompressionSink<JsonHeatshrinkEncoder<8, 4>> sink(smallOutput, sizeof(smallOutput));
+    downstreamBytes = 0;
+    sink.output().setFlushHandler(countDownstream, nullptr);
+
+    JsonBufWriter jw(staging, STAGING_SIZE);
+    sink.attach(jw);
+    writeDocument(jw, 60);
+    TEST_ASSERT_TRUE(sink.finish(jw));
+    TEST_ASSERT_TRUE(sink.output().flush());
+    TEST_ASSERT_EQUAL_UINT(downstreamBytes, sink.output().totalSize());
+
+    memcpy(compressed, decompressed, downstreamBytes);
+    size_t length = heatshrinkDecode(compressed, downstreamBytes, 8, 4, decompressed);
+    TEST_ASSERT_EQUAL_UINT(expectedLength, length);
+    TEST_ASSERT_EQUAL_MEMORY(reference, decompressed, expectedLength);
+}
+
+void test_output_overflow_sets_error()
+{
+    static uint8_t tinyOutput[8];
+    static JsonCompressionSink<JsonHeatshrinkEncoder<8, 4>> sink(tinyOutput, sizeof(tinyOutput));
+    JsonBufWriter jw(staging, STAGING_SIZE);
+    sink.attach(jw);
+    writeDocument(jw, 20);
+    TEST_ASSERT_FALSE(jw.ok());
+    TEST_ASSERT_FALSE(sink.finish(jw));
+}
+
+void test_output_flush_without_handler()
+{
+    uint8_t bytes[2];
+    JsonCompressedOutput output(bytes, sizeof(bytes));
+    TEST_ASSERT_TRUE(output.put('a'));
+    TEST_ASSERT_TRUE(output.flush()); // Nothing to hand over to: the byte stays
+    TEST_ASSERT_TRUE(output.ok());
+    TEST_ASSERT_EQUAL_UINT(1, output.size());
+
+    TEST_ASSERT_TRUE(output.put('b'));
+    TEST_ASSERT_FALSE(output.put('c'));
+    TEST_ASSERT_FALSE(output.ok());
+    TEST_ASSERT_FALSE(output.flush());
+}
+
+void setup()
+{
+    delay(2000); // Wait for serial monitor
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_heatshrink_round_trip);
+    RUN_TEST(test_heatshrink_wider_window);
+    RUN_TEST(test_deflate_round_trip);
+    RUN_TEST(test_empty_and_tiny_documents);
+    RUN_TEST(test_output_streams_through_handler);
+    RUN_TEST(test_output_overflow_sets_error);
+    RUN_TEST(test_output_flush_without_handler);
+
+    UNITY_END();
+}
+
+void loop()
+{
+}
@@ -0,0 +1,225 @@
+#include <unity.h>
+#if defined(ARDUINO)
+#include <Arduino.h>
+#endif
+#include <string.h>
+#include "../../src/json_coroutine.hpp"
+
+// Runs wherever the toolchain supports C++20 coroutines, e.g. `pio test -e native`
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+#if defined(JSON_BUF_WRITER_HAS_COROUTINES)
+
+constexpr size_t CHUNK_BUFFER_SIZE = 48;
+constexpr size_t DOCUMENT_SIZE = 2048;
+
+struct Collected
+{
+    char text[DOCUMENT_SIZE];
+    size_t length;
+    size_t chunks;
+};
+
+static void append(Collected &out, const uint8_t *data, size_t length)
+{
+    TEST_ASSERT_TRUE(out.length + length < DOCUMENT_SIZE);
+    memcpy(out.text + out.length, data, length);
+    out.length += length;
+    out.text[out.length] = '\0';
+    out.chunks++;
+}
+
+static void writeItem(JsonBufWriter &jw, uint32_t id)
+{
+    jw.beginObject();
+    jw.key("id");
+    jw.value(id);
+    jw.key("name");
+    jw.value("item");
+    jw.endObject();
+}
+
+JsonChunkGenerator writeItems(JsonBufWriter &jw, uint32_t count, uint32_t base)
+{
+    jw.beginArray();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        writeItem(jw, base + i);
+        co_yield JsonRoom{40};
+    }
+    jw.endArray();
+}
+
+static void writeReference(Collected &out, uint32_t count, uint32_t base)
+{
+    static uint8_t buffer[DOCUMENT_SIZE];
+    JsonBufWriter jw(buffer, sizeof(buffer));
+    jw.beginArray();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        writeItem(jw, base + i);
+    }
+    jw.endArray();
+
+    const uint8_t *data;
+    size_t length;
+    TEST_ASSERT_TRUE(jw.finalize(data, length));
+    out.length = 0;
+    out.chunks = 0;
+    append(out, data, length);
+}
+
+void test_chunks_form_document()
+{
+    static uint8_t buffer[CHUNK_BUFFER_SIZE];
+    static Collected out;
+    static Collected expected;
+    out.length = 0;
+    out.chunks = 0;
+
+    JsonBufWriter jw(buffer, sizeof(buffer));
+    JsonChunkGenerator gen = writeItems(jw, 20, 0);
+    while (gen.next())
+    {
+        TEST_ASSERT_TRUE(gen.size() <= CHUNK_BUFFER_SIZE);
+        append(out, gen.data(), gen.size());
+    }
+
+    TEST_ASSERT_TRUE(gen.done());
+    TEST_ASSERT_TRUE(gen.ok());
+    TEST_ASSERT_TRUE(out.chunks > 1);
+    writeReference(expected, 20, 0);
+    TEST_ASSERT_EQUAL_STRING(expected.text, out.text);
+}
+
+void test_generators_interleave()
+{
+    static uint8_t bufferA[CHUNK_BUFFER_SIZE];
+    static uint8_t bufferB[CHUNK_BUFFER_SIZE];
+    static Collected outA;
+    static Collected outB;
+    static Collected expected;
+    outA.length = outA.chunks = 0;
+    outB.length = outB.chunks = 0;
+
+    JsonBufWriter jwA(bufferA, sizeof(bufferA));
+    JsonBufWriter jwB(bufferB, sizeof(bufferB));
+    JsonChunkGenerator genA = writeItems(jwA, 12, 100);
+    JsonChunkGenerator genB = writeItems(jwB, 30, 5000);
+
+    // Round-robin, one chunk per turn
+    while (!genA.done() || !genB.done())
+    {
+        if (genA.next())
+        {
+            append(outA, genA.data(), genA.size());
+        }
+        if (genB.next())
+        {
+            append(outB, genB.data(), genB.size());
+        }
+    }
+
+    TEST_ASSERT_TRUE(genA.ok());
+    TEST_ASSERT_TRUE(genB.ok());
+    writeReference(expected, 12, 100);
+    TEST_ASSERT_EQUAL_STRING(expected.text, outA.text);
+    writeReference(expected, 30, 5000);
+    TEST_ASSERT_EQUAL_STRING(expected.text, outB.text);
+}
+
+JsonChunkGenerator writeOversized(JsonBufWriter &jw)
+{
+    jw.beginArray();
+    co_yield JsonRoom{8};
+    jw.value("this string is longer than the whole chunk buffer");
+    co_yield JsonRoom{8};
+    jw.endArray();
+}
+
+void test_overflow_between_checkpoints_fails()
+{
+    static uint8_t buffer[CHUNK_BUFFER_SIZE];
+    JsonBufWriter jw(buffer, sizeof(buffer));
+    JsonChunkGenerator gen = writeOversized(jw);
+
+    while (gen.next())
+    {
+    }
+    TEST_ASSERT_TRUE(gen.done());
+    TEST_ASSERT_FALSE(gen.ok());
+    TEST_ASSERT_FALSE(jw.ok());
+}
+
+JsonChunkGenerator writeUnclosed(JsonBufWriter &jw)
+{
+    jw.beginObject();
+    co_yield JsonRoom{8};
+    jw.key("open");
+    jw.value(true);
+}
+
+void test_incomplete_document_fails()
+{
+    static uint8_t buffer[CHUNK_BUFFER_SIZE];
+    JsonBufWriter jw(buffer, sizeof(buffer));
+    JsonChunkGenerator gen = writeUnclosed(jw);
+
+    while (gen.next())
+    {
+    }
+    TEST_ASSERT_FALSE(gen.ok());
+}
+
+static int runTests()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_chunks_form_document);
+    RUN_TEST(test_generators_interleave);
+    RUN_TEST(test_overflow_between_checkpoints_fails);
+    RUN_TEST(test_incomplete_document_fails);
+
+    return UNITY_END();
+}
+
+#else
+
+void test_coroutines_unavailable()
+{
+    TEST_IGNORE_MESSAGE("Compiler without C++20 coroutine support");
+}
+
+static int runTests()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_coroutines_unavailable);
+    return UNITY_END();
+}
+
+#endif
+
+#if defined(ARDUINO)
+void setup()
+{
+    delay(2000); // Wait for serial monitor
+
+    runTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runTests();
+}
+#endif
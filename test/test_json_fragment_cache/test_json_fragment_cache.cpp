@@ -0,0 +1,310 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "../../src/json_fragment_cache.hpp"
+
+constexpr size_t BUFFER_SIZE = 512;
+static uint8_t testBuffer[BUFFER_SIZE];
+
+constexpr size_t ENTRY_COUNT = 2;
+constexpr size_t SLOT_SIZE = 64;
+static JsonFragmentCacheEntry entries[ENTRY_COUNT];
+static uint8_t storage[ENTRY_COUNT * SLOT_SIZE];
+
+enum FragmentId : uint32_t
+{
+    DEVICE_INFO = 1,
+    CONFIG = 2,
+    EXTRA = 3
+};
+
+static int deviceWrites;
+
+void setUp(void)
+{
+    memset(testBuffer, 0, BUFFER_SIZE);
+    deviceWrites = 0;
+}
+
+void tearDown(void)
+{
+}
+
+static String getJsonString(JsonBufWriter &writer)
+{
+    const uint8_t *output;
+    size_t length;
+    if (writer.finalize(output, length))
+    {
+        return String(reinterpret_cast<const char *>(output), length);
+    }
+    return "";
+}
+
+static void writeDeviceInfo(JsonBufWriter &jw, uint32_t version)
+{
+    deviceWrites++;
+    jw.beginObject();
+    jw.key("model");
+    jw.value("GW-1");
+    jw.key("fw");
+    jw.value(version);
+    jw.endObject();
+}
+
+static String writeStatus(JsonFragmentCache &cache, uint32_t version, int32_t reading)
+{
+    JsonBufWriter jw(testBuffer, BUFFER_SIZE);
+    jw.beginObject();
+    jw.key("reading");
+    jw.value(reading);
+    jw.key("device");
+    if (!jw.beginCached(cache, DEVICE_INFO, version))
+    {
+        writeDeviceInfo(jw, version);
+        TEST_ASSERT_TRUE(jw.endCached(cache));
+    }
+    jw.endObject();
+    TEST_ASSERT_TRUE(jw.ok());
+    return getJsonString(jw);
+}
+
+void test_replays_unchanged_fragment()
+{
+    JsonFragmentCache cache(entries, ENTRY_COUNT, storage, sizeof(storage));
+
+    String first = writeStatus(cache, 7, 1);
+    String second = writeStatus(cache, 7, 2);
+    TEST_ASSERT_EQUAL_INT(1, deviceWrites);
+    TEST_ASSERT_EQUAL_STRING("{\"reading\":1,\"device\":{\"model\":\"GW-1\",\"fw\":7}}", first.c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"reading\":2,\"device\":{\"model\":\"GW-1\",\"fw\":7}}", second.c_str());
+}
+
+void test_new_version_rerecords()
+{
+    JsonFragmentCache cache(entries, ENTRY_COUNT, storage, sizeof(storage));
+
+    writeStatus(cache, 7, 1);
+    String updated = writeStatus(cache, 8, 1);
+    String replayed = writeStatus(cache, 8, 1);
+    TEST_ASSERT_EQUAL_INT(2, deviceWrites);
+    TEST_ASSERT_EQUAL_STRING(updated.c_str(), replayed.c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"reading\":1,\"device\":{\"model\":\"GW-1\",\"fw\":8}}", replayed.c_str());
+}
+
+void test_array_elements_and_members()
+{
+    JsonFragmentCache cache(entries, ENTRY_COUNT, storage, sizeof(storage));
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        JsonBufWriter jw(testBuffer, BUFFER_SIZE);
+        TEST_ASSERT_TRUE(jw.beginArray());
+        TEST_ASSERT_TRUE(jw.value(0));
+        // Cached array element after a sibling: the separator is not part of the fragment
+        if (!jw.beginCached(cache, DEVICE_INFO, 1))
+        {
+            writeDeviceInfo(jw, 1);
+            TEST_ASSERT_TRUE(jw.endCached(cache));
+        }
+        TEST_ASSERT_TRUE(jw.beginObject());
+        TEST_ASSERT_TRUE(jw.key("a"));
+        TEST_ASSERT_TRUE(jw.value(true));
+        // Cached object members
+        if (!jw.beginCached(cache, CONFIG, 1))
+        {
+            jw.key("rate");
+            jw.value(10);
+            jw.key("mode");
+            jw.value("eco");
+            TEST_ASSERT_TRUE(jw.endCached(cache));
+        }
+        TEST_ASSERT_TRUE(jw.key("z"));
+        TEST_ASSERT_TRUE(jw.null());
+        TEST_ASSERT_TRUE(jw.endObject());
+        TEST_ASSERT_TRUE(jw.endArray());
+
+        String result = getJsonString(jw);
+        TEST_ASSERT_EQUAL_STRING("[0,{\"model\":\"GW-1\",\"fw\":1},{\"a\":true,\"rate\":10,\"mode\":\"eco\",\"z\":null}]",
+                                 result.c_str());
+    }
+    TEST_ASSERT_EQUAL_INT(1, deviceWrites);
+}
+
+void test_oversized_fragment_not_cached()
+{
+    JsonFragmentCache cache(entries, ENTRY_COUNT, storage, sizeof(storage));
+    const char *longText = "this value is longer than a single sixty-four byte cache slot....";
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        JsonBufWriter jw(testBuffer, BUFFER_SIZE);
+        TEST_ASSERT_FALSE(jw.beginCached(cache, EXTRA, 1));
+        TEST_ASSERT_TRUE(jw.value(longText));
+        TEST_ASSERT_TRUE(jw.endCached(cache));
+        TEST_ASSERT_TRUE(jw.ok());
+    }
+}
+
+void test_eviction_round_robin()
+{
+    JsonFragmentCache cache(entries, ENTRY_COUNT, storage, sizeof(storage));
+    size_t length;
+
+    TEST_ASSERT_TRUE(cache.store(DEVICE_INFO, 1, reinterpret_cast<const uint8_t *>("1"), 1));
+    TEST_ASSERT_TRUE(cache.store(CONFIG, 1, reinterpret_cast<const uint8_t *>("2"), 1));
+    TEST_ASSERT_TRUE(cache.store(EXTRA, 1, reinterpret_cast<const uint8_t *>("3"), 1));
+    TEST_ASSERT_NULL(cache.lookup(DEVICE_INFO, 1, length));
+    TEST_ASSERT_NOT_NULL(cache.lookup(CONFIG, 1, length));
+    TEST_ASSERT_NOT_NULL(cache.lookup(EXTRA, 1, length));
+
+    cache.invalidate(CONFIG);
+    TEST_ASSERT_NULL(cache.lookup(CONFIG, 1, length));
+    cache.clear();
+    TEST_ASSERT_NULL(cache.lookup(EXTRA, 1, length));
+}
+
+static bool keepLastPage(void *context, const uint8_t *data, size_t length)
+{
+    *static_cast<String *>(context) = String(reinterpret_cast<const char *>(data), length);
+    return true;
+}
+
+void test_page_cut_during_recording_not_cached()
+{
+    JsonFragmentCache cache(entries, ENTRY_COUNT, storage, sizeof(storage));
+    uint8_t smallBuffer[24];
+    JsonBufWriter jw(smallBuffer, sizeof(smallBuffer));
+    String page;
+    jw.setFlushHandler(keepLastPage, &page);
+    jw.setPagination(true);
+
+    // The element being recorded is moved to the next page while it is written
+    TEST_ASSERT_TRUE(jw.beginArray());
+    TEST_ASSERT_TRUE(jw.value(1000));
+    TEST_ASSERT_TRUE(jw.value(2000));
+    TEST_ASSERT_FALSE(jw.beginCached(cache, EXTRA, 1));
+    TEST_ASSERT_TRUE(jw.beginArray());
+    TEST_ASSERT_TRUE(jw.value(123456));
+    TEST_ASSERT_TRUE(jw.value(789012));
+    TEST_ASSERT_TRUE(jw.endArray());
+    TEST_ASSERT_EQUAL_UINT(1, jw.pageCount());
+    TEST_ASSERT_TRUE(jw.endCached(cache));
+    TEST_ASSERT_TRUE(jw.endArray());
+
+    size_t length;
+    TEST_ASSERT_NULL(cache.lookup(EXTRA, 1, length));
+    const uint8_t *output;
+    TEST_ASSERT_TRUE(jw.finalize(output, length));
+    TEST_ASSERT_EQUAL_STRING("[[123456,789012]]", page.c_str());
+}
+
+void test_json_lines_records_replayed()
+{
+    JsonFragmentCache cache(entries, ENTRY_COUNT, storage, sizeof(storage));
+    JsonBufWriter jw(testBuffer, BUFFER_SIZE);
+    jw.setJsonLines(true);
+
+    for (int pass = 0; pass < 3; pass++)
+    {
+        if (!jw.beginCached(cache, DEVICE_INFO, 1))
+        {
+            writeDeviceInfo(jw, 1);
+            TEST_ASSERT_TRUE(jw.endCached(cache));
+        }
+    }
+    TEST_ASSERT_TRUE(jw.ok());
+    TEST_ASSERT_EQUAL_INT(1, deviceWrites);
+    TEST_ASSERT_EQUAL_UINT(3, jw.recordCount());
+
+    // One newline per record, no empty lines
+    String result = getJsonString(jw);
+    TEST_ASSERT_EQUAL_STRING("{\"model\":\"GW-1\",\"fw\":1}\n{\"model\":\"GW-1\",\"fw\":1}\n"
+                             "{\"model\":\"GW-1\",\"fw\":1}\n",
+                             result.c_str());
+}
+
+static void writeDevice(JsonBufWriter &jw, JsonFragmentCache &cache)
+{
+    jw.beginObject();
+    jw.key("device");
+    if (!jw.beginCached(cache, DEVICE_INFO, 1))
+    {
+        jw.beginObject();
+        jw.key("model");
+        jw.value("a model name too long for a small buffer");
+        jw.key("fw");
+        jw.value("1.2.3");
+        jw.endObject();
+        TEST_ASSERT_TRUE(jw.endCached(cache));
+    }
+    jw.endObject();
+}
+
+void test_best_effort_drops_not_cached()
+{
+    // A value that lost content, or was dropped with its key, must not be replayed later
+    static const size_t sizes[] = {40, 22};
+    for (size_t size : sizes)
+    {
+        JsonFragmentCache cache(entries, ENTRY_COUNT, storage, sizeof(storage));
+        JsonBufWriter jw(testBuffer, size);
+        jw.setBestEffort(true);
+        writeDevice(jw, cache);
+        TEST_ASSERT_TRUE(jw.ok());
+        TEST_ASSERT_TRUE(jw.droppedCount() > 0);
+        size_t length;
+        TEST_ASSERT_NULL(cache.lookup(DEVICE_INFO, 1, length));
+
+        jw.reset(testBuffer, BUFFER_SIZE);
+        writeDevice(jw, cache);
+        TEST_ASSERT_EQUAL_UINT(0, jw.droppedCount());
+        String result = getJsonString(jw);
+        TEST_ASSERT_EQUAL_STRING("{\"device\":{\"model\":\"a model name too long for a small buffer\",\"fw\":\"1.2.3\"}}",
+                                 result.c_str());
+    }
+}
+
+void test_unbalanced_recording_fails()
+{
+    JsonFragmentCache cache(entries, ENTRY_COUNT, storage, sizeof(storage));
+
+    JsonBufWriter jw(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_FALSE(jw.endCached(cache)); // Nothing recorded
+    TEST_ASSERT_FALSE(jw.ok());
+
+    jw.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(jw.beginArray());
+    TEST_ASSERT_FALSE(jw.beginCached(cache, DEVICE_INFO, 1));
+    TEST_ASSERT_TRUE(jw.beginObject());
+    TEST_ASSERT_FALSE(jw.endCached(cache)); // Object left open
+    TEST_ASSERT_FALSE(jw.ok());
+
+    jw.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(jw.beginArray());
+    TEST_ASSERT_FALSE(jw.beginCached(cache, DEVICE_INFO, 1));
+    TEST_ASSERT_FALSE(jw.beginCached(cache, CONFIG, 1)); // Nested recording
+    TEST_ASSERT_FALSE(jw.ok());
+}
+
+void setup()
+{
+    delay(2000); // Wait for serial monitor
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_replays_unchanged_fragment);
+    RUN_TEST(test_new_version_rerecords);
+    RUN_TEST(test_array_elements_and_members);
+    RUN_TEST(test_oversized_fragment_not_cached);
+    RUN_TEST(test_eviction_round_robin);
+    RUN_TEST(test_page_cut_during_recording_not_cached);
+    RUN_TEST(test_json_lines_records_replayed);
+    RUN_TEST(test_best_effort_drops_not_cached);
+    RUN_TEST(test_unbalanced_recording_fails);
+
+    UNITY_END();
+}
+
+void loop()
+{
+}
@@ -0,0 +1,213 @@
+#include <unity.h>
+#if defined(ARDUINO)
+#include <Arduino.h>
+#endif
+#include <string.h>
+#include "../../src/json_mmap_sink.hpp"
+
+// Runs on Linux hosts, e.g. `pio test -e native`
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+#if defined(JSON_BUF_WRITER_HAS_MMAP)
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static const char *outputPath()
+{
+    static char path[256];
+    const char *dir = getenv("TMPDIR");
+    snprintf(path, sizeof(path), "%s/json_mmap_sink_%ld.json", dir ? dir : "/tmp", static_cast<long>(getpid()));
+    return path;
+}
+
+static size_t readFile(const char *path, uint8_t *out, size_t capacity)
+{
+    FILE *file = fopen(path, "rb");
+    TEST_ASSERT_NOT_NULL(file);
+    const size_t length = fread(out, 1, capacity, file);
+    TEST_ASSERT_EQUAL_INT(EOF, fgetc(file));
+    fclose(file);
+    return length;
+}
+
+static void writeArchive(JsonBufWriter &jw, uint32_t records)
+{
+    jw.beginArray();
+    for (uint32_t i = 0; i < records; ++i)
+    {
+        jw.beginObject();
+        jw.key("id");
+        jw.value(i);
+        jw.key("ts");
+        jw.value(static_cast<uint32_t>(1700000000u + i * 60));
+        jw.key("note");
+        jw.value(i % 50 == 0 ? "archived record with a longer note attached to it" : "ok");
+        jw.endObject();
+    }
+    jw.endArray();
+}
+
+constexpr size_t DOCUMENT_SIZE = 256 * 1024;
+static uint8_t reference[DOCUMENT_SIZE];
+static uint8_t contents[DOCUMENT_SIZE];
+
+static size_t writeReference(uint32_t records)
+{
+    JsonBufWriter jw(reference, sizeof(reference));
+    writeArchive(jw, records);
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(jw.finalize(output, length));
+    return length;
+}
+
+void test_file_matches_document()
+{
+    // A one-page step forces many remaps
+    JsonMmapSink sink(1);
+    JsonBufWriter jw(nullptr, 0);
+    TEST_ASSERT_TRUE(sink.open(outputPath(), jw));
+    writeArchive(jw, 3000);
+    TEST_ASSERT_TRUE(jw.flushedSize() > 0);
+    TEST_ASSERT_TRUE(sink.finish(jw));
+    TEST_ASSERT_FALSE(sink.isOpen());
+
+    const size_t expected = writeReference(3000);
+    TEST_ASSERT_EQUAL_UINT(expected, sink.length());
+    TEST_ASSERT_EQUAL_UINT(expected, readFile(outputPath(), contents, sizeof(contents)));
+    TEST_ASSERT_EQUAL_MEMORY(reference, contents, expected);
+    unlink(outputPath());
+}
+
+void test_small_document_truncated()
+{
+    JsonMmapSink sink;
+    JsonBufWriter jw(nullptr, 0);
+    TEST_ASSERT_TRUE(sink.open(outputPath(), jw));
+    TEST_ASSERT_TRUE(jw.beginObject());
+    TEST_ASSERT_TRUE(jw.key("ok"));
+    TEST_ASSERT_TRUE(jw.value(true));
+    TEST_ASSERT_TRUE(jw.endObject());
+    TEST_ASSERT_TRUE(sink.finish(jw));
+
+    TEST_ASSERT_EQUAL_UINT(11, readFile(outputPath(), contents, sizeof(contents)));
+    TEST_ASSERT_EQUAL_MEMORY("{\"ok\":true}", contents, 11);
+    unlink(outputPath());
+}
+
+void test_close_keeps_flushed_bytes()
+{
+    JsonMmapSink sink(1);
+    JsonBufWriter jw(nullptr, 0);
+    TEST_ASSERT_FALSE(sink.open("/nonexistent-dir/out.json", jw));
+    TEST_ASSERT_FALSE(sink.isOpen());
+
+    TEST_ASSERT_TRUE(sink.open(outputPath(), jw));
+    writeArchive(jw, 3000);
+    const size_t flushed = jw.flushedSize();
+    sink.close();
+    TEST_ASSERT_EQUAL_UINT(flushed, sink.length());
+    TEST_ASSERT_EQUAL_UINT(flushed, readFile(outputPath(), contents, sizeof(contents)));
+    TEST_ASSERT_FALSE(sink.finish(jw));
+    unlink(outputPath());
+}
+
+// Export through a 4 KB buffer and write() per flush vs. straight into the mapping
+static bool writeChunk(void *context, const uint8_t *data, size_t length)
+{
+    return write(*static_cast<int *>(context), data, length) == static_cast<ssize_t>(length);
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void test_bench_buffered_vs_mmap()
+{
+    const uint32_t records = 400000;
+    const uint8_t *output;
+    size_t length;
+
+    static uint8_t staging[4096];
+    JsonBufWriter jw(staging, sizeof(staging));
+    FILE *file = fopen(outputPath(), "wb");
+    TEST_ASSERT_NOT_NULL(file);
+    int fd = fileno(file);
+    jw.setFlushHandler(writeChunk, &fd);
+    auto start = std::chrono::steady_clock::now();
+    writeArchive(jw, records);
+    TEST_ASSERT_TRUE(jw.finalize(output, length));
+    TEST_ASSERT_TRUE(writeChunk(&fd, output, length));
+    const size_t buffered = jw.flushedSize() + length;
+    const double bufferedMs = elapsedMs(start);
+    fclose(file);
+
+    JsonMmapSink sink(8u << 20);
+    start = std::chrono::steady_clock::now();
+    TEST_ASSERT_TRUE(sink.open(outputPath(), jw));
+    writeArchive(jw, records);
+    TEST_ASSERT_TRUE(sink.finish(jw));
+    const double mappedMs = elapsedMs(start);
+    TEST_ASSERT_EQUAL_UINT(buffered, sink.length());
+
+    printf("[bench] %-36s %8.2f ms  (%u bytes)\n", "archive export, 4 KB buffer + write()", bufferedMs,
+           static_cast<unsigned>(buffered));
+    printf("[bench] %-36s %8.2f ms  (%u bytes)\n", "archive export, mmap sink", mappedMs,
+           static_cast<unsigned>(sink.length()));
+    unlink(outputPath());
+}
+
+static int runTests()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_file_matches_document);
+    RUN_TEST(test_small_document_truncated);
+    RUN_TEST(test_close_keeps_flushed_bytes);
+    RUN_TEST(test_bench_buffered_vs_mmap);
+    return UNITY_END();
+}
+
+#else
+
+void test_mmap_unavailable()
+{
+    TEST_IGNORE_MESSAGE("Memory-mapped output requires Linux");
+}
+
+static int runTests()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_mmap_unavailable);
+    return UNITY_END();
+}
+
+#endif
+
+#if defined(ARDUINO)
+void setup()
+{
+    delay(2000); // Wait for serial monitor
+
+    runTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runTests();
+}
+#endif
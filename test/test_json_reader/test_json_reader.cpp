@@ -0,0 +1,312 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "../../src/json_buffer_writer.hpp"
+#include "../../src/json_reader.hpp"
+
+typedef JsonReader::Token Token;
+
+constexpr size_t BUFFER_SIZE = 1024;
+static uint8_t testBuffer[BUFFER_SIZE];
+
+void setUp(void)
+{
+    memset(testBuffer, 0, BUFFER_SIZE);
+}
+
+void tearDown(void)
+{
+}
+
+static JsonReader readerFor(const char *text)
+{
+    return JsonReader(text, strlen(text));
+}
+
+static void assertSpan(const JsonReader &reader, const char *expected)
+{
+    TEST_ASSERT_EQUAL_UINT(strlen(expected), reader.size());
+    TEST_ASSERT_EQUAL_MEMORY(expected, reader.data(), reader.size());
+}
+
+static bool reachesEnd(const char *text)
+{
+    JsonReader reader = readerFor(text);
+    Token token;
+    while ((token = reader.next()) != Token::End && token != Token::Error)
+    {
+    }
+    return token == Token::End;
+}
+
+void test_tokens_and_spans()
+{
+    JsonReader reader = readerFor(" {\"id\": 42, \"tags\": [\"a\", true, false, null],\n \"t\": -1.5e3, \"o\": {}} ");
+
+    TEST_ASSERT_TRUE(reader.next() == Token::BeginObject);
+    TEST_ASSERT_EQUAL_UINT(1, reader.depth());
+    TEST_ASSERT_TRUE(reader.next() == Token::Key);
+    assertSpan(reader, "id");
+    TEST_ASSERT_TRUE(reader.next() == Token::Number);
+    assertSpan(reader, "42");
+    TEST_ASSERT_TRUE(reader.isInteger());
+    TEST_ASSERT_TRUE(reader.next() == Token::Key);
+    assertSpan(reader, "tags");
+    TEST_ASSERT_TRUE(reader.next() == Token::BeginArray);
+    TEST_ASSERT_EQUAL_UINT(2, reader.depth());
+    TEST_ASSERT_TRUE(reader.next() == Token::String);
+    assertSpan(reader, "a");
+    TEST_ASSERT_TRUE(reader.next() == Token::True);
+    TEST_ASSERT_TRUE(reader.next() == Token::False);
+    TEST_ASSERT_TRUE(reader.next() == Token::Null);
+    assertSpan(reader, "null");
+    TEST_ASSERT_TRUE(reader.next() == Token::EndArray);
+    TEST_ASSERT_EQUAL_UINT(1, reader.depth());
+    TEST_ASSERT_TRUE(reader.next() == Token::Key);
+    TEST_ASSERT_TRUE(reader.next() == Token::Number);
+    assertSpan(reader, "-1.5e3");
+    TEST_ASSERT_FALSE(reader.isInteger());
+    TEST_ASSERT_TRUE(reader.next() == Token::Key);
+    TEST_ASSERT_TRUE(reader.next() == Token::BeginObject);
+    TEST_ASSERT_TRUE(reader.next() == Token::EndObject);
+    TEST_ASSERT_TRUE(reader.next() == Token::EndObject);
+    TEST_ASSERT_EQUAL_UINT(0, reader.depth());
+    TEST_ASSERT_TRUE(reader.next() == Token::End);
+    TEST_ASSERT_TRUE(reader.next() == Token::End);
+    TEST_ASSERT_TRUE(reader.ok());
+}
+
+void test_string_decoding()
+{
+    JsonReader reader = readerFor("[\"plain\", \"a\\\"b\\\\c\\/d\\n\", \"\\u00e9\\ud83d\\ude00\\ud800x\", \"caf\\u00e9\"]");
+    char out[32];
+    size_t length = 0;
+
+    TEST_ASSERT_FALSE(reader.getString(out, sizeof(out), length));
+    reader.next();
+    TEST_ASSERT_TRUE(reader.next() == Token::String);
+    TEST_ASSERT_FALSE(reader.hasEscapes());
+    TEST_ASSERT_TRUE(reader.getString(out, sizeof(out), length));
+    TEST_ASSERT_EQUAL_STRING("plain", out);
+    TEST_ASSERT_FALSE(reader.getString(out, 5, length)); // No room for the terminator
+
+    reader.next();
+    TEST_ASSERT_TRUE(reader.hasEscapes());
+    assertSpan(reader, "a\\\"b\\\\c\\/d\\n");
+    TEST_ASSERT_TRUE(reader.getString(out, sizeof(out), length));
+    TEST_ASSERT_EQUAL_UINT(8, length);
+    TEST_ASSERT_EQUAL_STRING("a\"b\\c/d\n", out);
+
+    // Surrogate pair, then an unpaired high surrogate
+    reader.next();
+    TEST_ASSERT_TRUE(reader.getString(out, sizeof(out), length));
+    TEST_ASSERT_EQUAL_STRING("\xC3\xA9\xF0\x9F\x98\x80\xEF\xBF\xBDx", out);
+
+    reader.next();
+    TEST_ASSERT_TRUE(reader.equals("caf\xC3\xA9"));
+    TEST_ASSERT_FALSE(reader.equals("caf"));
+    TEST_ASSERT_FALSE(reader.equals("caf\xC3\xA9s"));
+    TEST_ASSERT_TRUE(reader.next() == Token::EndArray);
+    TEST_ASSERT_FALSE(reader.equals(""));
+}
+
+void test_number_conversion()
+{
+    JsonReader reader = readerFor("[0, -9223372036854775808, 9223372036854775808, 18446744073709551615,"
+                                  " 18446744073709551616, 2.5, -1e-2]");
+    int64_t i = 0;
+    uint64_t u = 0;
+    double d = 0;
+
+    reader.next();
+    reader.next();
+    TEST_ASSERT_TRUE(reader.getInt(i));
+    TEST_ASSERT_TRUE(i == 0);
+
+    reader.next();
+    TEST_ASSERT_TRUE(reader.getInt(i));
+    TEST_ASSERT_TRUE(i == INT64_MIN);
+    TEST_ASSERT_FALSE(reader.getUint(u));
+
+    reader.next();
+    TEST_ASSERT_FALSE(reader.getInt(i));
+    TEST_ASSERT_TRUE(reader.getUint(u));
+    TEST_ASSERT_TRUE(u == 9223372036854775808ULL);
+
+    reader.next();
+    TEST_ASSERT_TRUE(reader.getUint(u));
+    TEST_ASSERT_TRUE(u == UINT64_MAX);
+
+    reader.next();
+    TEST_ASSERT_FALSE(reader.getUint(u));
+    TEST_ASSERT_TRUE(reader.getDouble(d));
+    TEST_ASSERT_TRUE(d > 1.8e19);
+
+    reader.next();
+    TEST_ASSERT_FALSE(reader.getInt(i));
+    TEST_ASSERT_TRUE(reader.getDouble(d));
+    TEST_ASSERT_TRUE(d == 2.5);
+
+    reader.next();
+    TEST_ASSERT_TRUE(reader.getDouble(d));
+    TEST_ASSERT_TRUE(d == -0.01);
+}
+
+void test_malformed_input_rejected()
+{
+    static const char *const valid[] = {
+        "0", "-0.0e+0", "\"\"", " [ ] ", "{}", "[[[]]]", "{\"a\":{\"b\":[1,{\"c\":null}]}}", "1E5", "\"\\u12aB\""};
+    static const char *const invalid[] = {
+        "", " ", "[", "]", "{\"a\"}", "{\"a\" 1}", "{\"a\":}", "{1:2}", "[1,]", "{\"a\":1,}", "[1 2]",
+        "[1}", "{\"a\":1]", "01", "-", "1.", ".5", "1e", "+1", "tru", "nul", "truex", "[true false]",
+        "\"abc", "\"a\\x\"", "\"\\u12G4\"", "\"tab\there\"", "1 2", "{} {}", "[1]]", "'a'"};
+
+    for (const char *text : valid)
+    {
+        TEST_ASSERT_TRUE_MESSAGE(reachesEnd(text), text);
+    }
+    for (const char *text : invalid)
+    {
+        TEST_ASSERT_FALSE_MESSAGE(reachesEnd(text), text);
+    }
+
+    // The error is sticky and points at the offending byte
+    JsonReader reader = readerFor("{\"a\": [1, 2,, 3]}");
+    while (reader.next() != Token::Error)
+    {
+    }
+    TEST_ASSERT_EQUAL_UINT(12, reader.offset());
+    TEST_ASSERT_FALSE(reader.ok());
+    TEST_ASSERT_TRUE(reader.next() == Token::Error);
+
+    // Nesting deeper than MAX_DEPTH
+    char deep[JsonReader::MAX_DEPTH + 3] = {};
+    memset(deep, '[', JsonReader::MAX_DEPTH + 1);
+    TEST_ASSERT_FALSE(reachesEnd(deep));
+}
+
+void test_utf8_validation()
+{
+    const char *text = "[\"caf\xC3\xA9\", \"bad \xC3\x28\"]";
+    JsonReader reader = readerFor(text);
+    TEST_ASSERT_TRUE(reader.next() == Token::BeginArray);
+    TEST_ASSERT_TRUE(reader.next() == Token::String);
+    TEST_ASSERT_TRUE(reader.next() == Token::String);
+
+    reader.reset(reinterpret_cast<const uint8_t *>(text), strlen(text));
+    reader.setValidateUtf8(true);
+    TEST_ASSERT_TRUE(reader.next() == Token::BeginArray);
+    TEST_ASSERT_TRUE(reader.next() == Token::String);
+    TEST_ASSERT_TRUE(reader.next() == Token::Error);
+    TEST_ASSERT_EQUAL_UINT(15, reader.offset());
+}
+
+void test_skip_and_json_lines()
+{
+    JsonReader reader = readerFor("{\"x\": {\"deep\": [1, {\"y\": 2}]}, \"n\": [], \"id\": 7}\n[1]\n\"s\"\n");
+    reader.setJsonLines(true);
+
+    reader.next();
+    TEST_ASSERT_TRUE(reader.next() == Token::Key);
+    TEST_ASSERT_TRUE(reader.skip());
+    TEST_ASSERT_TRUE(reader.token() == Token::EndObject);
+    TEST_ASSERT_EQUAL_UINT(1, reader.depth());
+    TEST_ASSERT_TRUE(reader.next() == Token::Key);
+    TEST_ASSERT_TRUE(reader.next() == Token::BeginArray);
+    TEST_ASSERT_TRUE(reader.skip());
+    TEST_ASSERT_TRUE(reader.token() == Token::EndArray);
+    TEST_ASSERT_TRUE(reader.next() == Token::Key);
+    TEST_ASSERT_TRUE(reader.equals("id"));
+    TEST_ASSERT_TRUE(reader.skip());
+    TEST_ASSERT_TRUE(reader.token() == Token::Number);
+    TEST_ASSERT_TRUE(reader.next() == Token::EndObject);
+
+    // Following records
+    TEST_ASSERT_TRUE(reader.next() == Token::BeginArray);
+    TEST_ASSERT_TRUE(reader.skip());
+    TEST_ASSERT_TRUE(reader.next() == Token::String);
+    TEST_ASSERT_TRUE(reader.next() == Token::End);
+
+    // Records must be separated
+    reader = readerFor("[1][2]");
+    reader.setJsonLines(true);
+    reader.next();
+    reader.skip();
+    TEST_ASSERT_TRUE(reader.next() == Token::Error);
+}
+
+void test_round_trip_with_writer()
+{
+    JsonBufWriter jw(testBuffer, BUFFER_SIZE);
+    jw.beginObject();
+    jw.key("name");
+    jw.value("line \"one\"\n\ttab \xE2\x82\xAC \x01");
+    jw.key("count");
+    jw.value(static_cast<int64_t>(-1234567890123LL));
+    jw.key("ratio");
+    jw.value(0.25);
+    jw.key("list");
+    jw.beginArray();
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        jw.value(i * 1000);
+    }
+    jw.endArray();
+    jw.endObject();
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(jw.finalize(output, length));
+
+    JsonReader reader(output, length);
+    char text[64];
+    size_t textLength = 0;
+    int64_t integer = 0;
+    uint64_t unsignedInteger = 0;
+    double real = 0;
+
+    TEST_ASSERT_TRUE(reader.next() == Token::BeginObject);
+    TEST_ASSERT_TRUE(reader.next() == Token::Key);
+    TEST_ASSERT_TRUE(reader.equals("name"));
+    TEST_ASSERT_TRUE(reader.next() == Token::String);
+    TEST_ASSERT_TRUE(reader.getString(text, sizeof(text), textLength));
+    TEST_ASSERT_EQUAL_STRING("line \"one\"\n\ttab \xE2\x82\xAC \x01", text);
+    TEST_ASSERT_TRUE(reader.next() == Token::Key);
+    TEST_ASSERT_TRUE(reader.next() == Token::Number);
+    TEST_ASSERT_TRUE(reader.getInt(integer));
+    TEST_ASSERT_TRUE(integer == -1234567890123LL);
+    TEST_ASSERT_TRUE(reader.next() == Token::Key);
+    TEST_ASSERT_TRUE(reader.next() == Token::Number);
+    TEST_ASSERT_TRUE(reader.getDouble(real));
+    TEST_ASSERT_TRUE(real == 0.25);
+    TEST_ASSERT_TRUE(reader.next() == Token::Key);
+    TEST_ASSERT_TRUE(reader.next() == Token::BeginArray);
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        TEST_ASSERT_TRUE(reader.next() == Token::Number);
+        TEST_ASSERT_TRUE(reader.getUint(unsignedInteger));
+        TEST_ASSERT_TRUE(unsignedInteger == i * 1000);
+    }
+    TEST_ASSERT_TRUE(reader.next() == Token::EndArray);
+    TEST_ASSERT_TRUE(reader.next() == Token::EndObject);
+    TEST_ASSERT_TRUE(reader.next() == Token::End);
+}
+
+void setup()
+{
+    delay(2000); // Wait for serial monitor
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_tokens_and_spans);
+    RUN_TEST(test_string_decoding);
+    RUN_TEST(test_number_conversion);
+    RUN_TEST(test_malformed_input_rejected);
+    RUN_TEST(test_utf8_validation);
+    RUN_TEST(test_skip_and_json_lines);
+    RUN_TEST(test_round_trip_with_writer);
+
+    UNITY_END();
+}
+
+void loop()
+{
+}
@@ -0,0 +1,297 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "../../src/json_reader.hpp"
+#include "../../src/json_record_serializer.hpp"
+
+constexpr size_t BUFFER_SIZE = 512;
+static uint8_t testBuffer[BUFFER_SIZE];
+
+// Packed sample record: id(u16) temp(f32) ok(bool) delta(i8) name(char[6]) count(u64)
+constexpr size_t RECORD_SIZE = 2 + 4 + 1 + 1 + 6 + 8;
+
+static JsonRecordField fields[] = {
+    {"id", 0, JsonFieldType::UInt16},
+    {"temp", 2, JsonFieldType::Float},
+    {"ok", 6, JsonFieldType::Bool},
+    {"delta", 7, JsonFieldType::Int8},
+    {"na\"me", 8, JsonFieldType::String, 6},
+    {"count", 14, JsonFieldType::UInt64},
+};
+
+static void makeRecord(uint8_t *out, uint16_t id, float temp, bool ok, int8_t delta, const char *name, uint64_t count)
+{
+    memset(out, 0, RECORD_SIZE);
+    memcpy(out + 0, &id, sizeof(id));
+    memcpy(out + 2, &temp, sizeof(temp));
+    out[6] = ok ? 1 : 0;
+    memcpy(out + 7, &delta, sizeof(delta));
+    memcpy(out + 8, name, strnlen(name, 6));
+    memcpy(out + 14, &count, sizeof(count));
+}
+
+String getJsonString(JsonBufWriter &writer)
+{
+    const uint8_t *output;
+    size_t length;
+    if (writer.finalize(output, length))
+    {
+        return String(reinterpret_cast<const char *>(output), length);
+    }
+    return "";
+}
+
+void setUp(void)
+{
+    memset(testBuffer, 0, BUFFER_SIZE);
+}
+
+void tearDown(void)
+{
+}
+
+void test_compile_caches_escaped_keys()
+{
+    // Each field takes its `"key":` fragment plus a two-byte length
+    const size_t needed = 2 + 5 + 2 + 7 + 2 + 5 + 2 + 8 + 2 + 9 + 2 + 8;
+    char keys[needed];
+    JsonRecordSerializer serializer(fields, 6);
+
+    TEST_ASSERT_FALSE(serializer.compile(keys, needed - 1));
+    TEST_ASSERT_TRUE(serializer.compile(keys, needed));
+    TEST_ASSERT_TRUE(serializer.compiled());
+
+    uint8_t record[RECORD_SIZE];
+    makeRecord(record, 1, 0.0f, false, 0, "", 0);
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(serializer.writeObject(writer, record));
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":1,\"temp\":0.000,\"ok\":false,\"delta\":0,\"na\\\"me\":\"\",\"count\":0}",
+                             result.c_str());
+}
+
+void test_compile_with_encoding_options()
+{
+    JsonRecordField utf8Fields[] = {
+        {"t\xC3\xA9mp", 0, JsonFieldType::UInt8},
+        {"caf\xE9", 1, JsonFieldType::UInt8},
+    };
+    char keys[64];
+    JsonRecordSerializer serializer(utf8Fields, 2);
+
+    TEST_ASSERT_FALSE(serializer.compile(keys, sizeof(keys), JsonBufWriter::Utf8Mode::Reject));
+    TEST_ASSERT_FALSE(serializer.compiled());
+
+    TEST_ASSERT_TRUE(serializer.compile(keys, sizeof(keys), JsonBufWriter::Utf8Mode::Replace, true));
+    const uint8_t record[2] = {1, 2};
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(serializer.writeObject(writer, record));
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"t\\u00e9mp\":1,\"caf\\ufffd\":2}", result.c_str());
+}
+
+void test_compile_storage_too_small()
+{
+    char keys[8];
+    JsonRecordSerializer serializer(fields, 6);
+
+    TEST_ASSERT_FALSE(serializer.compile(keys, sizeof(keys)));
+    TEST_ASSERT_FALSE(serializer.compiled());
+
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    uint8_t record[RECORD_SIZE] = {};
+    TEST_ASSERT_FALSE(serializer.writeObject(writer, record));
+}
+
+void test_write_object()
+{
+    char keys[128];
+    JsonRecordSerializer serializer(fields, 6);
+    TEST_ASSERT_TRUE(serializer.compile(keys, sizeof(keys)));
+
+    uint8_t record[RECORD_SIZE];
+    makeRecord(record, 513, 21.5f, true, -3, "pump", 9876543210ULL);
+
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(serializer.writeObject(writer, record));
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":513,\"temp\":21.500,\"ok\":true,\"delta\":-3,"
+                             "\"na\\\"me\":\"pump\",\"count\":9876543210}",
+                             result.c_str());
+}
+
+void test_write_array_with_stride()
+{
+    char keys[128];
+    JsonRecordSerializer serializer(fields, 2); // id and temp only
+    TEST_ASSERT_TRUE(serializer.compile(keys, sizeof(keys)));
+
+    uint8_t records[2 * RECORD_SIZE];
+    makeRecord(records, 1, 1.0f, false, 0, "", 0);
+    makeRecord(records + RECORD_SIZE, 2, -2.25f, false, 0, "full6!", 0);
+
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(serializer.writeArray(writer, records, 2, RECORD_SIZE));
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("[{\"id\":1,\"temp\":1.000},{\"id\":2,\"temp\":-2.250}]", result.c_str());
+}
+
+void test_string_field_without_terminator()
+{
+    char keys[128];
+    JsonRecordSerializer serializer(fields + 4, 1);
+    TEST_ASSERT_TRUE(serializer.compile(keys, sizeof(keys)));
+
+    uint8_t record[RECORD_SIZE];
+    makeRecord(record, 0, 0.0f, false, 0, "abcdef", 0);
+
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(serializer.writeObject(writer, record));
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"na\\\"me\":\"abcdef\"}", result.c_str());
+}
+
+void test_write_nested_in_object()
+{
+    char keys[128];
+    JsonRecordSerializer serializer(fields, 1);
+    TEST_ASSERT_TRUE(serializer.compile(keys, sizeof(keys)));
+
+    uint8_t record[RECORD_SIZE];
+    makeRecord(record, 7, 0.0f, false, 0, "", 0);
+
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(writer.beginObject());
+    TEST_ASSERT_TRUE(writer.key("rec"));
+    TEST_ASSERT_TRUE(serializer.writeObject(writer, record));
+    TEST_ASSERT_TRUE(writer.key("n"));
+    TEST_ASSERT_TRUE(writer.value(1));
+    TEST_ASSERT_TRUE(writer.endObject());
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"rec\":{\"id\":7},\"n\":1}", result.c_str());
+}
+
+void test_write_columns()
+{
+    char keys[128];
+    JsonRecordSerializer serializer(fields, 6);
+    TEST_ASSERT_TRUE(serializer.compile(keys, sizeof(keys)));
+
+    uint8_t records[3 * RECORD_SIZE];
+    makeRecord(records, 1, 1.0f, true, -1, "a", 10);
+    makeRecord(records + RECORD_SIZE, 2, -2.25f, false, 0, "full6!", 0);
+    makeRecord(records + 2 * RECORD_SIZE, 65535, 0.5f, true, 127, "", 18446744073709551615ULL);
+
+    JsonBufWriter writer(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(serializer.writeColumns(writer, records, 3, RECORD_SIZE));
+
+    String result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":[1,2,65535],\"temp\":[1.000,-2.250,0.500],\"ok\":[true,false,true],"
+                             "\"delta\":[-1,0,127],\"na\\\"me\":[\"a\",\"full6!\",\"\"],"
+                             "\"count\":[10,0,18446744073709551615]}",
+                             result.c_str());
+
+    // Empty batch: every column is an empty array
+    writer.reset(testBuffer, BUFFER_SIZE);
+    TEST_ASSERT_TRUE(serializer.writeColumns(writer, records, 0, RECORD_SIZE));
+    result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":[],\"temp\":[],\"ok\":[],\"delta\":[],\"na\\\"me\":[],\"count\":[]}",
+                             result.c_str());
+
+    // A zero stride repeats one record, as writeArray() does
+    writer.reset(testBuffer, BUFFER_SIZE);
+    JsonRecordSerializer idAndTemp(fields, 2);
+    TEST_ASSERT_TRUE(idAndTemp.compile(keys, sizeof(keys)));
+    TEST_ASSERT_TRUE(idAndTemp.writeColumns(writer, records + RECORD_SIZE, 3, 0));
+    result = getJsonString(writer);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":[2,2,2],\"temp\":[-2.250,-2.250,-2.250]}", result.c_str());
+
+    // Overflow is reported like writeArray()
+    uint8_t smallBuffer[16];
+    JsonBufWriter small(smallBuffer, sizeof(smallBuffer));
+    TEST_ASSERT_FALSE(serializer.writeColumns(small, records, 3, RECORD_SIZE));
+    TEST_ASSERT_FALSE(small.ok());
+}
+
+static bool isValidJson(const uint8_t *data, size_t length)
+{
+    JsonReader reader(data, length);
+    JsonReader::Token token;
+    while ((token = reader.next()) != JsonReader::Token::End && token != JsonReader::Token::Error)
+    {
+    }
+    return token == JsonReader::Token::End;
+}
+
+void test_best_effort_closes_containers()
+{
+    char keys[128];
+    JsonRecordSerializer serializer(fields, 6);
+    TEST_ASSERT_TRUE(serializer.compile(keys, sizeof(keys)));
+    uint8_t records[6 * RECORD_SIZE];
+    for (uint16_t i = 0; i < 6; i++)
+    {
+        makeRecord(records + i * RECORD_SIZE, i, 1.5f * i, i & 1, -i, "name", 1000000ULL * i);
+    }
+
+    // Values that do not fit are dropped, the rest of the batch is still written and closed
+    for (size_t size = 24; size < 128; size++)
+    {
+        for (int columns = 0; columns < 2; columns++)
+        {
+            JsonBufWriter writer(testBuffer, size);
+            writer.setBestEffort(true);
+            const bool written = columns ? serializer.writeColumns(writer, records, 6, RECORD_SIZE)
+                                         : serializer.writeArray(writer, records, 6, RECORD_SIZE);
+            TEST_ASSERT_TRUE(writer.ok());
+            TEST_ASSERT_EQUAL(written, writer.droppedCount() == 0);
+
+            const uint8_t *output;
+            size_t length;
+            TEST_ASSERT_TRUE(writer.finalize(output, length));
+            TEST_ASSERT_TRUE(isValidJson(output, length));
+        }
+    }
+}
+
+void test_write_overflow_sets_error()
+{
+    char keys[128];
+    JsonRecordSerializer serializer(fields, 6);
+    TEST_ASSERT_TRUE(serializer.compile(keys, sizeof(keys)));
+
+    uint8_t record[RECORD_SIZE];
+    makeRecord(record, 1, 1.0f, true, 1, "x", 1);
+
+    uint8_t smallBuffer[16];
+    JsonBufWriter writer(smallBuffer, sizeof(smallBuffer));
+    TEST_ASSERT_FALSE(serializer.writeObject(writer, record));
+    TEST_ASSERT_FALSE(writer.ok());
+}
+
+void setup()
+{
+    delay(2000); // Wait for serial monitor
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_compile_caches_escaped_keys);
+    RUN_TEST(test_compile_with_encoding_options);
+    RUN_TEST(test_compile_storage_too_small);
+    RUN_TEST(test_write_object);
+    RUN_TEST(test_write_array_with_stride);
+    RUN_TEST(test_string_field_without_terminator);
+    RUN_TEST(test_write_nested_in_object);
+    RUN_TEST(test_write_columns);
+    RUN_TEST(test_best_effort_closes_containers);
+    RUN_TEST(test_write_overflow_sets_error);
+
+    UNITY_END();
+}
+
+void loop()
+{
+}
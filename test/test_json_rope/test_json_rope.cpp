@@ -0,0 +1,144 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "../../src/json_rope.hpp"
+
+constexpr size_t BLOCK_SIZE = 128;
+constexpr size_t BLOCK_COUNT = 16;
+alignas(void *) static uint8_t slabs[BLOCK_SIZE * BLOCK_COUNT];
+
+constexpr size_t DOCUMENT_SIZE = 4096;
+static uint8_t reference[DOCUMENT_SIZE];
+static uint8_t gathered[DOCUMENT_SIZE];
+
+void setUp(void)
+{
+    memset(gathered, 0, DOCUMENT_SIZE);
+}
+
+void tearDown(void)
+{
+}
+
+static void writeLog(JsonBufWriter &jw, int entries)
+{
+    jw.beginArray();
+    for (int i = 0; i < entries; i++)
+    {
+        jw.beginObject();
+        jw.key("seq");
+        jw.value(static_cast<int32_t>(i));
+        jw.key("msg");
+        jw.value(i % 5 == 0 ? "a message long enough to cross the end of a rope block, sometimes two of them"
+                            : "short");
+        jw.endObject();
+    }
+    jw.endArray();
+}
+
+static size_t writeReference(int entries)
+{
+    JsonBufWriter jw(reference, DOCUMENT_SIZE);
+    writeLog(jw, entries);
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(jw.finalize(output, length));
+    return length;
+}
+
+void test_rope_matches_contiguous_output()
+{
+    JsonSlabPool pool(slabs, sizeof(slabs), BLOCK_SIZE);
+    JsonRope rope(pool.allocator(), BLOCK_SIZE);
+    JsonBufWriter jw(nullptr, 0);
+
+    TEST_ASSERT_TRUE(rope.attach(jw));
+    writeLog(jw, 20);
+    TEST_ASSERT_TRUE(rope.finish(jw));
+
+    const size_t expected = writeReference(20);
+    TEST_ASSERT_TRUE(rope.blockCount() > 1);
+    TEST_ASSERT_EQUAL_UINT(expected, rope.size());
+    TEST_ASSERT_EQUAL_UINT(expected, rope.gather(gathered, sizeof(gathered)));
+    TEST_ASSERT_EQUAL_MEMORY(reference, gathered, expected);
+    TEST_ASSERT_EQUAL_UINT(0, rope.gather(gathered, expected - 1));
+}
+
+void test_blocks_are_written_in_place()
+{
+    JsonSlabPool pool(slabs, sizeof(slabs), BLOCK_SIZE);
+    JsonRope rope(pool.allocator(), BLOCK_SIZE);
+    JsonBufWriter jw(nullptr, 0);
+
+    TEST_ASSERT_TRUE(rope.attach(jw));
+    writeLog(jw, 20);
+    TEST_ASSERT_TRUE(rope.finish(jw));
+
+    // Every block lives in the slab storage and stays within its payload
+    size_t blocks = 0;
+    for (const JsonRopeBlock *block = rope.first(); block; block = block->next)
+    {
+        TEST_ASSERT_TRUE(block->data() > slabs && block->data() < slabs + sizeof(slabs));
+        TEST_ASSERT_TRUE(block->length <= BLOCK_SIZE - sizeof(JsonRopeBlock));
+        blocks++;
+    }
+    TEST_ASSERT_EQUAL_UINT(rope.blockCount(), blocks);
+    TEST_ASSERT_EQUAL_UINT(BLOCK_COUNT - blocks, pool.available());
+
+    rope.clear();
+    TEST_ASSERT_EQUAL_UINT(BLOCK_COUNT, pool.available());
+    TEST_ASSERT_NULL(rope.first());
+}
+
+void test_pool_exhaustion_fails_cleanly()
+{
+    JsonSlabPool pool(slabs, BLOCK_SIZE * 2, BLOCK_SIZE);
+    JsonRope rope(pool.allocator(), BLOCK_SIZE);
+    JsonBufWriter jw(nullptr, 0);
+
+    TEST_ASSERT_TRUE(rope.attach(jw));
+    writeLog(jw, 20);
+    TEST_ASSERT_FALSE(jw.ok());
+    TEST_ASSERT_FALSE(rope.finish(jw));
+    TEST_ASSERT_EQUAL_UINT(0, pool.available());
+
+    // A larger block than the slab cannot be served at all
+    JsonRope oversized(pool.allocator(), BLOCK_SIZE * 2);
+    rope.clear();
+    TEST_ASSERT_FALSE(oversized.attach(jw));
+    TEST_ASSERT_EQUAL_UINT(2, pool.available());
+}
+
+void test_heap_allocator()
+{
+    JsonRope rope(JsonBlockAllocator::heap(), 256);
+    JsonBufWriter jw(nullptr, 0);
+
+    for (int round = 0; round < 2; round++)
+    {
+        TEST_ASSERT_TRUE(rope.attach(jw));
+        writeLog(jw, 40);
+        TEST_ASSERT_TRUE(rope.finish(jw));
+
+        const size_t expected = writeReference(40);
+        TEST_ASSERT_EQUAL_UINT(expected, rope.gather(gathered, sizeof(gathered)));
+        TEST_ASSERT_EQUAL_MEMORY(reference, gathered, expected);
+    }
+}
+
+void setup()
+{
+    delay(2000); // Wait for serial monitor
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_rope_matches_contiguous_output);
+    RUN_TEST(test_blocks_are_written_in_place);
+    RUN_TEST(test_pool_exhaustion_fails_cleanly);
+    RUN_TEST(test_heap_allocator);
+
+    UNITY_END();
+}
+
+void loop()
+{
+}
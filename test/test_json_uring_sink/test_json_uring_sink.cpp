@@ -0,0 +1,233 @@
+#include <unity.h>
+#if defined(ARDUINO)
+#include <Arduino.h>
+#endif
+#include <string.h>
+#include "../../src/json_uring_sink.hpp"
+
+// Runs on Linux hosts, e.g. `pio test -e native`
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+#if defined(JSON_BUF_WRITER_HAS_IO_URING)
+
+#include <chrono>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static const char *outputPath()
+{
+    static char path[256];
+    const char *dir = getenv("TMPDIR");
+    snprintf(path, sizeof(path), "%s/json_uring_sink_%ld.json", dir ? dir : "/tmp", static_cast<long>(getpid()));
+    return path;
+}
+
+static void writeLog(JsonBufWriter &jw, uint32_t records)
+{
+    jw.beginArray();
+    for (uint32_t i = 0; i < records; ++i)
+    {
+        jw.beginObject();
+        jw.key("seq");
+        jw.value(i);
+        jw.key("level");
+        jw.value(i % 7 == 0 ? "warn" : "info");
+        jw.key("msg");
+        jw.value("sample logged at a high rate");
+        jw.endObject();
+    }
+    jw.endArray();
+}
+
+constexpr size_t DOCUMENT_SIZE = 64 * 1024;
+static uint8_t reference[DOCUMENT_SIZE];
+static uint8_t contents[DOCUMENT_SIZE];
+static uint8_t ring[4 * 256];
+
+static size_t writeReference(uint32_t records)
+{
+    JsonBufWriter jw(reference, sizeof(reference));
+    writeLog(jw, records);
+    const uint8_t *output;
+    size_t length;
+    TEST_ASSERT_TRUE(jw.finalize(output, length));
+    return length;
+}
+
+static size_t readAll(int fd, uint8_t *out, size_t capacity)
+{
+    size_t total = 0;
+    ssize_t result;
+    while (total < capacity && (result = read(fd, out + total, capacity - total)) > 0)
+    {
+        total += static_cast<size_t>(result);
+    }
+    return total;
+}
+
+static void checkFile(bool useUring)
+{
+    JsonUringSink sink(ring, 256, 4);
+    JsonBufWriter jw(nullptr, 0);
+    int fd = open(outputPath(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    TEST_ASSERT_TRUE(fd >= 0);
+    TEST_ASSERT_EQUAL_INT(4, write(fd, "LOG\n", 4));
+
+    TEST_ASSERT_TRUE(sink.open(fd, jw, useUring));
+    TEST_ASSERT_TRUE(useUring || !sink.isAsync());
+    writeLog(jw, 200);
+    TEST_ASSERT_TRUE(sink.finish(jw));
+
+    const size_t expected = writeReference(200);
+    TEST_ASSERT_EQUAL_UINT(expected, sink.written());
+    TEST_ASSERT_EQUAL_INT(static_cast<off_t>(4 + expected), lseek(fd, 0, SEEK_CUR));
+
+    lseek(fd, 0, SEEK_SET);
+    TEST_ASSERT_EQUAL_UINT(4 + expected, readAll(fd, contents, sizeof(contents)));
+    TEST_ASSERT_EQUAL_MEMORY("LOG\n", contents, 4);
+    TEST_ASSERT_EQUAL_MEMORY(reference, contents + 4, expected);
+    close(fd);
+    unlink(outputPath());
+}
+
+void test_file_written_asynchronously()
+{
+    checkFile(true);
+}
+
+void test_blocking_fallback()
+{
+    checkFile(false);
+}
+
+void test_pipe_written_in_order()
+{
+    // A pipe is not seekable: buffers go out one at a time, in order
+    int fds[2];
+    TEST_ASSERT_EQUAL_INT(0, pipe(fds));
+    JsonUringSink sink(ring, 256, 4);
+    JsonBufWriter jw(nullptr, 0);
+
+    TEST_ASSERT_TRUE(sink.open(fds[1], jw));
+    writeLog(jw, 200);
+    TEST_ASSERT_TRUE(sink.finish(jw));
+    close(fds[1]);
+
+    const size_t expected = writeReference(200);
+    TEST_ASSERT_TRUE(expected < 65536); // Fits in the pipe without a concurrent reader
+    TEST_ASSERT_EQUAL_UINT(expected, readAll(fds[0], contents, sizeof(contents)));
+    TEST_ASSERT_EQUAL_MEMORY(reference, contents, expected);
+    close(fds[0]);
+}
+
+void test_write_error_reported()
+{
+    int fds[2];
+    TEST_ASSERT_EQUAL_INT(0, pipe(fds));
+    close(fds[0]); // Writes fail with EPIPE
+    signal(SIGPIPE, SIG_IGN);
+
+    JsonUringSink sink(ring, 256, 4);
+    JsonBufWriter jw(nullptr, 0);
+    TEST_ASSERT_TRUE(sink.open(fds[1], jw));
+    writeLog(jw, 200);
+    TEST_ASSERT_FALSE(jw.ok());
+    TEST_ASSERT_FALSE(sink.ok());
+    TEST_ASSERT_FALSE(sink.finish(jw));
+    close(fds[1]);
+
+    TEST_ASSERT_FALSE(JsonUringSink(ring, 256, 1).open(fds[1], jw));
+}
+
+// Synchronous write() per flush vs. the io_uring ring at several buffer sizes
+static double exportMs(size_t bufferSize, bool useUring, size_t &bytes)
+{
+    static uint8_t buffers[4 * 65536];
+    const uint32_t records = 200000;
+    JsonUringSink sink(buffers, bufferSize, 4);
+    JsonBufWriter jw(nullptr, 0);
+    int fd = open(outputPath(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    TEST_ASSERT_TRUE(fd >= 0);
+
+    auto start = std::chrono::steady_clock::now();
+    TEST_ASSERT_TRUE(sink.open(fd, jw, useUring));
+    writeLog(jw, records);
+    TEST_ASSERT_TRUE(sink.finish(jw));
+    const double elapsed =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    bytes = sink.written();
+    close(fd);
+    unlink(outputPath());
+    return elapsed;
+}
+
+void test_bench_write_vs_uring()
+{
+    static const size_t sizes[] = {1024, 4096, 16384, 65536};
+    for (size_t size : sizes)
+    {
+        size_t syncBytes = 0;
+        size_t ringBytes = 0;
+        const double syncMs = exportMs(size, false, syncBytes);
+        const double ringMs = exportMs(size, true, ringBytes);
+        TEST_ASSERT_EQUAL_UINT(syncBytes, ringBytes);
+        printf("[bench] log export, %5u B buffers: write() %8.2f ms, io_uring %8.2f ms  (%u bytes)\n",
+               static_cast<unsigned>(size), syncMs, ringMs, static_cast<unsigned>(ringBytes));
+    }
+}
+
+static int runTests()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_file_written_asynchronously);
+    RUN_TEST(test_blocking_fallback);
+    RUN_TEST(test_pipe_written_in_order);
+    RUN_TEST(test_write_error_reported);
+    RUN_TEST(test_bench_write_vs_uring);
+    return UNITY_END();
+}
+
+#else
+
+void test_uring_unavailable()
+{
+    TEST_IGNORE_MESSAGE("io_uring output requires Linux");
+}
+
+static int runTests()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_uring_unavailable);
+    return UNITY_END();
+}
+
+#endif
+
+#if defined(ARDUINO)
+void setup()
+{
+    delay(2000); // Wait for serial monitor
+
+    runTests();
+}
+
+void loop()
+{
+}
+#else
+int main()
+{
+    return runTests();
+}
+#endif